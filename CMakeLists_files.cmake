@@ -29,8 +29,15 @@
 # originally generated with the command:
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
 list (APPEND TEST_SOURCE_FILES
+	tests/common/anderson_acceleration_test.cpp
 	tests/common/boundaryconditions_test.cpp
+	tests/common/brent_root_finder_test.cpp
+	tests/common/local_time_stepping_test.cpp
 	tests/common/matrix_test.cpp
+	tests/common/mixed_precision_preconditioner_test.cpp
+	tests/common/performance_log_test.cpp
+	tests/common/sampled_table_test.cpp
+	tests/common/steadystate_step_control_test.cpp
 	tests/common/test_gravitypressure.cpp
 	)
 
@@ -43,6 +50,7 @@ list(APPEND MAIN_SOURCE_FILES
 	opm/porsol/common/blas_lapack.cpp
 	opm/porsol/common/BoundaryPeriodicity.cpp
 	opm/porsol/common/ImplicitTransportDefs.cpp
+	opm/porsol/common/PerformanceLog.cpp
 	opm/porsol/common/setupGridAndProps.cpp
 	opm/porsol/euler/ImplicitCapillarity.cpp
 	opm/upscaling/ParserAdditions.cpp
@@ -69,6 +77,7 @@ list (APPEND TEST_DATA_FILES
   tests/input_data/reference_solutions/upscale_perm_BCflp_27cellsIso.txt 
   tests/input_data/reference_solutions/upscale_perm_BCfl_EightCells.txt 
   tests/input_data/reference_solutions/upscale_perm_BCflp_Hummocky.txt
+  tests/input_data/reference_solutions/upscale_singlephase_BCf_Hummocky.txt
 	tests/input_data/reference_solutions/upscale_relperm_BCf_pts20_surfTens11_stonefile_benchmark_stonefile_benchmark_benchmark_tiny_grid.txt
 	tests/input_data/reference_solutions/upscale_relperm_BCf_pts30_surfTens11_stone1_stone1_EightCells.txt
 	tests/input_data/reference_solutions/upscale_relperm_BCf_pts30_surfTens11_stone1_stone2_EightCells.txt
@@ -114,6 +123,8 @@ list (APPEND EXAMPLE_SOURCE_FILES
 
 list (APPEND ADDITIONAL_SOURCE_FILES
 	benchmarks/upscale_relperm_benchmark.cpp
+	benchmarks/upscale_synthetic_benchmark.cpp
+	benchmarks/upscale_kernel_microbenchmark.cpp
 	)
 
 # originally generated with the command:
@@ -166,7 +177,9 @@ list (APPEND PUBLIC_HEADER_FILES
 	opm/porsol/blackoil/fluid/MiscibilityLiveOil.hpp
 	opm/porsol/blackoil/fluid/MiscibilityProps.hpp
 	opm/porsol/blackoil/fluid/MiscibilityWater.hpp
+	opm/porsol/common/AndersonAcceleration.hpp
 	opm/porsol/common/BCRSMatrixBlockAssembler.hpp
+	opm/porsol/common/BrentRootFinder.hpp
 	opm/porsol/common/blas_lapack.hpp
 	opm/porsol/common/BoundaryConditions.hpp
 	opm/porsol/common/BoundaryPeriodicity.hpp
@@ -175,6 +188,8 @@ list (APPEND PUBLIC_HEADER_FILES
 	opm/porsol/common/ImplicitTransportDefs.hpp
 	opm/porsol/common/Matrix.hpp
 	opm/porsol/common/MatrixInverse.hpp
+	opm/porsol/common/MixedPrecisionPreconditioner.hpp
+	opm/porsol/common/PerformanceLog.hpp
 	opm/porsol/common/PeriodicHelpers.hpp
 	opm/porsol/common/ReservoirPropertyCapillaryAnisotropicRelperm.hpp
 	opm/porsol/common/ReservoirPropertyCapillaryAnisotropicRelperm_impl.hpp
@@ -188,6 +203,7 @@ list (APPEND PUBLIC_HEADER_FILES
 	opm/porsol/common/Rock.hpp
 	opm/porsol/common/Rock_impl.hpp
 	opm/porsol/common/RockJfunc.hpp
+	opm/porsol/common/SampledTableLinear.hpp
 	opm/porsol/common/setupBoundaryConditions.hpp
 	opm/porsol/common/setupGridAndProps.hpp
 	opm/porsol/common/SimulatorBase.hpp
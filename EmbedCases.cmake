@@ -50,9 +50,12 @@ endmacro (opm_pack_stone)
 opm_pack_stone (upscale_relperm_benchmark)
 opm_pack_case (upscale_relperm_benchmark benchmark20)
 
+# benchmarks that generate their models need no packed cases
+list(APPEND OPM_BENCHMARKS upscale_synthetic_benchmark upscale_kernel_microbenchmark)
+
 if(INSTALL_BENCHMARKS)
-	add_custom_target(benchmarks ALL DEPENDS upscale_relperm_benchmark)
-	set_target_properties(upscale_relperm_benchmark PROPERTIES EXCLUDE_FROM_ALL 0)
+	add_custom_target(benchmarks ALL DEPENDS upscale_relperm_benchmark upscale_synthetic_benchmark upscale_kernel_microbenchmark)
+	set_target_properties(upscale_relperm_benchmark upscale_synthetic_benchmark upscale_kernel_microbenchmark PROPERTIES EXCLUDE_FROM_ALL 0)
 else()
-	add_custom_target(benchmarks DEPENDS upscale_relperm_benchmark)
+	add_custom_target(benchmarks DEPENDS upscale_relperm_benchmark upscale_synthetic_benchmark upscale_kernel_microbenchmark)
 endif()
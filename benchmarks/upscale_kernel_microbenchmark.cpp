@@ -0,0 +1,364 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+   @file upscale_kernel_microbenchmark.cpp
+   @brief Timings of single kernels on a Cartesian grid.
+
+   The grid is made by initCPGrid, by default in "cartesian" mode with
+   the parameters nx, ny, nz, dx, dy, dz. Properties are uniform, so
+   the timings depend only on the grid size. The kernels are
+
+   - mimetic_ip: MimeticIPEvaluator::evaluate for all cells.
+   - flow_assembly: the assembly in IncompFlowSolverHybrid::solve
+     (assembleDynamic), fixed boundary conditions.
+   - amg_setup and amg_apply: preconditioner setup, and the rest of the
+     linear solve, for the given linsolver_type (default 3, fast AMG).
+   - transport_residual: EulerUpstreamResidual::computeResidual on the
+     flow solution, with viscous, gravity and capillary terms.
+   - elasticity_matrix and elasticity_load: ElasticityUpscale::assemble
+     of the stiffness matrix and of one load vector. The element matrix
+     cache is off by default (elem_cache_size), since on a uniform grid
+     all cells would share one entry.
+
+   Each kernel is run once untimed and then 'repeats' times. The bytes
+   per cell are a nominal count of the data the kernel has to move
+   (grid geometry, properties, matrix entries read and written once),
+   computed from the actual faces per cell. They are not hardware
+   counter readings, but are fixed for a given grid, so the bandwidth
+   column compares implementations of one kernel fairly. For amg_apply
+   they count four passes over the fine-level matrix per iteration (CG
+   product, residual, pre- and post-smoothing); coarse levels are not
+   counted.
+
+   Results are written as CSV (to stdout, and to 'output' if given).
+*/
+
+#include <config.h>
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+
+#include <dune/common/version.hh>
+#if DUNE_VERSION_NEWER(DUNE_COMMON, 2, 3)
+#include <dune/common/parallel/mpihelper.hh>
+#else
+#include <dune/common/mpihelper.hh>
+#endif
+#include <dune/grid/CpGrid.hpp>
+
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/SparseVector.hpp>
+#include <opm/parser/eclipse/Units/Units.hpp>
+
+#include <opm/porsol/common/BoundaryConditions.hpp>
+#include <opm/porsol/common/GridInterfaceEuler.hpp>
+#include <opm/porsol/common/Matrix.hpp>
+#include <opm/porsol/common/PerformanceLog.hpp>
+#include <opm/porsol/common/ReservoirPropertyCapillary.hpp>
+#include <opm/porsol/common/setupBoundaryConditions.hpp>
+#include <opm/porsol/euler/EulerUpstreamResidual.hpp>
+#include <opm/porsol/mimetic/IncompFlowSolverHybrid.hpp>
+#include <opm/porsol/mimetic/MimeticIPEvaluator.hpp>
+#include <opm/elasticity/elasticity_upscale.hpp>
+#include <opm/upscaling/initCPGrid.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    typedef Opm::GridInterfaceEuler<Dune::CpGrid>                 GI;
+    typedef GI::CellIterator                                      CI;
+    typedef CI::FaceIterator                                      FI;
+    typedef Opm::BasicBoundaryConditions<true, true>              BCs;
+    typedef Opm::ReservoirPropertyCapillary<3>                    RI;
+    typedef Opm::IncompFlowSolverHybrid<GI, RI, BCs,
+                                        Opm::MimeticIPEvaluator>  FlowSolver;
+    typedef Opm::EulerUpstreamResidual<GI, RI, BCs>               TransportResidual;
+    typedef Opm::Elasticity::ElasticityUpscale<Dune::CpGrid,
+        Opm::Elasticity::AMG1<Opm::Elasticity::SSORSmoother> >    ElasticityUpscaler;
+
+    // Face counts of the grid, for the nominal traffic estimates.
+    struct GridCounts
+    {
+        GridCounts() : cells(0), max_nf(0), sum_nf(0), sum_nf2(0), boundary_faces(0) {}
+        int cells;
+        int max_nf;
+        long sum_nf;
+        long sum_nf2;
+        long boundary_faces;
+
+        long interiorFaces() const
+        {
+            return (sum_nf - boundary_faces)/2;
+        }
+
+        // Nonzeros of the hybrid system: every cell couples all its
+        // faces, and each interior face diagonal is shared by two cells.
+        long hybridNonzeros() const
+        {
+            return sum_nf2 - interiorFaces();
+        }
+    };
+
+    GridCounts countFaces(const GI& g)
+    {
+        GridCounts counts;
+        for (CI c = g.cellbegin(); c != g.cellend(); ++c) {
+            int nf = 0;
+            for (FI f = c->facebegin(); f != c->faceend(); ++f) {
+                ++nf;
+                if (f->boundary()) {
+                    ++counts.boundary_faces;
+                }
+            }
+            ++counts.cells;
+            counts.max_nf = std::max(counts.max_nf, nf);
+            counts.sum_nf += nf;
+            counts.sum_nf2 += nf*nf;
+        }
+        return counts;
+    }
+
+    struct KernelRow
+    {
+        std::string kernel;
+        long samples;
+        double seconds;
+        double bytes_per_cell;
+    };
+
+    // Wall-clock time of the given entry of the global log, over the
+    // samples added since the last clear().
+    double loggedTime(const std::string& name)
+    {
+        return Opm::PerformanceLog::global().entry(name).total;
+    }
+}
+
+int main(int argc, char** argv)
+try
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    Opm::parameter::ParameterGroup param(argc, argv);
+    if (!param.has("fileformat")) {
+        param.insertParameter("fileformat", "cartesian");
+    }
+    const int repeats = param.getDefault("repeats", 5);
+    const int threads = param.getDefault("threads", 0);
+    const std::string kernels = param.getDefault<std::string>("kernels", "mimetic_ip,flow,transport,elasticity");
+    const std::string output = param.getDefault<std::string>("output", "");
+    const double residual_tolerance = param.getDefault("residual_tolerance", 1e-8);
+    const int linsolver_type = param.getDefault("linsolver_type", 3);
+    const int elem_cache_size = param.getDefault("elem_cache_size", 0);
+
+    Dune::CpGrid grid;
+    Opm::initCPGrid(grid, param);
+
+    if (param.anyUnused()) {
+        std::cout << "*****     WARNING: Unused parameters:     *****\n";
+        param.displayUsage();
+    }
+    if (repeats < 1) {
+        std::cerr << "Error: repeats (" << repeats << ") must be positive.\n";
+        exit(1);
+    }
+#ifdef HAVE_OPENMP
+    if (threads > 0) {
+        omp_set_num_threads(threads);
+    }
+    const int num_threads = omp_get_max_threads();
+#else
+    const int num_threads = 1;
+    (void)threads;
+#endif
+    const bool run_mimetic = kernels.find("mimetic_ip") != std::string::npos;
+    const bool run_flow = kernels.find("flow") != std::string::npos;
+    const bool run_transport = kernels.find("transport") != std::string::npos;
+    const bool run_elasticity = kernels.find("elasticity") != std::string::npos;
+
+    GI g(grid);
+    const GridCounts counts = countFaces(g);
+    const int num_cells = counts.cells;
+    const double dbl = sizeof(double);
+    const double idx = sizeof(int);
+    std::vector<KernelRow> rows;
+
+    RI r;
+    r.init(num_cells);
+    CI::Vector gravity(0.0);
+    gravity[2] = Opm::unit::gravity;
+
+    if (run_mimetic) {
+        Opm::MimeticIPEvaluator<GI, RI> ip(counts.max_nf);
+        std::vector<double> Binv_storage(counts.max_nf*counts.max_nf);
+        double start = 0.0;
+        for (int rep = 0; rep <= repeats; ++rep) {
+            if (rep == 1) {
+                start = Opm::wallClockTime();
+            }
+            for (CI c = g.cellbegin(); c != g.cellend(); ++c) {
+                int nf = 0;
+                for (FI f = c->facebegin(); f != c->faceend(); ++f) {
+                    ++nf;
+                }
+                Opm::SharedFortranMatrix Binv(nf, nf, &Binv_storage[0]);
+                ip.evaluate(c, r.permeability(c->index()), Binv);
+            }
+        }
+        // Per face centroid, normal and area; cell centroid, volume and
+        // permeability; the nf x nf result.
+        const double bytes = dbl*(7*counts.sum_nf + 4*num_cells + 9*num_cells + counts.sum_nf2);
+        KernelRow row = { "mimetic_ip", repeats, Opm::wallClockTime() - start, bytes/num_cells };
+        rows.push_back(row);
+    }
+
+    if (run_flow || run_transport) {
+        BCs bcs;
+        Opm::setupUpscalingConditions(g, 0, 0, 1.0*Opm::unit::barsa, 1.0, false, bcs);
+        FlowSolver solver;
+        solver.init(g, r, gravity, bcs);
+        std::vector<double> src(num_cells, 0.0);
+        std::vector<double> sat(num_cells, 0.5);
+
+        // The untimed first solve also provides the flux field for the
+        // transport residual.
+        solver.solve(r, sat, bcs, src, residual_tolerance, 0, linsolver_type);
+
+        if (run_flow) {
+            Opm::PerformanceLog& log = Opm::PerformanceLog::global();
+            log.clear();
+            for (int rep = 0; rep < repeats; ++rep) {
+                solver.solve(r, sat, bcs, src, residual_tolerance, 0, linsolver_type);
+            }
+            const double setup = loggedTime("flow_solver/preconditioner_setup");
+            const double iterations = log.entry("flow_solver/linear_iterations").total;
+            const double nnz = counts.hybridNonzeros();
+            // Inverse inner products read, cell matrices added into the
+            // global matrix (read and write), and the face indices.
+            const double assembly_bytes = (dbl*3*counts.sum_nf2 + idx*counts.sum_nf)/num_cells;
+            KernelRow assembly = { "flow_assembly", repeats, loggedTime("flow_solver/assembly"), assembly_bytes };
+            KernelRow amg_setup = { "amg_setup", repeats, setup, (dbl + idx)*nnz/num_cells };
+            KernelRow amg_apply = { "amg_apply", repeats, loggedTime("flow_solver/linear_solve"),
+                                    4*(dbl + idx)*nnz*(iterations/repeats)/num_cells };
+            rows.push_back(assembly);
+            rows.push_back(amg_setup);
+            rows.push_back(amg_apply);
+        }
+
+        if (run_transport) {
+            TransportResidual residual(g, r, bcs);
+            Opm::SparseVector<double> injection(num_cells);
+            std::vector<double> sat_delta;
+            residual.computeCapPressures(sat);
+            double start = 0.0;
+            for (int rep = 0; rep <= repeats; ++rep) {
+                if (rep == 1) {
+                    start = Opm::wallClockTime();
+                }
+                residual.computeResidual(sat, gravity, solver.getSolution(), injection,
+                                         true, true, true, sat_delta);
+            }
+            // Per cell saturation, two mobilities, capillary pressure and
+            // the residual; per face the flux, the neighbour index and
+            // its saturation.
+            const double bytes = dbl*5*num_cells + (2*dbl + idx)*counts.sum_nf;
+            KernelRow row = { "transport_residual", repeats, Opm::wallClockTime() - start, bytes/num_cells };
+            rows.push_back(row);
+        }
+    }
+
+    if (run_elasticity) {
+        ElasticityUpscaler upscale(grid, 1.e-6, 0.0, "uniform", "", false);
+        double min[3], max[3];
+        upscale.findBoundaries(min, max);
+        upscale.setElementCacheSize(elem_cache_size);
+        upscale.fixCorners(min, max);
+        upscale.A.initForAssembly();
+        // Eight corner coordinates and the material per cell, plus the
+        // 24 x 24 element matrix added into the global matrix, or the
+        // 24 element loads added into the load vector.
+        const double geometry = dbl*(8*3 + 2);
+        double start = 0.0;
+        for (int rep = 0; rep <= repeats; ++rep) {
+            if (rep == 1) {
+                start = Opm::wallClockTime();
+            }
+            upscale.assemble(-1, true);
+        }
+        KernelRow matrix = { "elasticity_matrix", repeats, Opm::wallClockTime() - start,
+                             geometry + 2*dbl*24*24 };
+        rows.push_back(matrix);
+        for (int rep = 0; rep <= repeats; ++rep) {
+            if (rep == 1) {
+                start = Opm::wallClockTime();
+            }
+            upscale.assemble(0, false);
+        }
+        KernelRow load = { "elasticity_load", repeats, Opm::wallClockTime() - start,
+                           geometry + 2*dbl*24 };
+        rows.push_back(load);
+    }
+
+    const std::array<int, 3> dims = grid.logicalCartesianSize();
+    std::ostringstream outputtmp;
+    outputtmp.precision(6);
+    outputtmp << "# upscale_kernel_microbenchmark results, format version 1\n"
+              << "# bytes_per_cell is a nominal count, see the program documentation.\n"
+              << "kernel,nx,ny,nz,cells,threads,samples,seconds,ns_per_cell,bytes_per_cell,gbytes_per_second\n";
+    for (std::size_t k = 0; k < rows.size(); ++k) {
+        const KernelRow& row = rows[k];
+        const double cell_samples = double(row.samples)*num_cells;
+        const double ns_per_cell = 1e9*row.seconds/cell_samples;
+        const double bandwidth = row.seconds > 0.0 ? 1e-9*row.bytes_per_cell*cell_samples/row.seconds : 0.0;
+        outputtmp << row.kernel << ',' << dims[0] << ',' << dims[1] << ',' << dims[2] << ','
+                  << num_cells << ',' << num_threads << ',' << row.samples << ','
+                  << row.seconds << ',' << ns_per_cell << ',' << row.bytes_per_cell << ','
+                  << bandwidth << '\n';
+    }
+
+    std::cout << outputtmp.str();
+    if (output != "") {
+        std::ofstream outfile(output.c_str());
+        if (!outfile) {
+            std::cerr << "Could not open file " << output << "\n";
+            throw std::runtime_error("Could not open output file.");
+        }
+        outfile << outputtmp.str();
+    }
+    return 0;
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
@@ -110,6 +110,7 @@
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 
+#include <opm/porsol/common/PerformanceLog.hpp>
 #include <opm/upscaling/RelPermUtils.hpp>
 
 #include <opm/parser/eclipse/Units/Units.hpp>
@@ -178,7 +179,7 @@ try
 {
 
     // Variables used for timing/profiling:
-    clock_t start, finish;
+    double start, finish;
     double timeused = 0.0;
 #ifdef HAVE_MPI
     double timeused_tesselation = 0.0;
@@ -186,7 +187,7 @@ try
     OPM_UNUSED double timeused_tesselation = 0.0;
 #endif
 
-    clock_t global_start = clock(); // Timing used for benchmarking
+    double global_start = wallClockTime(); // Timing used for benchmarking
 
     /******************************************************************************
      * Step 1:
@@ -264,7 +265,7 @@ try
     // populate our vectors with data from the file
 
     if (helper.isMaster) cout << "Parsing Eclipse file... ";
-    flush(cout);   start = clock();
+    flush(cout);   start = wallClockTime();
 
     // create the parser
     Opm::Parser parser;
@@ -273,13 +274,13 @@ try
     Opm::ParseContext mode;
     auto deck = parser.parseString(gridstringstream.str(), mode);
 
-    finish = clock();   timeused = (double(finish)-double(start))/CLOCKS_PER_SEC;
+    finish = wallClockTime();   timeused = finish - start;
     if (helper.isMaster) cout << " (" << timeused <<" secs)" << endl;
 
     const double minPerm = atof(options["minPerm"].c_str());
     const double maxPerm = atof(options["maxPerm"].c_str());
     const double minPoro = atof(options["minPoro"].c_str());
-    start = clock();
+    start = wallClockTime();
     helper.sanityCheckInput(deck, minPerm, maxPerm, minPoro);
 
     const Opm::DeckRecord& specgridRecord(deck.getKeyword("SPECGRID").getRecord(0));
@@ -420,7 +421,7 @@ try
 
     helper.upscaleCapillaryPressure();
 
-    clock_t start_upscaling = clock();
+    double start_upscaling = wallClockTime();
 
     /*****************************************************************************
      * Step 7:
@@ -452,6 +453,7 @@ try
     double timeused_upscale_wallclock, avg_upscaling_time_pr_point;
     std::tie(timeused_upscale_wallclock, avg_upscaling_time_pr_point) =
                 helper.upscalePermeability(mpi_rank);
+    PerformanceLog::global().gatherRanks();
 
     /*
      * Step 8c: Make relperm values from phaseperms
@@ -559,10 +561,10 @@ try
         std::cout.rdbuf(cout_sbuf); // restore the original stream buffer
         std::cerr.rdbuf(cerr_sbuf);
 
-        clock_t global_finish = clock();
-        double processing_time = (double(start_upscaling) - double(global_start))/CLOCKS_PER_SEC;
-        double upscaling_time = (double(global_finish) - double(start_upscaling))/CLOCKS_PER_SEC;
-        double benchmark_time = (double(global_finish) - double(global_start))/CLOCKS_PER_SEC;
+        double global_finish = wallClockTime();
+        double processing_time = start_upscaling - global_start;
+        double upscaling_time = global_finish - start_upscaling;
+        double benchmark_time = global_finish - global_start;
         double benchmark_time_min = floor(benchmark_time/60.0);
         double benchmark_time_sec = benchmark_time - benchmark_time_min*60;
         stringstream outputtmp;
@@ -618,6 +620,13 @@ try
         outputtmp << "Wallclock timing:\n";
         outputtmp << "Input- and grid processing: " << processing_time << " sec" << endl;
         outputtmp << "Upscaling:                  " << upscaling_time << " sec" << endl;
+        // Solver phases are summed over all processes.
+        const PerformanceLog& log = PerformanceLog::global();
+        const PerformanceLog::Entry iterations = log.entry("flow_solver/linear_iterations");
+        outputtmp << "  Assembly:                 " << log.entry("flow_solver/assembly").total << " sec" << endl;
+        outputtmp << "  Preconditioner setup:     " << log.entry("flow_solver/preconditioner_setup").total << " sec" << endl;
+        outputtmp << "  Linear solve:             " << log.entry("flow_solver/linear_solve").total << " sec" << endl;
+        outputtmp << "  Linear iterations:        " << iterations.total << " in " << iterations.samples << " solves" << endl;
         outputtmp << "Total wallclock time:       " << benchmark_time << " sec";
 
         if (benchmark_time > 60.0) {
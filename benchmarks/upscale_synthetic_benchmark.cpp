@@ -0,0 +1,650 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+   @file upscale_synthetic_benchmark.cpp
+   @brief Benchmark of the upscaling kernels on generated models.
+
+   A corner-point model is generated from the parameters, so the model
+   size and heterogeneity can be chosen freely without input files:
+
+   - nx, ny, nz, dx, dy, dz: grid dimensions and cell sizes (metres).
+   - heterogeneity: lognormal (uncorrelated cells), layered (one value
+     per layer) or channel (one sinuous high-permeability channel per
+     layer in a low-permeability background).
+   - perm_mean (mD), perm_logstd, kvkh: permeability distribution.
+   - fault_throw (metres): cells with i >= nx/2 are shifted down.
+   - seed: random seed.
+
+   The kernels timed are
+   - single_phase_init and single_phase: SinglePhaseUpscaler::init and
+     upscaleSinglePhase for each boundary condition in 'bcs' (f, l, p),
+     repeated 'repeats' times.
+   - relperm_points: 'points' phase permeability upscalings of the
+     fixed-BC problem, as done for each pressure point by
+     upscale_relperm. The cell saturations come from a Brooks-Corey
+     J-function and the phase permeabilities from a Corey curve. This
+     is run once for each thread count in 'threads', and the points are
+     dealt round-robin to the MPI ranks.
+   - steady_state_init and steady_state: SteadyStateUpscaler::init and
+     'steady_state_steps' explicit transport steps of a fixed-BC
+     steady-state upscaling, from a uniform saturation. All cells use
+     one generated Corey/Brooks-Corey rock table, sampled uniformly if
+     'rock_table_intervals' is positive. The model and the table are
+     written to files starting with 'work_prefix', and removed after.
+   - elasticity_setup and elasticity_load_cases: ElasticityUpscale
+     operator assembly and solver setup, then the six load cases
+     (assembly, solve and stress average), with uniform material and
+     fixed corners, as in upscale_kernel_microbenchmark. Turned off
+     with 'elasticity=false'.
+   - flow_solver/...: time and iterations spent in the pressure solver.
+
+   Results are written as CSV (to stdout, and to 'output' if given).
+   The single-phase, steady-state and elasticity kernels run on rank 0
+   only. The columns are fixed; new kernels only add rows. Scaling over ranks
+   is measured by running with different rank counts, the 'ranks'
+   column tells the runs apart.
+*/
+
+#include <config.h>
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+
+#include <dune/common/version.hh>
+#if DUNE_VERSION_NEWER(DUNE_COMMON, 2, 3)
+#include <dune/common/parallel/mpihelper.hh>
+#else
+#include <dune/common/mpihelper.hh>
+#endif
+#include <dune/grid/CpGrid.hpp>
+
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#include <opm/parser/eclipse/Parser/ParseContext.hpp>
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/Units/Units.hpp>
+
+#include <opm/parser/eclipse/EclipseState/Grid/EclipseGrid.hpp>
+
+#include <opm/porsol/common/Matrix.hpp>
+#include <opm/porsol/common/PerformanceLog.hpp>
+
+#include <opm/elasticity/elasticity_upscale.hpp>
+#include <opm/upscaling/SinglePhaseUpscaler.hpp>
+#include <opm/upscaling/SteadyStateUpscaler.hpp>
+#include <opm/upscaling/UpscalingTraits.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+
+namespace
+{
+    struct ModelSpec
+    {
+        int nx, ny, nz;
+        double dx, dy, dz;
+        std::string heterogeneity;
+        double perm_mean;
+        double perm_logstd;
+        double kvkh;
+        double fault_throw;
+        unsigned int seed;
+    };
+
+    // Horizontal permeability (mD) and porosity per cell, in Eclipse order.
+    void generateProperties(const ModelSpec& spec,
+                            std::vector<double>& perm,
+                            std::vector<double>& poro)
+    {
+        const int num_cells = spec.nx*spec.ny*spec.nz;
+        perm.resize(num_cells);
+        poro.resize(num_cells);
+
+        boost::mt19937 gen(spec.seed);
+        boost::normal_distribution<> normdist(0.0, 1.0);
+        boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > normal(gen, normdist);
+        boost::uniform_real<> unifdist(0.0, 1.0);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<> > uniform(gen, unifdist);
+
+        const double logmean = std::log(spec.perm_mean);
+        const double pi = 3.14159265358979323846;
+        for (int k = 0; k < spec.nz; ++k) {
+            // Per-layer values for the layered and channel models.
+            const double layer_logk = logmean + spec.perm_logstd*normal();
+            const double width = 0.15*spec.ny*spec.dy;
+            const double centre = (0.25 + 0.5*uniform())*spec.ny*spec.dy;
+            const double amplitude = 0.2*spec.ny*spec.dy;
+            const double wavelength = (0.5 + uniform())*spec.nx*spec.dx;
+            const double phase = 2.0*pi*uniform();
+            for (int j = 0; j < spec.ny; ++j) {
+                for (int i = 0; i < spec.nx; ++i) {
+                    const int cell = i + spec.nx*(j + spec.ny*k);
+                    double logk = 0.0;
+                    if (spec.heterogeneity == "lognormal") {
+                        logk = logmean + spec.perm_logstd*normal();
+                    } else if (spec.heterogeneity == "layered") {
+                        logk = layer_logk;
+                    } else if (spec.heterogeneity == "channel") {
+                        const double x = (i + 0.5)*spec.dx;
+                        const double y = (j + 0.5)*spec.dy;
+                        const double yc = centre + amplitude*std::sin(2.0*pi*x/wavelength + phase);
+                        const bool in_channel = std::fabs(y - yc) < 0.5*width;
+                        logk = (in_channel ? logmean + std::log(5.0) : logmean - std::log(20.0))
+                            + 0.25*spec.perm_logstd*normal();
+                    } else {
+                        throw std::runtime_error("Unknown heterogeneity '" + spec.heterogeneity
+                                                 + "', use lognormal, layered or channel.");
+                    }
+                    perm[cell] = std::exp(logk);
+                    poro[cell] = std::min(0.35, std::max(0.02, 0.2 + 0.03*(logk - logmean)));
+                }
+            }
+        }
+    }
+
+    std::string makeDeck(const ModelSpec& spec,
+                         const std::vector<double>& perm,
+                         const std::vector<double>& poro)
+    {
+        const int nx = spec.nx, ny = spec.ny, nz = spec.nz;
+        const double zbottom = nz*spec.dz + std::max(spec.fault_throw, 0.0);
+        std::ostringstream os;
+        os.precision(10);
+        os << "RUNSPEC\n\nDIMENS\n " << nx << ' ' << ny << ' ' << nz << " /\n\nOIL\nWATER\n\nMETRIC\n\n";
+        os << "GRID\n\nCOORD\n";
+        for (int j = 0; j <= ny; ++j) {
+            for (int i = 0; i <= nx; ++i) {
+                os << i*spec.dx << ' ' << j*spec.dy << " 0 "
+                   << i*spec.dx << ' ' << j*spec.dy << ' ' << zbottom << '\n';
+            }
+        }
+        os << "/\n\nZCORN\n";
+        // Corners are ordered with i fastest, then j, top before bottom,
+        // then k. Each cell has two corners along each axis.
+        for (int k = 0; k < nz; ++k) {
+            for (int kk = 0; kk < 2; ++kk) {
+                for (int j = 0; j < ny; ++j) {
+                    for (int jj = 0; jj < 2; ++jj) {
+                        for (int i = 0; i < nx; ++i) {
+                            const double z = (k + kk)*spec.dz + (2*i >= nx ? spec.fault_throw : 0.0);
+                            os << z << ' ' << z << ' ';
+                        }
+                        os << '\n';
+                    }
+                }
+            }
+        }
+        os << "/\n\n";
+        const char* perm_keywords[3] = { "PERMX", "PERMY", "PERMZ" };
+        for (int d = 0; d < 3; ++d) {
+            const double factor = (d == 2) ? spec.kvkh : 1.0;
+            os << perm_keywords[d] << '\n';
+            for (std::size_t c = 0; c < perm.size(); ++c) {
+                os << factor*perm[c] << '\n';
+            }
+            os << "/\n\n";
+        }
+        os << "PORO\n";
+        for (std::size_t c = 0; c < poro.size(); ++c) {
+            os << poro[c] << '\n';
+        }
+        os << "/\n";
+        return os.str();
+    }
+
+    // Rock table (Sw, krw, kro, J) with Corey relperms and a Brooks-Corey
+    // J-function, in the format read by RockJfunc.
+    std::string makeRockTable(double lambda)
+    {
+        const double swir = 0.1;
+        const double sor = 0.1;
+        const int num_rows = 41;
+        std::ostringstream os;
+        os.precision(10);
+        os << "#Sw\tKrw\tKro\tJ\n";
+        for (int i = 0; i < num_rows; ++i) {
+            const double sn = double(i)/(num_rows - 1);
+            // J is finite at the first row, half a row inside.
+            const double J = std::pow(std::max(sn, 0.5/(num_rows - 1)), -1.0/lambda);
+            os << swir + sn*(1.0 - swir - sor) << '\t' << std::pow(sn, 3.0) << '\t'
+               << std::pow(1.0 - sn, 2.0) << '\t' << J << '\n';
+        }
+        return os.str();
+    }
+
+    void writeFile(const std::string& filename, const std::string& contents)
+    {
+        std::ofstream os(filename.c_str());
+        if (!os) {
+            throw std::runtime_error("Could not open file " + filename);
+        }
+        os << contents;
+    }
+
+    std::vector<int> parseIntList(const std::string& list)
+    {
+        std::vector<int> values;
+        std::istringstream is(list);
+        std::string item;
+        while (std::getline(is, item, ',')) {
+            values.push_back(std::atoi(item.c_str()));
+        }
+        return values;
+    }
+
+    struct BenchmarkRow
+    {
+        std::string kernel;
+        std::string variant;
+        int threads;
+        long samples;
+        double seconds;
+    };
+
+    void barrier()
+    {
+#if defined(HAVE_MPI) && HAVE_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    }
+
+    // Rethrows the error of this rank, if any. The ranks agree first,
+    // so that none is left waiting in a later collective call.
+    void throwOnAnyRank(const std::exception_ptr& error)
+    {
+        int failed = error ? 1 : 0;
+#if defined(HAVE_MPI) && HAVE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+#endif
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (failed) {
+            throw std::runtime_error("The benchmark failed on another rank.");
+        }
+    }
+
+    double maxOverRanks(double value)
+    {
+#if defined(HAVE_MPI) && HAVE_MPI
+        double result;
+        MPI_Allreduce(&value, &result, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        return result;
+#else
+        return value;
+#endif
+    }
+}
+
+int main(int argc, char** argv)
+try
+{
+    Dune::MPIHelper& mpi = Dune::MPIHelper::instance(argc, argv);
+    const int mpi_rank = mpi.rank();
+    const int mpi_size = mpi.size();
+
+    Opm::parameter::ParameterGroup param(argc, argv);
+    ModelSpec spec;
+    spec.nx = param.getDefault("nx", 40);
+    spec.ny = param.getDefault("ny", 40);
+    spec.nz = param.getDefault("nz", 20);
+    spec.dx = param.getDefault("dx", 10.0);
+    spec.dy = param.getDefault("dy", 10.0);
+    spec.dz = param.getDefault("dz", 1.0);
+    spec.heterogeneity = param.getDefault<std::string>("heterogeneity", "lognormal");
+    spec.perm_mean = param.getDefault("perm_mean", 100.0);
+    spec.perm_logstd = param.getDefault("perm_logstd", 1.0);
+    spec.kvkh = param.getDefault("kvkh", 0.1);
+    spec.fault_throw = param.getDefault("fault_throw", 0.0);
+    spec.seed = param.getDefault("seed", 1);
+    const std::string bcs = param.getDefault<std::string>("bcs", "flp");
+    const int repeats = param.getDefault("repeats", 3);
+    const int points = param.getDefault("points", 20);
+    const std::vector<int> threads = parseIntList(param.getDefault<std::string>("threads", "1"));
+    const std::string output = param.getDefault<std::string>("output", "");
+    const double minperm = param.getDefault("minperm", 1e-9);
+    const double minpermSI = Opm::unit::convert::from(minperm, Opm::prefix::milli*Opm::unit::darcy);
+    const double residual_tolerance = param.getDefault("residual_tolerance", 1e-8);
+    const int linsolver_type = param.getDefault("linsolver_type", 3);
+    const int steady_state_steps = param.getDefault("steady_state_steps", 5);
+    const int rock_table_intervals = param.getDefault("rock_table_intervals", 0);
+    const std::string work_prefix = param.getDefault<std::string>("work_prefix", "upscale_synthetic_benchmark");
+    const bool run_elasticity = param.getDefault("elasticity", true);
+
+    if (param.anyUnused()) {
+        std::cout << "*****     WARNING: Unused parameters:     *****\n";
+        param.displayUsage();
+    }
+    if (spec.nx < 2 || spec.ny < 1 || spec.nz < 1 || repeats < 1 || points < 1 || threads.empty()
+        || steady_state_steps < 0) {
+        std::cerr << "Error: invalid model size, repeats, points, threads or steady_state_steps.\n";
+        exit(1);
+    }
+    if (spec.fault_throw < 0.0) {
+        std::cerr << "Error: fault_throw (" << spec.fault_throw << ") must not be negative.\n";
+        exit(1);
+    }
+
+    // All ranks generate the same model from the same seed.
+    std::vector<double> perm, poro;
+    double start = Opm::wallClockTime();
+    generateProperties(spec, perm, poro);
+    Opm::Parser parser;
+    const std::string deck_string = makeDeck(spec, perm, poro);
+    const Opm::Deck deck = parser.parseString(deck_string, Opm::ParseContext());
+    std::vector<BenchmarkRow> rows;
+    BenchmarkRow generate = { "generate_model", "all", 1, 1, Opm::wallClockTime() - start };
+    rows.push_back(generate);
+
+    // Single-phase upscaling for each boundary condition, on rank 0 only.
+    if (mpi_rank == 0) {
+        for (std::string::size_type b = 0; b < bcs.size(); ++b) {
+            Opm::SinglePhaseUpscaler::BoundaryConditionType bctype;
+            std::string variant;
+            switch (bcs[b]) {
+            case 'f': bctype = Opm::SinglePhaseUpscaler::Fixed; variant = "fixed"; break;
+            case 'l': bctype = Opm::SinglePhaseUpscaler::Linear; variant = "linear"; break;
+            case 'p': bctype = Opm::SinglePhaseUpscaler::Periodic; variant = "periodic"; break;
+            default:
+                std::cerr << "Error: unknown boundary condition '" << bcs[b] << "' in bcs.\n";
+                exit(1);
+            }
+            try {
+                Opm::SinglePhaseUpscaler upscaler;
+                start = Opm::wallClockTime();
+                upscaler.init(deck, bctype, minpermSI, residual_tolerance, 0, linsolver_type, false);
+                BenchmarkRow init = { "single_phase_init", variant, 1, 1, Opm::wallClockTime() - start };
+                rows.push_back(init);
+                start = Opm::wallClockTime();
+                for (int r = 0; r < repeats; ++r) {
+                    upscaler.upscaleSinglePhase();
+                }
+                BenchmarkRow solve = { "single_phase", variant, 1, repeats, Opm::wallClockTime() - start };
+                rows.push_back(solve);
+            }
+            catch (const std::exception& e) {
+                // Periodic conditions need matching opposite faces, which
+                // a fault throw breaks. Record the failure and carry on.
+                std::cerr << "Warning: " << variant << " single-phase upscaling failed: " << e.what() << '\n';
+                BenchmarkRow failed = { "single_phase", variant, 1, 0, 0.0 };
+                rows.push_back(failed);
+            }
+        }
+    }
+
+    // Steady-state upscaling, on rank 0 only. The upscaler reads its
+    // model and rock tables from files, so they are written first.
+    if (mpi_rank == 0 && steady_state_steps > 0) {
+        const std::string deck_file = work_prefix + ".grdecl";
+        const std::string rock_file = work_prefix + "_rock.txt";
+        const std::string rock_list = work_prefix + "_rocklist.txt";
+        const std::string variant = rock_table_intervals > 0 ? "sampled_table" : "table";
+        try {
+            // The rock list names its rock files relative to its own directory.
+            const std::string::size_type slash = rock_file.find_last_of('/');
+            writeFile(deck_file, deck_string);
+            writeFile(rock_file, makeRockTable(2.0));
+            writeFile(rock_list, "1\n" + rock_file.substr(slash == std::string::npos ? 0 : slash + 1) + "\n");
+
+            std::ostringstream steps;
+            steps << steady_state_steps;
+            std::ostringstream intervals;
+            intervals << rock_table_intervals;
+            std::ostringstream threshold;
+            threshold << minperm;
+            Opm::parameter::ParameterGroup ss_param;
+            ss_param.insertParameter("fileformat", "eclipse");
+            ss_param.insertParameter("filename", deck_file);
+            ss_param.insertParameter("rock_list", rock_list);
+            ss_param.insertParameter("boundary_condition_type", "0");
+            ss_param.insertParameter("perm_threshold_md", threshold.str());
+            ss_param.insertParameter("simulation_steps", steps.str());
+            ss_param.insertParameter("rock_table_intervals", intervals.str());
+
+            typedef Opm::SteadyStateUpscaler<Opm::UpscalingTraitsBasic> SteadyStateUpscaler;
+            SteadyStateUpscaler upscaler;
+            start = Opm::wallClockTime();
+            upscaler.init(ss_param);
+            const SteadyStateUpscaler::permtensor_t upscaled_K = upscaler.upscaleSinglePhase();
+            BenchmarkRow init = { "steady_state_init", variant, 1, 1, Opm::wallClockTime() - start };
+            rows.push_back(init);
+
+            const double saturation = 0.5;
+            const double pressure_drop = 1e5;
+            const std::vector<double> init_sat(upscaler.grid().size(0), saturation);
+            start = Opm::wallClockTime();
+            upscaler.upscaleSteadyState(0, init_sat, saturation, pressure_drop, upscaled_K);
+            BenchmarkRow steady = { "steady_state", variant, 1, steady_state_steps, Opm::wallClockTime() - start };
+            rows.push_back(steady);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Warning: steady-state upscaling failed: " << e.what() << '\n';
+            BenchmarkRow failed = { "steady_state", variant, 1, 0, 0.0 };
+            rows.push_back(failed);
+        }
+        std::remove(deck_file.c_str());
+        std::remove(rock_file.c_str());
+        std::remove(rock_list.c_str());
+    }
+
+    // Elasticity load cases, on rank 0 only, set up as in
+    // upscale_kernel_microbenchmark.
+    if (mpi_rank == 0 && run_elasticity) {
+        typedef Opm::Elasticity::ElasticityUpscale<Dune::CpGrid,
+            Opm::Elasticity::AMG1<Opm::Elasticity::SSORSmoother> > ElasticityUpscaler;
+        try {
+            Dune::CpGrid grid;
+            {
+                Opm::EclipseGrid inputGrid(deck);
+                grid.processEclipseFormat(inputGrid, false);
+            }
+            // The default solver settings of upscale_elasticity.
+            Opm::parameter::ParameterGroup linsolver_param;
+            Opm::Elasticity::LinSolParams linsolver;
+            linsolver.parse(linsolver_param);
+
+            ElasticityUpscaler upscale(grid, 1.e-6, 0.0, "uniform", "", false);
+            double min[3], max[3];
+            start = Opm::wallClockTime();
+            upscale.findBoundaries(min, max);
+            upscale.fixCorners(min, max);
+            upscale.A.initForAssembly();
+            upscale.assemble(-1, true);
+            upscale.setupSolvers(linsolver);
+            BenchmarkRow setup = { "elasticity_setup", "fixed_corners", 1, 1, Opm::wallClockTime() - start };
+            rows.push_back(setup);
+
+            start = Opm::wallClockTime();
+            for (int i = 0; i < 6; ++i) {
+                upscale.assemble(i, false);
+                upscale.solve(i);
+                Dune::FieldVector<double,6> stress;
+                upscale.averageStress(stress, upscale.u[i], i);
+            }
+            BenchmarkRow cases = { "elasticity_load_cases", "fixed_corners", 1, 6, Opm::wallClockTime() - start };
+            rows.push_back(cases);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Warning: elasticity upscaling failed: " << e.what() << '\n';
+            BenchmarkRow failed = { "elasticity_load_cases", "fixed_corners", 1, 0, 0.0 };
+            rows.push_back(failed);
+        }
+    }
+
+    // Relperm pressure points, for each thread count.
+    const double pcmin = 0.5;
+    const double pcmax = 20.0;
+    const double lambda = 2.0;
+    for (std::size_t t = 0; t < threads.size(); ++t) {
+#ifdef HAVE_OPENMP
+        omp_set_num_threads(threads[t]);
+#endif
+        // Each thread works on its own copy of the problem. Exceptions
+        // must not leave the parallel regions, so the first one is kept
+        // and rethrown after them.
+        std::vector<std::unique_ptr<Opm::SinglePhaseUpscaler> > upscalers(threads[t]);
+        std::exception_ptr error;
+        bool failed = false;
+        double init_time = 0.0;
+#pragma omp parallel
+        {
+            int thread = 0;
+#ifdef HAVE_OPENMP
+            thread = omp_get_thread_num();
+#endif
+#pragma omp critical (benchmark_init)
+            {
+                try {
+                    const double init_start = Opm::wallClockTime();
+                    upscalers[thread].reset(new Opm::SinglePhaseUpscaler);
+                    upscalers[thread]->init(deck, Opm::SinglePhaseUpscaler::Fixed, minpermSI,
+                                            residual_tolerance, 0, linsolver_type, false);
+                    init_time += Opm::wallClockTime() - init_start;
+                }
+                catch (...) {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+        throwOnAnyRank(error);
+
+        // MPI is only initialised for the main thread, so the ranks are
+        // synchronised outside the parallel region.
+        barrier();
+        const double points_start = Opm::wallClockTime();
+#pragma omp parallel
+        {
+            int thread = 0;
+#ifdef HAVE_OPENMP
+            thread = omp_get_thread_num();
+#endif
+            Opm::SinglePhaseUpscaler& upscaler = *upscalers[thread];
+            const std::vector<int>& global_cell = upscaler.grid().globalCell();
+            Opm::SinglePhaseUpscaler::permtensor_t cellperm(3, 3, nullptr);
+#pragma omp for schedule(dynamic)
+            for (int p = 0; p < points; ++p) {
+                // points are distributed round-robin over the processes
+                if (p % mpi_size != mpi_rank || failed) {
+                    continue;
+                }
+                try {
+                    const double pc = pcmin*std::pow(pcmax/pcmin, double(p)/std::max(points - 1, 1));
+                    for (std::size_t i = 0; i < global_cell.size(); ++i) {
+                        const int c = global_cell[i];
+                        // Brooks-Corey J-function scaled by sqrt(k/phi), Corey relperm.
+                        const double J = pc*std::sqrt((perm[c]/poro[c])/(spec.perm_mean/0.2));
+                        const double sw = std::min(1.0, std::pow(std::max(J, 1e-12), -lambda));
+                        const double kr = std::pow(sw, 4.0);
+                        const double kh = Opm::unit::convert::from(std::max(kr*perm[c], minperm),
+                                                                   Opm::prefix::milli*Opm::unit::darcy);
+                        zero(cellperm);
+                        cellperm(0,0) = kh;
+                        cellperm(1,1) = kh;
+                        cellperm(2,2) = std::max(spec.kvkh*kh, minpermSI);
+                        upscaler.setPermeability(i, cellperm);
+                    }
+                    upscaler.upscaleSinglePhase();
+                }
+                catch (...) {
+#pragma omp critical (benchmark_error)
+                    {
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                        failed = true;
+                    }
+                }
+            }
+        }
+        throwOnAnyRank(error);
+        const double elapsed = maxOverRanks(Opm::wallClockTime() - points_start);
+        BenchmarkRow init = { "relperm_init", "fixed", threads[t], threads[t], maxOverRanks(init_time) };
+        BenchmarkRow pts = { "relperm_points", "fixed", threads[t], points, elapsed };
+        rows.push_back(init);
+        rows.push_back(pts);
+    }
+
+    // Time spent inside the pressure solver, summed over threads and ranks.
+    Opm::PerformanceLog& log = Opm::PerformanceLog::global();
+    log.gatherRanks();
+    const char* solver_entries[4] = { "flow_solver/assembly", "flow_solver/preconditioner_setup",
+                                      "flow_solver/linear_solve", "flow_solver/linear_iterations" };
+    for (int e = 0; e < 4; ++e) {
+        const Opm::PerformanceLog::Entry entry = log.entry(solver_entries[e]);
+        BenchmarkRow row = { solver_entries[e], "all", 0, entry.samples, entry.total };
+        rows.push_back(row);
+    }
+
+    if (mpi_rank != 0) {
+        return 0;
+    }
+
+    std::ostringstream outputtmp;
+    outputtmp.precision(6);
+    outputtmp << "# upscale_synthetic_benchmark results, format version 1\n"
+              << "# 'seconds' is wall-clock time, except for flow_solver/linear_iterations,\n"
+              << "# where it is the total number of iterations. threads is 0 for\n"
+              << "# totals over all runs.\n"
+              << "kernel,variant,heterogeneity,nx,ny,nz,fault_throw,cells,ranks,threads,samples,seconds,seconds_per_sample\n";
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        const BenchmarkRow& row = rows[r];
+        outputtmp << row.kernel << ',' << row.variant << ',' << spec.heterogeneity << ','
+                  << spec.nx << ',' << spec.ny << ',' << spec.nz << ',' << spec.fault_throw << ','
+                  << perm.size() << ',' << mpi_size << ',' << row.threads << ','
+                  << row.samples << ',' << row.seconds << ','
+                  << (row.samples > 0 ? row.seconds/row.samples : 0.0) << '\n';
+    }
+
+    std::cout << outputtmp.str();
+    if (output != "") {
+        std::ofstream outfile(output.c_str());
+        if (!outfile) {
+            std::cerr << "Could not open file " << output << "\n";
+            throw std::runtime_error("Could not open output file.");
+        }
+        outfile << outputtmp.str();
+    }
+    return 0;
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
@@ -56,6 +56,46 @@ macro (add_test_upscale_perm gridname bcs rows)
                          ${INPUT_DATA_PATH}/grids/${gridname}.grdecl)
 endmacro (add_test_upscale_perm)
 
+###########################################################################
+# TEST: upscale_singlephase
+###########################################################################
+
+# Define macro that runs upscale_singlephase with fixed boundary conditions
+# on the given number of processes, distributing the pressure solves when
+# there is more than one, and compares with the sequential reference.
+# Input:
+#   - gridname: basename (no extension) of grid model
+#   - procs: Number of MPI processes
+# This macro assumes that ${gridname}.grdecl is found in directory ${INPUT_DATA_PATH}grids/
+# and that upscale_singlephase_BCf_${gridname}.txt is found in ${INPUT_DATA_PATH}reference_solutions
+macro (add_test_upscale_singlephase gridname procs)
+  set(RESULT_NAME upscale_singlephase_BCf_${gridname})
+  set(TEST_NAME ${RESULT_NAME}_np${procs})
+  set(RESULT_PATH ${BASE_RESULT_PATH}/${TEST_NAME})
+  if(${procs} GREATER 1)
+    set(distributed true)
+  else()
+    set(distributed false)
+  endif()
+  opm_add_test(${TEST_NAME} NO_COMPILE
+               EXE_NAME upscale_singlephase
+               PROCESSORS ${procs}
+               DRIVER_ARGS ${INPUT_DATA_PATH} ${RESULT_PATH}
+                           ${CMAKE_BINARY_DIR}/bin
+                           ${RESULT_NAME}
+                           ${abstol} ${reltol}
+               TEST_ARGS fileformat=eclipse
+                         filename=${INPUT_DATA_PATH}/grids/${gridname}.grdecl
+                         boundary_condition_type=0
+                         perm_threshold_md=1e-9
+                         distributed_solve=${distributed}
+                         output=${RESULT_PATH}/${RESULT_NAME}.txt)
+  if(${procs} GREATER 1)
+    set_tests_properties(${TEST_NAME} PROPERTIES ENVIRONMENT
+                         "TEST_LAUNCHER=${MPI_LAUNCHER} ${MPIEXEC_NUMPROC_FLAG} ${procs}")
+  endif()
+endmacro (add_test_upscale_singlephase)
+
 ###########################################################################
 # TEST: upscale_relperm 
 ###########################################################################
@@ -112,6 +152,32 @@ macro (add_test_upscale_elasticity gridname method)
                          method=${method})
 endmacro (add_test_upscale_elasticity gridname method rows)
 
+# Define macro that runs upscale_elasticity with MPC couplings on the given
+# number of processes, which distribute the operator and the linear solves,
+# and compares with the sequential reference.
+# Input:
+#   - gridname: basename (no extension) of grid model
+#   - procs: Number of MPI processes
+# This macro assumes that ${gridname}.grdecl is found in directory ${INPUT_DATA_PATH}grids/
+# and that upscale_elasticity_mpc_${gridname}.txt is found in ${INPUT_DATA_PATH}reference_solutions
+macro (add_test_upscale_elasticity_mpi gridname procs)
+  set(RESULT_NAME upscale_elasticity_mpc_${gridname})
+  set(TEST_NAME ${RESULT_NAME}_np${procs})
+  set(RESULT_PATH ${BASE_RESULT_PATH}/${TEST_NAME})
+  opm_add_test(${TEST_NAME} NO_COMPILE
+               EXE_NAME upscale_elasticity
+               PROCESSORS ${procs}
+               DRIVER_ARGS ${INPUT_DATA_PATH} ${RESULT_PATH}
+                           ${CMAKE_BINARY_DIR}/bin
+                           ${RESULT_NAME}
+                           ${abstol} ${reltol}
+               TEST_ARGS output=${RESULT_PATH}/${RESULT_NAME}.txt
+                         gridfilename=${INPUT_DATA_PATH}/grids/${gridname}.grdecl
+                         method=mpc)
+  set_tests_properties(${TEST_NAME} PROPERTIES ENVIRONMENT
+                       "TEST_LAUNCHER=${MPI_LAUNCHER} ${MPIEXEC_NUMPROC_FLAG} ${procs}")
+endmacro (add_test_upscale_elasticity_mpi)
+
 # Make sure that we build the helper executable before running tests
 # (the "tests" target is setup in OpmLibMain.cmake)
 if(NOT TARGET test-suite)
@@ -128,6 +194,21 @@ add_test_upscale_perm(27cellsIso flp 9)
 add_test_upscale_perm(EightCells fl 6)
 add_test_upscale_perm(Hummocky flp 9)
 
+# The distributed solves are checked against the sequential result
+add_dependencies (test-suite upscale_singlephase)
+add_test_upscale_singlephase(Hummocky 1)
+if(MPI_FOUND)
+  if(MPIEXEC_EXECUTABLE)
+    set(MPI_LAUNCHER ${MPIEXEC_EXECUTABLE})
+  else()
+    set(MPI_LAUNCHER ${MPIEXEC})
+  endif()
+  if(MPI_LAUNCHER)
+    add_test_upscale_singlephase(Hummocky 2)
+    add_test_upscale_singlephase(Hummocky 4)
+  endif()
+endif()
+
 # Add tests for different models
 add_test_upscale_relperm(BCf_pts20_surfTens11_stonefile_benchmark_stonefile_benchmark_benchmark_tiny_grid
                          benchmark_tiny_grid stonefile_benchmark.txt 20 8
@@ -158,4 +239,7 @@ if((DUNE_ISTL_VERSION_MAJOR GREATER 2) OR
   add_dependencies (test-suite upscale_elasticity)
   add_test_upscale_elasticity(EightCells mpc)
   add_test_upscale_elasticity(EightCells mortar)
+  if(MPI_FOUND AND MPI_LAUNCHER)
+    add_test_upscale_elasticity_mpi(EightCells 2)
+  endif()
 endif()
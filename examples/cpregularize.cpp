@@ -31,6 +31,9 @@
      
    - Be careful with non-flat top and bottom boundary.
 
+   The coarse blocks are dealt round-robin to the MPI ranks, and each
+   rank upscales its blocks in parallel when OpenMP is available.
+
 */
 
 #include <config.h>
@@ -66,6 +69,8 @@
 #include <ios>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 
 #include <sys/utsname.h>
 
@@ -80,7 +85,9 @@ try
         exit(1);
     }
 
-    Dune::MPIHelper::instance(argc, argv);
+    Dune::MPIHelper& mpi = Dune::MPIHelper::instance(argc, argv);
+    const int mpi_rank = mpi.rank();
+    const int mpi_size = mpi.size();
   
     Opm::parameter::ParameterGroup param(argc, argv);
     std::string gridfilename = param.get<std::string>("gridfilename");
@@ -124,12 +131,6 @@ try
 			      jmin, 0, jmax,
 			      zmin, 0, zmax);
 
-    
-    // Storage for properties for regularized cells
-    std::vector<double> poro;
-    std::vector<double> permx;
-    std::vector<double> permy;
-    std::vector<double> permz;
 
 
     Opm::ParseContext parseMode;
@@ -174,39 +175,102 @@ try
     
 
 
+    // Storage for properties for regularized cells, in output order
+    // (i running fastest). Blocks that fail to upscale are left at zero.
+    // The values are kept until all blocks are done, since each keyword
+    // is written in full before the next one.
+    const int numblocks = ires*jres*zres;
+    std::vector<double> poro(numblocks, 0.0);
+    std::vector<double> permx(numblocks, 0.0);
+    std::vector<double> permy(numblocks, 0.0);
+    std::vector<double> permz(numblocks, 0.0);
+
     // Run through the new regular grid to find its properties
-    for (int zidx_c=0; zidx_c < zres; ++zidx_c) {
-        for (int jidx_c=0; jidx_c < jres; ++jidx_c) {
-            for (int iidx_c=0; iidx_c < ires; ++iidx_c) {
+    std::string errormessage;
+#pragma omp parallel for schedule(dynamic)
+    for (int block = 0; block < numblocks; ++block) {
+        // blocks are distributed round-robin over the processes
+        if (block % mpi_size != mpi_rank) {
+            continue;
+        }
+        const int iidx_c = block % ires;
+        const int jidx_c = (block / ires) % jres;
+        const int zidx_c = block / (ires*jres);
+
+        // The chopper holds the current block, so chopping is serialized.
+        Opm::Deck subdeck;
+        bool chopped = false;
+#pragma omp critical (cpregularize_chop)
+        {
+            try {
                 ch.chop(iidx_f[iidx_c], iidx_f[iidx_c+1],
                         jidx_f[jidx_c], jidx_f[jidx_c+1],
                         zcorn_c[zidx_c], zcorn_c[zidx_c+1],
                         false);
+                subdeck = ch.subDeck();
+                chopped = true;
+            }
+            catch (const std::exception& e) {
+                if (errormessage.empty()) {
+                    errormessage = e.what();
+                }
+            }
+        }
+        if (!chopped) {
+            continue;
+        }
 
-                OPM_THROW(std::logic_error, "Sub-decks not are not implemented by opm-parser. Refactor the calling code!?");
-		try {
-		    auto subdeck = ch.subDeck();
-		    Opm::SinglePhaseUpscaler upscaler;
-		    upscaler.init(subdeck, Opm::SinglePhaseUpscaler::Fixed, minpermSI,
-				  residual_tolerance, linsolver_verbosity, linsolver_type, false);
-            
-		    Opm::SinglePhaseUpscaler::permtensor_t upscaled_K = upscaler.upscaleSinglePhase();
-		    upscaled_K *= (1.0/(Opm::prefix::milli*Opm::unit::darcy));
-		    poro.push_back(upscaler.upscalePorosity());
-		    permx.push_back(upscaled_K(0,0));
-		    permy.push_back(upscaled_K(1,1));
-		    permz.push_back(upscaled_K(2,2)); 
-		}
-		catch (...) {
-		    std::cout << "Warning: Upscaling for cell failed to convert, values set to zero\n";
-		    poro.push_back(0.0);
-		    permx.push_back(0.0);
-		    permy.push_back(0.0);
-		    permz.push_back(0.0);
-		}
-	    }
+        try {
+            Opm::SinglePhaseUpscaler upscaler;
+            upscaler.init(subdeck, Opm::SinglePhaseUpscaler::Fixed, minpermSI,
+                          residual_tolerance, linsolver_verbosity, linsolver_type, false);
+
+            Opm::SinglePhaseUpscaler::permtensor_t upscaled_K = upscaler.upscaleSinglePhase();
+            upscaled_K *= (1.0/(Opm::prefix::milli*Opm::unit::darcy));
+            poro[block] = upscaler.upscalePorosity();
+            permx[block] = upscaled_K(0,0);
+            permy[block] = upscaled_K(1,1);
+            permz[block] = upscaled_K(2,2);
+        }
+        catch (...) {
+            std::cout << "Warning: Upscaling for cell failed to convert, values set to zero\n";
+        }
+    }
+
+#if defined(HAVE_MPI) && HAVE_MPI
+    if (mpi_size > 1) {
+        // all processes must stop together, or the others would wait
+        // for the failed one in the reductions below
+        int failed = !errormessage.empty();
+        MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+        if (failed && errormessage.empty()) {
+            errormessage = "Chopping failed on another process.";
+        }
+    }
+#endif
+    if (!errormessage.empty()) {
+        throw std::runtime_error(errormessage);
+    }
+
+#if defined(HAVE_MPI) && HAVE_MPI
+    if (mpi_size > 1) {
+        // each block was computed by one process only
+        std::vector<double>* fields[4] = { &poro, &permx, &permy, &permz };
+        for (int f = 0; f < 4; ++f) {
+            std::vector<double>& field = *fields[f];
+            if (mpi_rank == 0) {
+                MPI_Reduce(MPI_IN_PLACE, &field[0], numblocks, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+            }
+            else {
+                MPI_Reduce(&field[0], 0, numblocks, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+            }
         }
     }
+#endif
+    if (mpi_rank != 0) {
+        return 0;
+    }
+
     // Write regularized grid to outputfile
     std::ofstream out(resultgrid.c_str());
     if (!out) {
@@ -261,25 +325,25 @@ try
     
     out << "PORO\n";
     for (size_t idx=0; idx < (size_t)poro.size(); ++idx) {
-	out << poro[idx] << std::endl;
+	out << poro[idx] << '\n';
     }
     out << "/\n\n";
     
     out << "PERMX\n";
     for (size_t idx=0; idx < (size_t)permx.size(); ++idx) {
-	out << permx[idx] << std::endl;
+	out << permx[idx] << '\n';
     }
     out << "/\n\n";
     
     out << "PERMY\n\n";
     for (size_t idx=0; idx < (size_t)permy.size(); ++idx) {
-	out << permy[idx] << std::endl;
+	out << permy[idx] << '\n';
     }
     out << "/\n\n";
     
     out << "PERMZ\n\n";
     for (size_t idx=0; idx < (size_t)permz.size(); ++idx) {
-	out << permz[idx] << std::endl;
+	out << permz[idx] << '\n';
     }
     out << "/\n";
     
@@ -27,6 +27,11 @@
   difference in their properties (poro or perm)
 
   Direction for pairing is set from the command line
+
+  Each distinct window is chopped and upscaled only once, and the
+  windows are upscaled in parallel when OpenMP is available. With
+  exhaustive=true, all pairs of windows on a lattice with spacing
+  istep, jstep and zstep are used instead of random pairs.
 */
 
 #include <config.h>
@@ -56,7 +61,11 @@
 #include <iomanip>
 #include <ios>
 #include <iostream>
+#include <map>
 #include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <sys/utsname.h>
 
@@ -65,6 +74,41 @@
 #include <boost/random/uniform_real.hpp>
 #include <boost/random/variate_generator.hpp>
 
+namespace
+{
+    // Start corner of a chopped window. The window extent is the same
+    // for all windows, so the start identifies the window.
+    struct Window
+    {
+        int i;
+        int j;
+        double z;
+        bool operator<(const Window& other) const
+        {
+            if (i != other.i) return i < other.i;
+            if (j != other.j) return j < other.j;
+            return z < other.z;
+        }
+    };
+
+    struct WindowResult
+    {
+        double porosity;
+        double perm[3];
+    };
+
+    // Start positions min, min + step, ... not exceeding max.
+    template <typename T>
+    std::vector<T> latticeStarts(T min, T max, T step)
+    {
+        std::vector<T> starts;
+        for (int k = 0; min + k*step <= max + 1e-9*step; ++k) {
+            starts.push_back(min + k*step);
+        }
+        return starts;
+    }
+}
+
 int main(int argc, char** argv)
 try
 {
@@ -88,6 +132,11 @@ try
     int ilen = param.getDefault("ilen", 0);
     int jlen = param.getDefault("jlen", 0);
     double zlen = param.getDefault("zlen", 0.0);
+    bool exhaustive = param.getDefault("exhaustive", false);
+    int istep = param.getDefault("istep", ilen);
+    int jstep = param.getDefault("jstep", jlen);
+    // In random mode, zstep = 0 means that z starts are not snapped to a lattice.
+    double zstep = param.getDefault("zstep", exhaustive ? zlen : 0.0);
     boost::mt19937::result_type userseed = param.getDefault("seed", 0);
 
     int outputprecision = param.getDefault("outputprecision", 8);
@@ -121,6 +170,14 @@ try
         std::cerr << "Eror: zlen (" << zlen <<") must be greater than zero\n";
         exit(1);
     }
+    if (exhaustive && (istep <= 0 || jstep <= 0 || zstep <= 0.0)) {
+        std::cerr << "Error: istep, jstep and zstep must be greater than zero in exhaustive mode\n";
+        exit(1);
+    }
+    if (zstep < 0.0) {
+        std::cerr << "Error: zstep (" << zstep << ") must not be negative\n";
+        exit(1);
+    }
 
     // Check user supplied variogram direction, either horizontal or vertical 
     enum variogram_directions { undefined, horizontal, vertical };
@@ -149,81 +206,165 @@ try
                               jmin, jlen, jmax,
                               zmin, zlen, zmax);
     
-    // Random number generator from boost.
-    boost::mt19937 gen;
-    
-    // Seed the random number generators with the current time, unless specified on command line
-    // Warning: Current code does not allow 0 for the seed!!
-    if (userseed == 0) {
-        gen.seed(time(NULL));
+    const double zstartmax = std::max(zmax - zlen, zmin);
+
+    // Form the list of window pairs to compare.
+    std::vector<std::pair<Window, Window> > windowpairs;
+    if (exhaustive) {
+        const std::vector<int> istarts = latticeStarts(imin, imax - ilen, istep);
+        const std::vector<int> jstarts = latticeStarts(jmin, jmax - jlen, jstep);
+        const std::vector<double> zstarts = latticeStarts(zmin, zstartmax, zstep);
+        if (variogram_direction == horizontal) {
+            for (std::size_t kz = 0; kz < zstarts.size(); ++kz) {
+                std::vector<Window> layer;
+                for (std::size_t ki = 0; ki < istarts.size(); ++ki) {
+                    for (std::size_t kj = 0; kj < jstarts.size(); ++kj) {
+                        Window w = { istarts[ki], jstarts[kj], zstarts[kz] };
+                        layer.push_back(w);
+                    }
+                }
+                for (std::size_t a = 0; a < layer.size(); ++a) {
+                    for (std::size_t b = a + 1; b < layer.size(); ++b) {
+                        windowpairs.push_back(std::make_pair(layer[a], layer[b]));
+                    }
+                }
+            }
+        }
+        else if (variogram_direction == vertical) {
+            for (std::size_t ki = 0; ki < istarts.size(); ++ki) {
+                for (std::size_t kj = 0; kj < jstarts.size(); ++kj) {
+                    for (std::size_t a = 0; a < zstarts.size(); ++a) {
+                        for (std::size_t b = a + 1; b < zstarts.size(); ++b) {
+                            Window w1 = { istarts[ki], jstarts[kj], zstarts[a] };
+                            Window w2 = { istarts[ki], jstarts[kj], zstarts[b] };
+                            windowpairs.push_back(std::make_pair(w1, w2));
+                        }
+                    }
+                }
+            }
+        }
+        pairs = windowpairs.size();
     }
     else {
-        gen.seed(userseed);
+        // Random number generator from boost.
+        boost::mt19937 gen;
+
+        // Seed the random number generators with the current time, unless specified on command line
+        // Warning: Current code does not allow 0 for the seed!!
+        if (userseed == 0) {
+            gen.seed(time(NULL));
+        }
+        else {
+            gen.seed(userseed);
+        }
+
+        // Note that end is included in interval for uniform_int.
+        boost::uniform_int<> disti(imin, imax - ilen);
+        boost::uniform_int<> distj(jmin, jmax - jlen);
+        boost::uniform_real<> distz(zmin, zstartmax);
+        boost::variate_generator<boost::mt19937&, boost::uniform_int<> > ri(gen, disti);
+        boost::variate_generator<boost::mt19937&, boost::uniform_int<> > rj(gen, distj);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<> > rz(gen, distz);
+
+        // Snap z starts to the lattice if requested, so that windows may be reused.
+        auto zstart = [&]() {
+            double z = rz();
+            if (zstep > 0.0) {
+                z = std::min(zmin + std::floor((z - zmin)/zstep + 0.5)*zstep, zstartmax);
+            }
+            return z;
+        };
+
+        for (int pair = 1; pair <= pairs; ++pair) {
+            Window w1;
+            w1.i = ri();
+            w1.j = rj();
+            w1.z = zstart();
+
+            // Pick another location to form a location-pair to be compared
+            Window w2 = w1;
+            if (variogram_direction == horizontal) {
+                w2.i = ri();
+                w2.j = rj();
+            }
+            else if (variogram_direction == vertical) {
+                w2.z = zstart();
+            }
+            windowpairs.push_back(std::make_pair(w1, w2));
+        }
+    }
+
+    // Each distinct window is upscaled once.
+    std::map<Window, int> windowindex;
+    std::vector<Window> windows;
+    for (std::size_t pair = 0; pair < windowpairs.size(); ++pair) {
+        const Window* w[2] = { &windowpairs[pair].first, &windowpairs[pair].second };
+        for (int k = 0; k < 2; ++k) {
+            if (windowindex.insert(std::make_pair(*w[k], int(windows.size()))).second) {
+                windows.push_back(*w[k]);
+            }
+        }
+    }
+
+    const int numwindows = windows.size();
+    std::vector<WindowResult> results(numwindows);
+    std::string errormessage;
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < numwindows; ++k) {
+        try {
+            const Window& w = windows[k];
+            // The chopper holds the current window, so chopping is serialized.
+            Opm::Deck subdeck;
+#pragma omp critical (exp_variogram_chop)
+            {
+                ch.chop(w.i, w.i + ilen, w.j, w.j + jlen, w.z, w.z + zlen, false);
+                subdeck = ch.subDeck();
+            }
+            Opm::SinglePhaseUpscaler upscaler;
+            upscaler.init(subdeck, Opm::SinglePhaseUpscaler::Fixed, minpermSI,
+                          residual_tolerance, linsolver_verbosity, linsolver_type, false);
+            Opm::SinglePhaseUpscaler::permtensor_t upscaled_K = upscaler.upscaleSinglePhase();
+            upscaled_K *= (1.0/(Opm::prefix::milli*Opm::unit::darcy));
+            results[k].porosity = upscaler.upscalePorosity();
+            for (int d = 0; d < 3; ++d) {
+                results[k].perm[d] = upscaled_K(d,d);
+            }
+        }
+        catch (const std::exception& e) {
+#pragma omp critical (exp_variogram_error)
+            {
+                if (errormessage.empty()) {
+                    errormessage = e.what();
+                }
+            }
+        }
+    }
+    if (!errormessage.empty()) {
+        throw std::runtime_error(errormessage);
     }
-        
 
-    // Note that end is included in interval for uniform_int.
-    boost::uniform_int<> disti(imin, imax - ilen);
-    boost::uniform_int<> distj(jmin, jmax - jlen);
-    boost::uniform_real<> distz(zmin, std::max(zmax - zlen, zmin));
-    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > ri(gen, disti);
-    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > rj(gen, distj);
-    boost::variate_generator<boost::mt19937&, boost::uniform_real<> > rz(gen, distz);
-    
     // Storage for results
     std::vector<double> distances;
     std::vector<double> porodiffs;
     std::vector<double> permxdiffs;
     std::vector<double> permydiffs;
     std::vector<double> permzdiffs;
-    
-    for (int pair = 1; pair <= pairs; ++pair) {
-        int istart_1 = ri();
-        int jstart_1 = rj();
-        double zstart_1 = rz();
-        ch.chop(istart_1, istart_1 + ilen, jstart_1, jstart_1 + jlen, zstart_1, zstart_1 + zlen, false);
-
-        auto subdeck_1 = ch.subDeck();
-        Opm::SinglePhaseUpscaler upscaler_1;
-        upscaler_1.init(subdeck_1, Opm::SinglePhaseUpscaler::Fixed, minpermSI,
-			residual_tolerance, linsolver_verbosity, linsolver_type, false);
-        Opm::SinglePhaseUpscaler::permtensor_t upscaled_K_1 = upscaler_1.upscaleSinglePhase();
-        upscaled_K_1 *= (1.0/(Opm::prefix::milli*Opm::unit::darcy));
-	double porosity_1 = upscaler_1.upscalePorosity();
-
-        // Pick another location to form a location-pair to be compared
-        int istart_2 = 0, jstart_2 = 0;
-        double zstart_2 = 0;
-        if (variogram_direction == horizontal) {
-            istart_2 = ri();
-            jstart_2 = rj();
-            zstart_2 = zstart_1;
-        }
-        else if (variogram_direction == vertical) {
-            istart_2 = istart_1;
-            jstart_2 = jstart_1;
-            zstart_2 = rz();
-        }   
-        ch.chop(istart_2, istart_2 + ilen, jstart_2, jstart_2 + jlen, zstart_2, zstart_2 + zlen, false);
-	
-        auto subdeck_2 = ch.subDeck();
-        Opm::SinglePhaseUpscaler upscaler_2;
-        upscaler_2.init(subdeck_2, Opm::SinglePhaseUpscaler::Fixed, minpermSI,
-			residual_tolerance, linsolver_verbosity, linsolver_type, false);
-        Opm::SinglePhaseUpscaler::permtensor_t upscaled_K_2 = upscaler_2.upscaleSinglePhase();
-        upscaled_K_2 *= (1.0/(Opm::prefix::milli*Opm::unit::darcy));
-	double porosity_2 = upscaler_2.upscalePorosity();
 
+    for (int pair = 0; pair < pairs; ++pair) {
+        const Window& w1 = windowpairs[pair].first;
+        const Window& w2 = windowpairs[pair].second;
+        const WindowResult& r1 = results[windowindex[w1]];
+        const WindowResult& r2 = results[windowindex[w2]];
         if (variogram_direction == horizontal) {
-            distances.push_back(sqrt(pow(istart_2 - istart_1,2) + pow(jstart_2 - jstart_1,2)));
-	}
+            distances.push_back(sqrt(pow(w2.i - w1.i,2) + pow(w2.j - w1.j,2)));
+        }
         else if (variogram_direction == vertical) {
-            distances.push_back(fabs(zstart_2 - zstart_1));
+            distances.push_back(fabs(w2.z - w1.z));
         }
-        porodiffs.push_back(fabs(porosity_2 - porosity_1));
-        permxdiffs.push_back(fabs(upscaled_K_2(0,0) - upscaled_K_1(0,0)));
-	permydiffs.push_back(fabs(upscaled_K_2(1,1) - upscaled_K_1(1,1)));
-        permzdiffs.push_back(fabs(upscaled_K_2(2,2) - upscaled_K_1(2,2)));
+        porodiffs.push_back(fabs(r2.porosity - r1.porosity));
+        permxdiffs.push_back(fabs(r2.perm[0] - r1.perm[0]));
+        permydiffs.push_back(fabs(r2.perm[1] - r1.perm[1]));
+        permzdiffs.push_back(fabs(r2.perm[2] - r1.perm[2]));
     }
     
     // Make stream of output data, to be outputted to screen and optionally to file
@@ -245,6 +386,13 @@ try
     outputtmp << "#   z; min,len,max: " << zmin << " " << zlen << " " << zmax << std::endl;
     outputtmp << "#        direction: " << direction << std::endl;
     outputtmp << "#            pairs: " << pairs << std::endl;
+    if (exhaustive) {
+        outputtmp << "#  i,j,z lattice step: " << istep << " " << jstep << " " << zstep << std::endl;
+    }
+    else if (zstep > 0.0) {
+        outputtmp << "#           zstep: " << zstep << std::endl;
+    }
+    outputtmp << "# windows upscaled: " << numwindows << std::endl;
     outputtmp << "################################################################################################" << std::endl;
     outputtmp << "# distance (" << distancemetric << ")      porositydiff                permxdiff               permydiff                permzdiff" << std::endl;
     
@@ -50,7 +50,7 @@
 
 typedef Dune::CpGrid Grid;
 typedef Opm::Rock<Grid::dimension> Rock;
-typedef Opm::BlackoilFluid Fluid;
+typedef Opm::BasicBlackoilFluid<Opm::BlackoilCo2PVT> Fluid;
 typedef Opm::BlackoilWells Wells;
 typedef Opm::BasicBoundaryConditions<true, false>  FBC;
 typedef Opm::TpfaCompressible<Grid, Rock, Fluid, Wells, FBC> FlowSolver;
@@ -65,6 +65,8 @@
 #include <opm/core/utility/MonotCubicInterpolator.hpp>
 #include <opm/parser/eclipse/Units/Units.hpp>
 
+#include <opm/porsol/common/PerformanceLog.hpp>
+
 #include <opm/upscaling/RelPermUtils.hpp>
 #include <opm/upscaling/SinglePhaseUpscaler.hpp>
 
@@ -123,7 +125,10 @@ namespace {
             << "  -interpolate <integer>          -- If supplied and > 1, the output data points will be\n"
             << "                                     interpolated using monotone cubic interpolation\n"
             << "                                     on a uniform grid with the specified number of\n"
-            << "                                     points. Suggested value: 1000.\n\n"
+            << "                                     points. Suggested value: 1000.\n"
+            << "  -timingReport <string>          -- If supplied, wall-clock timings and solver counters,\n"
+            << "                                     summed over all processes, are written to this file.\n"
+            << "                                     CSV if the name ends in .csv, JSON otherwise.\n\n"
             << "  -rock<int>cemexp <float>        -- Cementation exponent can be set on a per rocktype basis\n"
             << "  -rock<int>satexp <float>        -- Saturation exponent can be set on a per rocktype basis\n\n"
             << "Jfunctions are data files with two colums of numbers. The first column is water\n"
@@ -146,7 +151,7 @@ int main(int varnum, char** vararg)
 try
 { 
    // Variables used for timing/profiling:
-   clock_t start, finish;
+   double start, finish;
    double timeused = 0, timeused_tesselation = 0;
    double timeused_upscale_wallclock = 0.0;
 
@@ -181,6 +186,7 @@ try
    options.insert(make_pair("interpolate",            "0"     )); // default is not to interpolate  
    options.insert(make_pair("minPerm",                "1e-12" )); // minimum modelled permeability (for saturation distr)
    options.insert(make_pair("minPoro",            "0.0001")); // this limit is necessary for pcmin/max computation
+   options.insert(make_pair("timingReport",           ""      )); // Write timings and counters to this file (JSON or CSV) if provided
 
    // linear solver options
    options.insert(make_pair("linsolver_tolerance", "1e-12"));  // residual tolerance for linear solver
@@ -309,11 +315,11 @@ try
    eclipsefile.close(); 
 
    if (isMaster) cout << "Parsing Eclipse file <" << ECLIPSEFILENAME << "> ... ";
-   flush(cout);   start = clock();
+   flush(cout);   start = wallClockTime();
 
    auto deck = RelPermUpscaleHelper::parseEclipseFile(ECLIPSEFILENAME);
 
-   finish = clock();   timeused = (double(finish)-double(start))/CLOCKS_PER_SEC;
+   finish = wallClockTime();   timeused = finish - start;
    if (isMaster) cout << " (" << timeused <<" secs)" << endl;
 
    // Check that we have the information we need from the eclipse file:
@@ -444,7 +450,8 @@ try
                  Opm::unit::convert::from(minPerm, Opm::prefix::milli*Opm::unit::darcy),
                  linsolver_tolerance, linsolver_verbosity, linsolver_type, twodim_hack);
 
-   finish = clock();   timeused_tesselation = (double(finish)-double(start))/CLOCKS_PER_SEC;
+   finish = wallClockTime();   timeused_tesselation = finish - start;
+   PerformanceLog::global().addTime("cond/tesselation", timeused_tesselation);
    if (isMaster) cout << " (" << timeused_tesselation <<" secs)" << endl;    
    
   
@@ -806,7 +813,7 @@ try
    }   
 #endif
 
-   clock_t start_upscale_wallclock = clock();
+   double start_upscale_wallclock = wallClockTime();
    
    double waterVolumeLF = 0.0;
    // Now loop through the vector of capillary pressure points that
@@ -822,7 +829,7 @@ try
            cout << "Upscaling resistivity for Pc = " << Ptestvalue;
            flush(cout);
            
-           start = clock();
+           start = wallClockTime();
            
            // Loop over each cell again to find saturations given this particular
            // capillary pressure:
@@ -899,7 +906,7 @@ try
           UpscaledConductivity[pointidx][voigtIdx] = ::Opm::getVoigtValue(resTensor, voigtIdx);
       }
 
-      //      finish = clock();    timeused = (double(finish)-double(start))/CLOCKS_PER_SEC;
+      //      finish = wallClockTime();    timeused = finish - start;
       //cout << " (" << timeused <<" secs)" << endl;
       //timeused_upscale_acc += timeused;
 
@@ -913,8 +920,9 @@ try
       }
       cout << endl;
    }
-   clock_t finish_upscale_wallclock = clock();
-   timeused_upscale_wallclock = (double(finish_upscale_wallclock)-double(start_upscale_wallclock))/CLOCKS_PER_SEC;
+   double finish_upscale_wallclock = wallClockTime();
+   timeused_upscale_wallclock = finish_upscale_wallclock - start_upscale_wallclock;
+   PerformanceLog::global().addTime("cond/upscaling", timeused_upscale_wallclock);
 
    //   double timeused_upscale_total = timeused_upscale_wallclock;
 
@@ -971,6 +979,13 @@ try
    double avg_upscaling_time_pr_point = timeused_upscale_wallclock / (double)points;
 #endif
 
+   if (options["timingReport"] != "") {
+       PerformanceLog::global().gatherRanks();
+       if (isMaster) {
+           PerformanceLog::global().writeReport(options["timingReport"]);
+       }
+   }
+
    /*********************************************************************************
     *  Step 8
     *
@@ -86,7 +86,11 @@ void syntax(char** argv)
             << "\t linsolver_report         - print report at end of solution phase" << std::endl
             << "\t\t affects memory usage" << std::endl
             << "\t linsolver_symmetric      - use symmetric linear solver. Defaults to true" << std::endl
-            << "\t mortar_precond           - preconditioner for mortar block. Defaults to schur-amg" << std::endl;
+            << "\t linsolver_block          - assemble and solve in 3x3 nodal blocks (not with mortar)" << std::endl
+            << "\t elem_cache_size          - max number of shared element matrices to cache. Defaults to 10000" << std::endl
+            << "\t elem_cache_tol           - cells matching within this fraction of the smallest cell diameter share element matrices. Defaults to 1e-6" << std::endl
+            << "\t mortar_precond           - preconditioner for mortar block. Defaults to schur-amg" << std::endl
+            << "\t mortar_cache             - file to load/store the mortar coupling matrix from/in" << std::endl;
 }
 
 
@@ -130,6 +134,12 @@ struct Params {
 
   //! \brief Linear solver parameters
   LinSolParams linsolver;
+  //! \brief Maximum number of cached element matrices
+  int elem_cache_size;
+  //! \brief Relative tolerance for sharing cached element matrices
+  double elem_cache_tol;
+  //! \brief Mortar coupling matrix cache file
+  std::string mortar_cache;
 
   // Debugging options
 
@@ -181,6 +191,9 @@ void parseCommandLine(int argc, char** argv, Params& p)
   p.output   = param.getDefault<std::string>("output","");
   p.verbose  = param.getDefault<bool>("verbose",false);
   p.inspect  = param.getDefault<std::string>("inspect","");
+  p.elem_cache_size = param.getDefault<int>("elem_cache_size",10000);
+  p.elem_cache_tol = param.getDefault<double>("elem_cache_tol",1.e-6);
+  p.mortar_cache = param.getDefault<std::string>("mortar_cache","");
   size_t i;
   if ((i=p.vtufile.find(".vtu")) != std::string::npos)
     p.vtufile = p.vtufile.substr(0,i);
@@ -302,6 +315,9 @@ int run(Params& p)
     }
     ElasticityUpscale<GridType, AMG> upscale(grid, p.ctol, p.Emin, p.file,
                                              p.rocklist, p.verbose);
+#if defined(HAVE_MPI) && HAVE_MPI
+    upscale.setCommunicator(MPI_COMM_WORLD);
+#endif
 
     if (p.max[0] < 0 || p.min[0] < 0) {
       std::cout << "determine side coordinates..." << std::endl;
@@ -346,6 +362,16 @@ int run(Params& p)
       }
     }
 
+    upscale.setElementCacheSize(p.elem_cache_size);
+    upscale.setElementCacheTolerance(p.elem_cache_tol);
+
+    if (p.linsolver.block) {
+      if (p.method == UPSCALE_MORTAR)
+        std::cerr << "WARNING: block assembly is not supported with mortar couplings, ignored" << std::endl;
+      else
+        upscale.setBlockAssembly(p.linsolver);
+    }
+
     if (p.method == UPSCALE_MPC) {
       std::cout << "using MPC couplings in all directions..." << std::endl;
       upscale.periodicBCs(p.min, p.max);
@@ -354,7 +380,7 @@ int run(Params& p)
     } else if (p.method == UPSCALE_MORTAR) {
       std::cout << "using Mortar couplings.." << std::endl;
       upscale.periodicBCsMortar(p.min, p.max, p.n1, p.n2,
-                                p.lambda[0], p.lambda[1]);
+                                p.lambda[0], p.lambda[1], p.mortar_cache);
     } else if (p.method == UPSCALE_NONE) {
       std::cout << "no periodicity approach applied.." << std::endl;
       upscale.fixCorners(p.min, p.max);
@@ -368,18 +394,15 @@ int run(Params& p)
     std::cout << "setting up linear solver..." << std::endl;
     upscale.setupSolvers(p.linsolver);
 
-    if (p.inspect == "load")
-      Dune::storeMatrixMarket(upscale.A.getOperator(), "A.mtx");
-
-    // the uzawa solver cannot run multithreaded
-#ifdef HAVE_OPENMP
-    if (p.linsolver.uzawa) {
-      std::cout << "WARNING: disabling multi-threaded solves due to uzawa" << std::endl;
-      omp_set_num_threads(1);
+    if (p.inspect == "load") {
+      if (upscale.A.isBlocked())
+        Dune::storeMatrixMarket(upscale.A.getBlockOperator(), "A.mtx");
+      else
+        Dune::storeMatrixMarket(upscale.A.getOperator(), "A.mtx");
     }
-#endif
 
-#pragma omp parallel for schedule(static)
+    // the distributed solves communicate, so the load cases take turns
+#pragma omp parallel for schedule(static) if(!upscale.A.isPartitioned())
     for (int i=0;i<6;++i) {
       std::cout << "processing case " << i+1 << "..." << std::endl;
       if (p.inspect == "results") {
@@ -402,7 +425,8 @@ int run(Params& p)
           Dune::storeMatrixMarket(upscale.u[i], temp);
         }
       }
-      upscale.A.expandSolution(field[i],upscale.u[i]);
+      if (!p.vtufile.empty())
+        upscale.A.expandSolution(field[i],upscale.u[i]);
 #define CLAMP(x) (fabs(x)<1.e-4?0.0:x)
       for (size_t j=0;j<field[i].size();++j) {
         double val = field[i][j];
@@ -438,7 +462,7 @@ int run(Params& p)
       std::swap(C[j][3],C[j][5]);
     std::cout << "---------" << std::endl;
     std::cout << C << std::endl;
-    if (!p.output.empty())
+    if (!p.output.empty() && Dune::MPIHelper::getCollectiveCommunication().rank() == 0)
       writeOutput(p, watch, grid.size(0), upscale.volumeFractions,
                   upscale.bySat, C, upscale.upscaledRho, speeds);
 
@@ -480,14 +504,29 @@ try
 
     Dune::MPIHelper& mpi=Dune::MPIHelper::instance(argc, argv);
     const int size = mpi.size();
-    if (size != 1) {
-      std::cerr << "This program does not support MPI parallelization" << std::endl;
-      return 2;
-    }
 
     Params p;
     parseCommandLine(argc,argv,p);
 
+    if (size > 1) {
+      // the operator is distributed, the grid and the couplings are not
+      if (p.method == UPSCALE_MORTAR || p.linsolver.type != ITERATIVE ||
+          (!p.inspect.empty() && p.inspect != "mesh")) {
+        if (mpi.rank() == 0)
+          std::cerr << "MPI runs require method=mpc or method=none, an iterative "
+                    << "linear solver and no load or result inspection" << std::endl;
+        return 2;
+      }
+      if (mpi.rank() == 0 && p.linsolver.block)
+        std::cerr << "WARNING: block assembly is not supported in MPI runs, ignored" << std::endl;
+      if (mpi.rank() == 0 && !p.vtufile.empty())
+        std::cerr << "WARNING: vtu output is not supported in MPI runs, ignored" << std::endl;
+      p.linsolver.block = false;
+      p.vtufile.clear();
+      if (mpi.rank() != 0)
+        std::cout.setstate(std::ios_base::failbit);
+    }
+
     if (p.linsolver.pre == FASTAMG)
       return run<Dune::CpGrid, FastAMG>(p);
     else if (p.linsolver.pre == SCHWARZ)
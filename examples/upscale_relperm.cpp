@@ -72,6 +72,8 @@
 
 #include <opm/parser/eclipse/Units/Units.hpp>
 
+#include <opm/porsol/common/PerformanceLog.hpp>
+
 #include <opm/upscaling/RelPermUtils.hpp>
 #include <opm/upscaling/SinglePhaseUpscaler.hpp>
 
@@ -152,6 +154,17 @@ static void usage()
         "                                  saturation points, i.e. that krw(swcrit)=0 and krow(swmax) = 0 and similar for oil/gas." << endl <<
         "  -critRelpermThresh <float>   -- If minimum relperm values are less than this threshold, they are set to zero" << endl <<
         "                                  and will pass the EclipseCheck. Default 10^-6" << endl <<
+        "  -linsolver_single_precision <bool> -- Default false. Build the AMG preconditioner" << endl <<
+        "                                  in single precision, which halves its memory" << endl <<
+        "                                  traffic. Falls back to double precision if the" << endl <<
+        "                                  pressure solve does not converge." << endl <<
+        "  -threads <integer>           -- Default 1. Number of threads per process computing" << endl <<
+        "                                  pressure points. The threads of a process share one" << endl <<
+        "                                  grid, so running fewer processes with more threads" << endl <<
+        "                                  each uses less memory. Needs OpenMP." << endl <<
+        "  -timingReport <string>       -- If supplied, wall-clock timings and solver counters," << endl <<
+        "                                  summed over all processes, are written to this file." << endl <<
+        "                                  CSV if the name ends in .csv, JSON otherwise." << endl <<
         "If only one stone-file is supplied, it is used for all stone-types defined" << endl <<
         "in the geometry. If more than one, it corresponds to the SATNUM-values." << endl;
     // "minPoro" intentionally left undocumented
@@ -293,12 +306,15 @@ namespace {
             {"linsolver_type",                "3"}, // Type of linear solver: 0 = ILU0/CG, 1 = AMG/CG, 2 KAMG/CG, 3 FAST_AMG/CG
             {"linsolver_prolongate_factor", "1.0"}, // Prolongation factor in AMG
             {"linsolver_smooth_steps",        "1"}, // Number of smoothing steps in AMG
+            {"linsolver_single_precision", "false"}, // Build the AMG hierarchy in single precision
+            {"threads",                       "1"}, // Threads per process computing pressure points, sharing one grid
             {"fluids",                       "ow"}, // Whether upscaling for oil/water (ow) or gas/oil (go)
             {"krowxswirr",                   "-1"}, // Relative permeability in x direction of oil in corresponding oil/water system
             {"krowyswirr",                   "-1"}, // Relative permeability in y direction of oil in corresponding oil/water system
             {"krowzswirr",                   "-1"}, // Relative permeability in z direction of oil in corresponding oil/water system
             {"doEclipseCheck",             "true"}, // Check if minimum relpermvalues in input are zero (specify critical saturations)
             {"critRelpermThresh",          "1e-6"}, // Threshold for setting minimum relperm to 0 (thus specify critical saturations)
+            {"timingReport",                   ""}, // If this is set, timings and counters are written to this file (JSON or CSV).
         };
     }
 
@@ -449,7 +465,7 @@ int main(int varnum, char** vararg)
 try
 {
    // Variables used for timing/profiling:
-   clock_t start, finish;
+   double start;
    double timeused = 0.0, timeused_tesselation = 0.0;
    double timeused_upscale_wallclock = 0.0;
 
@@ -531,12 +547,12 @@ try
    // populate our vectors with data from the file
 
    // Test if filename exists and is readable
-   start = clock();
+   start = wallClockTime();
 
    auto deck = RelPermUpscaleHelper::parseEclipseFile(ECLIPSEFILENAME);
 
-   finish   = clock();
-   timeused = (double(finish) - double(start)) / CLOCKS_PER_SEC;
+   timeused = wallClockTime() - start;
+   PerformanceLog::global().addTime("relperm/parse_deck", timeused);
    if (helper.isMaster) {
        cout << " (" << timeused << " secs)" << endl;
    }
@@ -706,6 +722,13 @@ try
              avg_upscaling_time_pr_point) =
         helper.upscalePermeability(mpi_rank);
 
+    if (options["timingReport"] != "") {
+        PerformanceLog::global().gatherRanks();
+        if (helper.isMaster) {
+            PerformanceLog::global().writeReport(options["timingReport"]);
+        }
+    }
+
    /*
     * Step 8c: Make relperm values from phaseperms
     *          (only master node can do this)
@@ -81,6 +81,8 @@
 
 #include <opm/core/utility/MonotCubicInterpolator.hpp>
 
+#include <opm/porsol/common/PerformanceLog.hpp>
+
 #include <opm/upscaling/RelPermUtils.hpp>
 #include <opm/upscaling/SinglePhaseUpscaler.hpp>
 
@@ -137,6 +139,9 @@ void usage()
         "-minPerm <float>             -- Minimum floating point value allowed for" << endl <<
         "                                phase permeability in computations. If set to zero," << endl <<
         "                                some models can end up singular. Default 1e-12" << endl <<
+        "-timingReport <string>       -- If supplied, wall-clock timings and solver counters," << endl <<
+        "                                summed over all processes, are written to this file." << endl <<
+        "                                CSV if the name ends in .csv, JSON otherwise." << endl <<
         "If only one stone-file (only relperm-values are used) is supplied, it" << endl <<
         "is used for all stone-types defined in the geometry. If more than one," << endl <<
         "it corresponds to the SATNUM-values." << endl;
@@ -160,7 +165,7 @@ int main(int varnum, char** vararg)
 try
 { 
     // Variables used for timing/profiling:
-    clock_t start, finish;
+    double start, finish;
     double timeused = 0, timeused_tesselation = 0; //, timeused_upscale_acc_water = 0, timeused_upscale_acc_oil = 0; 
     double timeused_upscale_wallclock = 0.0;
     
@@ -204,7 +209,8 @@ try
         {"linsolver_verbosity",           "0"}, // verbosity level for linear solver
         {"linsolver_type",                "3"}, // type of linear solver: 0 = ILU/BiCGStab, 1 = AMG/CG, 2 = KAMG/CG, 3 = FastAMG/CG
         {"linsolver_prolongate_factor", "1.0"}, // Factor to scale the prolongate coarse grid correction,
-        {"linsolver_smooth_steps",        "1"}}; // Number of pre and postsmoothing steps for AMG
+        {"linsolver_smooth_steps",        "1"}, // Number of pre and postsmoothing steps for AMG
+        {"timingReport",                   ""}}; // If set, where to write timings and counters (JSON or CSV)
 
     /* Check first if there is anything on the command line to look for */
     if (varnum == 1) {
@@ -344,11 +350,11 @@ try
     eclipsefile.close(); 
  
     if (isMaster) cout << "Parsing Eclipse file <" << ECLIPSEFILENAME << "> ... ";
-    flush(cout);   start = clock();
+    flush(cout);   start = wallClockTime();
  
     auto deck = RelPermUpscaleHelper::parseEclipseFile(ECLIPSEFILENAME);
 
-    finish = clock();   timeused = (double(finish)-double(start))/CLOCKS_PER_SEC;
+    finish = wallClockTime();   timeused = finish - start;
     if (isMaster) cout << " (" << timeused <<" secs)" << endl;
   
     // Check that we have the information we need from the eclipse file: 
@@ -790,7 +796,7 @@ try
      * cells are connected to which. Each cornerpoint-cell is tesselated into 8 tetrahedrons.
      */
     if (isMaster) cout << "Tesselating grid... ";
-    flush(cout);   start = clock();
+    flush(cout);   start = wallClockTime();
     SinglePhaseUpscaler upscaler;
     double linsolver_tolerance = atof(options["linsolver_tolerance"].c_str());
     int linsolver_verbosity = atoi(options["linsolver_verbosity"].c_str());
@@ -800,7 +806,8 @@ try
                   Opm::unit::convert::from(minPerm, Opm::prefix::milli*Opm::unit::darcy),
                   linsolver_tolerance, linsolver_verbosity, linsolver_type, twodim_hack);
  
-    finish = clock();   timeused_tesselation = (double(finish)-double(start))/CLOCKS_PER_SEC;
+    finish = wallClockTime();   timeused_tesselation = finish - start;
+    PerformanceLog::global().addTime("relpermvisc/tesselation", timeused_tesselation);
     if (isMaster) cout << " (" << timeused_tesselation <<" secs)" << endl;
  
     /******************************************************************************
@@ -1200,7 +1207,7 @@ try
     }   
 #endif
 
-    clock_t start_upscale_wallclock = clock();
+    double start_upscale_wallclock = wallClockTime();
 
     double waterVolumeLF; // water volume for the whole model
     // Now loop through the vector of fractional flow ratios that
@@ -1347,8 +1354,9 @@ try
             }
         }  // end loop over saturation points
     } // end phase loop
-    clock_t finish_upscale_wallclock = clock();
-    timeused_upscale_wallclock = (double(finish_upscale_wallclock)-double(start_upscale_wallclock))/CLOCKS_PER_SEC;
+    double finish_upscale_wallclock = wallClockTime();
+    timeused_upscale_wallclock = finish_upscale_wallclock - start_upscale_wallclock;
+    PerformanceLog::global().addTime("relpermvisc/upscaling", timeused_upscale_wallclock);
     //double timeused_upscale_total = timeused_upscale_wallclock;
 #ifdef HAVE_MPI
     /* Step Xb: Transfer all computed data to master node.
@@ -1404,6 +1412,13 @@ try
     double avg_upscaling_time_pr_point = timeused_upscale_wallclock / (2.0*(double)points);
 #endif
 
+    if (options["timingReport"] != "") {
+        PerformanceLog::global().gatherRanks();
+        if (isMaster) {
+            PerformanceLog::global().writeReport(options["timingReport"]);
+        }
+    }
+
     /* 
      * Step Xc: Make relperm values from phaseperms
      *          (only master node can do this)
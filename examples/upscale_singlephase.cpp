@@ -38,7 +38,10 @@
 
 #include <opm/upscaling/SinglePhaseUpscaler.hpp>
 
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <string>
 
 using namespace Opm;
 using namespace Opm::prefix;
@@ -47,12 +50,14 @@ using namespace Opm::unit;
 int main(int argc, char** argv)
 try
 {
-    Dune::MPIHelper::instance(argc, argv);
+    Dune::MPIHelper& mpi = Dune::MPIHelper::instance(argc, argv);
 
     SinglePhaseUpscaler upscaler;
+    std::string output;
     {
         auto param = Opm::parameter::ParameterGroup(argc, argv);
 
+        output = param.getDefault<std::string>("output", "");
         upscaler.init(param);
     }
 
@@ -63,8 +68,19 @@ try
         upscaled_K *= fact;
     }
 
-    std::cout.precision(15);
-    std::cout << "Upscaled K in millidarcy:\n" << upscaled_K << std::endl;
+    if (mpi.rank() == 0) {
+        std::cout.precision(15);
+        std::cout << "Upscaled K in millidarcy:\n" << upscaled_K << std::endl;
+        if (!output.empty()) {
+            std::ofstream os(output.c_str());
+            if (!os) {
+                std::cerr << "Could not open output file " << output << '\n';
+                return EXIT_FAILURE;
+            }
+            os.precision(15);
+            os << "# Upscaled K in millidarcy:\n" << upscaled_K << std::endl;
+        }
+    }
 }
 catch (const std::exception& e) {
     std::cerr << "Program threw an exception: " << e.what() << '\n';
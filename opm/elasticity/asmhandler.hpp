@@ -17,10 +17,12 @@
 #include <dune/geometry/referenceelements.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/istl/bvector.hh>
+#include <dune/istl/io.hh>
 #include <dune/common/fvector.hh>
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#include <cassert>
 
 #include <opm/elasticity/logutils.hpp>
 #include <opm/elasticity/mpc.hh>
@@ -45,7 +47,8 @@ class ASMHandler {
 
     //! \brief The default constructor
     //! \param[in] gv_ The grid the operator is assembled over
-    ASMHandler(const GridType& gv_) : gv(gv_), maxeqn(0)
+    ASMHandler(const GridType& gv_) : gv(gv_), maxeqn(0), blocked(false),
+                                      rank(0), nprocs(1)
     {
     }
 
@@ -82,6 +85,99 @@ class ASMHandler {
       return A;
     }
 
+    //! \brief Enable assembly into 3x3 nodal blocks
+    //! \details Must be called before initForAssembly(). DOFs eliminated
+    //!          by MPCs or fixed nodes are padded with identity rows in
+    //!          the blocks of their node. The scalar operator is then not
+    //!          allocated. Requires dim == 3, and is not available
+    //!          when the equations are partitioned.
+    void setBlockAssembly(bool enable)
+    {
+      assert(!enable || (dim == 3 && nprocs == 1));
+      blocked = enable;
+    }
+
+    //! \brief Check whether the operator is assembled into 3x3 blocks
+    bool isBlocked() const
+    {
+      return blocked;
+    }
+
+    //! \brief Obtain a reference to the block linear operator
+    //! \returns Reference to block linear operator
+    BlockMatrix& getBlockOperator()
+    {
+      return Ab;
+    }
+
+    //! \brief Distribute the equations over a number of processes
+    //! \details Must be called before initForAssembly(). The cells are
+    //!          split in contiguous ranges, one per process. An equation
+    //!          is owned by the process owning the first cell contributing
+    //!          to it. Each process assembles all cells contributing to
+    //!          its equations, including those on the far side of MPC
+    //!          couplings, so the owned rows of the operator are complete.
+    //!          The other equations coupled by these cells are copies,
+    //!          kept as identity rows. The operator and the system vectors
+    //!          are then numbered by the local equations, in the order of
+    //!          their global numbers. Not available with block assembly.
+    //! \param[in] rank_ The number of this process
+    //! \param[in] size The number of processes
+    void setPartition(int rank_, int size)
+    {
+      assert(!blocked && rank_ >= 0 && rank_ < size);
+      rank = rank_;
+      nprocs = size;
+    }
+
+    //! \brief Check whether the equations are distributed over processes
+    bool isPartitioned() const
+    {
+      return nprocs > 1;
+    }
+
+    //! \brief Check whether a cell is assembled on this process
+    //! \param[in] cell The cell number
+    bool isActiveCell(int cell) const
+    {
+      return activeCells.empty() || activeCells[cell];
+    }
+
+    //! \brief Check whether a cell is owned by this process
+    //! \details Each cell is owned by exactly one process.
+    //! \param[in] cell The cell number
+    bool isOwnedCell(int cell) const
+    {
+      return cellOwner(cell) == rank;
+    }
+
+    //! \brief Get the global equation numbers of the local equations
+    //! \returns The global numbers, empty if not partitioned
+    const std::vector<int>& getGlobalEqns() const
+    {
+      return globalEqn;
+    }
+
+    //! \brief Check whether a local equation is owned by this process
+    //! \param[in] eqn The local equation number
+    bool isOwnedEqn(int eqn) const
+    {
+      return ownedEqn.empty() || ownedEqn[eqn];
+    }
+
+    //! \brief Gather a system vector into a block vector
+    //! \param[out] r The block vector. Padded DOFs are set to zero
+    //! \param[in] v The system vector
+    void toBlockVector(BlockVector& r, const Vector& v) const;
+
+    //! \brief Scatter a block vector into a system vector
+    //! \param[out] r The system vector
+    //! \param[in] v The block vector
+    void fromBlockVector(Vector& r, const BlockVector& v) const;
+
+    //! \brief Zero the operator prior to (re)assembly
+    void zeroOperator();
+
     //! \brief Obtain a reference to the load vector
     //! \returns Reference to load vector
     Vector& getLoadVector()
@@ -114,6 +210,8 @@ class ASMHandler {
                        const Vector& u, const LeafIterator& it);
 
     //! \brief Expand a system vector to a solution vector
+    //! \details When partitioned, only the DOFs given by the local
+    //!          equations are set, the others are zero.
     void expandSolution(Vector& result, const Vector& u);
 
     //! \brief Add a MPC
@@ -145,13 +243,6 @@ class ASMHandler {
 
     //! \brief Print the current load vector
     void printLoadVector() const;
-
-    //! \brief Access current adjacency pattern
-    //! \details Can be used to add extra entries, such as other blocks
-    AdjacencyPattern& getAdjacencyPattern()
-    {
-      return adjacencyPattern;
-    }
   protected:
     //! \brief Resolve chained MPCs
     void resolveMPCChains()
@@ -168,14 +259,84 @@ class ASMHandler {
     //! \brief Internal function. Generate meqn for registered MPC/fixed nodes
     void preprocess();
 
-    //! \brief Internal function. Generate adjacency pattern for a given node
-    //! \param[in] it Iterator pointing to the cell in of the node
-    //! \param[in] vertexsize Number of vertices in the cell
-    //! \param[in] row The equation number/row in matrix
-    void nodeAdjacency(const LeafIterator& it, int vertexsize, int row);
+    //! \brief Internal function. Add the matrix row of an equation
+    //! \param[in] rows The rows coupled by the current cell
+    //! \param[in] eqn The equation number, -1 if inactive
+    void addElementRow(std::vector<int>& rows, int eqn) const;
+
+    //! \brief Internal function. Calculate adjacency pattern and set up
+    //!        the sparsity of the operator
+    //! \details The pattern is built in compressed row form from the
+    //!          cell couplings, without an intermediate set per row.
+    //! \param[out] mat The matrix (scalar or block) to set up
+      template<class M>
+    void determineAdjacencyPattern(M& mat);
+
+    //! \brief Internal function. Collect the sorted, unique columns of a
+    //!        row of the operator
+    //! \details The columns are the union of the rows coupled by the
+    //!          elements contributing to the row.
+    //! \param[in] row The row to collect the columns of
+    //! \param[in] rowStart Start of the elements of each row in \a rowElems
+    //! \param[in] rowElems The elements contributing to each row
+    //! \param[in] elemStart Start of the rows of each element in \a elemRows
+    //! \param[in] elemRows The rows coupled by each element
+    //! \param[out] cols The columns of the row
+    static void rowColumns(int row,
+                           const std::vector<int>& rowStart,
+                           const std::vector<int>& rowElems,
+                           const std::vector<int>& elemStart,
+                           const std::vector<int>& elemRows,
+                           std::vector<int>& cols);
+
+    //! \brief Internal function. Split the equations between the processes
+    //! \details Sets up the local equations and the assembled cells.
+    //! \param[in] rowStart Start of the elements of each row in \a rowElems
+    //! \param[in] rowElems The elements contributing to each row
+    //! \param[in] elemStart Start of the rows of each element in \a elemRows
+    //! \param[in] elemRows The rows coupled by each element
+    void partitionEquations(const std::vector<int>& rowStart,
+                            const std::vector<int>& rowElems,
+                            const std::vector<int>& elemStart,
+                            const std::vector<int>& elemRows);
+
+    //! \brief Internal function. Collect the columns of a local row
+    //! \details As rowColumns(), in local equation numbers. Copied rows
+    //!          only have their diagonal.
+    //! \param[in] row The local row to collect the columns of
+    //! \param[in] rowStart Start of the elements of each row in \a rowElems
+    //! \param[in] rowElems The elements contributing to each row
+    //! \param[in] elemStart Start of the rows of each element in \a elemRows
+    //! \param[in] elemRows The rows coupled by each element
+    //! \param[out] cols The columns of the row
+    void localColumns(int row,
+                      const std::vector<int>& rowStart,
+                      const std::vector<int>& rowElems,
+                      const std::vector<int>& elemStart,
+                      const std::vector<int>& elemRows,
+                      std::vector<int>& cols) const;
+
+    //! \brief Internal function. The process owning a cell
+    //! \param[in] cell The cell number
+    int cellOwner(int cell) const
+    {
+      return nprocs == 1 ? 0 : int((long long)cell*nprocs/gv.size(0));
+    }
 
-    //! \brief Internal function. Calculate adjacency pattern 
-    void determineAdjacencyPattern();
+    //! \brief Internal function. The local number of an equation
+    //! \param[in] eqn The global equation number
+    //! \returns The local equation number, -1 if not on this process
+    int localIndex(int eqn) const
+    {
+      return localEqn.empty() ? eqn : localEqn[eqn];
+    }
+
+    //! \brief Internal function. Check if this process owns an equation
+    //! \param[in] eqn The global equation number
+    bool ownsEqn(int eqn) const
+    {
+      return localEqn.empty() || (localEqn[eqn] != -1 && ownedEqn[localEqn[eqn]]);
+    }
 
     //! \brief Internal function. Assemble entries for a single DOF
     //! \param[in] row The row in the global matrix
@@ -195,6 +356,58 @@ class ASMHandler {
                 Vector* b,
                 double scale=1.f);
 
+    //! \brief Internal function. Assemble the columns of a single node
+    //! \param[in] row The row in the global matrix
+    //! \param[in] erow The row in the element matrix
+    //! \param[in] K The element matrix
+    //! \param[in] j The local node number in the element
+    //! \param[in] index2 The global node number
+    //! \param[in] scale Scale for elements. Used with MPC couplings
+      template<int esize>
+    void addNodeColumns(int row, int erow,
+                        const Dune::FieldMatrix<double,esize,esize>& K,
+                        int j, int index2, double scale);
+
+    //! \brief Internal function. Assemble all DOFs of a node as one block
+    //! \details Only valid for nodes with all DOFs active
+    //! \param[in] i The local node number in the element
+    //! \param[in] index1 The global node number
+    //! \param[in] K Pointer to the element matrix. Can be NULL
+    //! \param[in] S Pointer to the element load vector. Can be NULL
+    //! \param[in] set The index set
+    //! \param[in] cell An iterator pointing to the cell we're assembling for
+    //! \param[in] b Vector to add contributions to
+      template<int esize>
+    void addNodeBlock(int i, int index1,
+                      const Dune::FieldMatrix<double,esize,esize>* K,
+                      const Dune::FieldVector<double,esize>* S,
+                      const LeafIndexSet& set,
+                      const LeafIterator& cell,
+                      Vector* b);
+
+    //! \brief Internal function. Add a value to the operator
+    //! \param[in] row The equation number of the row
+    //! \param[in] col The equation number of the column
+    //! \param[in] val The value to add
+    void addToOperator(int row, int col, double val)
+    {
+      if (blocked)
+        Ab[blockDof[row]/dim][blockDof[col]/dim]
+          [blockDof[row]%dim][blockDof[col]%dim] += val;
+      else
+        A[localIndex(row)][localIndex(col)] += val;
+    }
+
+    //! \brief Internal function. Check if all DOFs of a node are active
+    //! \param[in] node The node number
+    bool allDofsActive(int node) const
+    {
+      for (int i=0;i<dim;++i)
+        if (meqn[node*dim+i] == -1)
+          return false;
+      return true;
+    }
+
     //! \brief The set of MPC
     MPCMap mpcs;
 
@@ -213,9 +426,6 @@ class ASMHandler {
     //! \brief The map holding information about our fixed nodes
     fixMap fixedNodes;
 
-    //! \brief Holds the adjacency pattern of the sparse matrix
-    AdjacencyPattern adjacencyPattern;
-
     //! \brief The linear operator
     Matrix A;
 
@@ -227,6 +437,56 @@ class ASMHandler {
 
     //! \brief The number of equations in the system
     size_t maxeqn;
+
+    //! \brief An active MPC master: equation number and coefficient
+    struct MasterEqn {
+      int eqn;      //!< The equation number of the master DOF
+      double coeff; //!< The coefficient of the master DOF
+    };
+
+    //! \brief The MPC of each (interleaved) dof, NULL if none
+    //! \details This and the tables below are built by preprocess()
+    std::vector<MPC*> mpcTable;
+
+    //! \brief Start of the active masters of each dof in \a masters
+    std::vector<int> masterStart;
+
+    //! \brief Active masters of all MPCs, in dof order
+    std::vector<MasterEqn> masters;
+
+    //! \brief The fixed directions (Direction flags) of each node
+    std::vector<unsigned char> fixedDofs;
+
+    //! \brief Whether or not to assemble into 3x3 blocks
+    bool blocked;
+
+    //! \brief The linear operator in block form
+    BlockMatrix Ab;
+
+    //! \brief The (block*dim+component) position of each equation
+    std::vector<int> blockDof;
+
+    //! \brief The equation for each block position, -1 for padding
+    std::vector<int> blockEqn;
+
+    //! \brief The number of this process
+    int rank;
+
+    //! \brief The number of processes sharing the equations
+    int nprocs;
+
+    //! \brief The local number of each global equation, -1 if not local
+    //! \details This and the tables below are empty if not partitioned
+    std::vector<int> localEqn;
+
+    //! \brief The global number of each local equation
+    std::vector<int> globalEqn;
+
+    //! \brief Whether each local equation is owned by this process
+    std::vector<char> ownedEqn;
+
+    //! \brief Whether each cell is assembled on this process
+    std::vector<char> activeCells;
   private:
     //! \brief No copying of this class
     ASMHandler(const ASMHandler&) {}
@@ -13,7 +13,9 @@
 #define ASMHANDLER_IMPL_HPP_
 
 #include <dune/common/version.hh>
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 
 namespace Opm {
 namespace Elasticity {
@@ -23,13 +25,14 @@ void ASMHandler<GridType>::initForAssembly()
 {
   resolveMPCChains();
   preprocess();
-  determineAdjacencyPattern();
+  if (blocked)
+    determineAdjacencyPattern(Ab);
+  else
+    determineAdjacencyPattern(A);
+  zeroOperator();
 
-  MatrixOps::fromAdjacency(A,adjacencyPattern,
-                           adjacencyPattern.size(),adjacencyPattern.size());
-  b.resize(adjacencyPattern.size());
+  b.resize(localEqn.empty() ? maxeqn : globalEqn.size());
   b = 0;
-  adjacencyPattern.clear();
 
   // print some information
   std::cout << "\tNumber of nodes: " << gv.size(dim) << std::endl;
@@ -57,27 +60,62 @@ void ASMHandler<GridType>::addDOF(int row, int erow,
                               Vector* bptr,
                               double scale)
 {
-  if (row == -1)
+  if (row == -1 || !ownsEqn(row))
     return;
   if (K) {
+    for (int j=0;j<esize/dim;++j)
+      addNodeColumns(row,erow,*K,j,set.subIndex(*cell,j,dim),scale);
+  }
+  if (S && bptr)
+    (*bptr)[localIndex(row)] += scale*(*S)[erow];
+}
+
+  template<class GridType>
+    template<int esize>
+void ASMHandler<GridType>::addNodeColumns(int row, int erow,
+                                const Dune::FieldMatrix<double,esize,esize>& K,
+                                int j, int index2, double scale)
+{
+  for (int l=0;l<dim;++l) {
+    int dof = index2*dim+l;
+    if (mpcTable[dof]) {
+      for (int n=masterStart[dof];n<masterStart[dof+1];++n)
+        addToOperator(row,masters[n].eqn,scale*masters[n].coeff*K[erow][j*dim+l]);
+    } else if (meqn[dof] != -1) {
+      addToOperator(row,meqn[dof],scale*K[erow][j*dim+l]);
+    }
+  }
+}
+
+  template<class GridType>
+    template<int esize>
+void ASMHandler<GridType>::addNodeBlock(int i, int index1,
+                              const Dune::FieldMatrix<double,esize,esize>* K,
+                              const Dune::FieldVector<double,esize>* S,
+                              const LeafIndexSet& set,
+                              const LeafIterator& cell,
+                              Vector* bptr)
+{
+  if (K) {
+    int brow = blockDof[meqn[index1*dim]]/dim;
     for (int j=0;j<esize/dim;++j) {
       int index2 = set.subIndex(*cell,j,dim);
-      for (int l=0;l<dim;++l) {
-        MPC* mpc = getMPC(index2,l);
-        if (mpc) {
-          for (size_t n=0;n<mpc->getNoMaster();++n) {
-            int idx = meqn[mpc->getMaster(n).node*dim+mpc->getMaster(n).dof-1];
-            if (idx != -1)
-              A[row][idx] += scale*mpc->getMaster(n).coeff*(*K)[erow][j*dim+l];
-          }
-        } else if (meqn[index2*dim+l] != -1) {
-          A[row][meqn[index2*dim+l]] += scale*(*K)[erow][j*dim+l];
-        }
+      if (allDofsActive(index2)) {
+        // one block lookup for the full nodal coupling
+        BlockMatrix::block_type& blk = Ab[brow][blockDof[meqn[index2*dim]]/dim];
+        for (int k=0;k<dim;++k)
+          for (int l=0;l<dim;++l)
+            blk[k][l] += (*K)[i*dim+k][j*dim+l];
+      } else {
+        for (int k=0;k<dim;++k)
+          addNodeColumns(meqn[index1*dim+k],i*dim+k,*K,j,index2,1.0);
       }
     }
   }
-  if (S && bptr)
-    (*bptr)[row] += scale*(*S)[erow];
+  if (S && bptr) {
+    for (int k=0;k<dim;++k)
+      (*bptr)[meqn[index1*dim+k]] += (*S)[i*dim+k];
+  }
 }
 
   template<class GridType>
@@ -93,18 +131,19 @@ void ASMHandler<GridType>::addElement(
   const LeafIndexSet& set = gv.leafGridView().indexSet();
   for (int i=0;i<esize/dim;++i) {
     int index1 = set.subIndex(*cell,i,dim);
-    fixIt it = fixedNodes.find(index1);
-    if (it != fixedNodes.end() && it->second.first == XYZ)
+    if (fixedDofs[index1] == XYZ)
+      continue;
+    if (blocked && allDofsActive(index1)) {
+      addNodeBlock(i,index1,K,S,set,cell,b2);
       continue;
+    }
     for (int k=0;k<dim;++k) {
-      MPC* mpc = getMPC(index1,k);
-      if (mpc) {
-        for (size_t n=0;n<mpc->getNoMaster();++n) {
-          int idx = meqn[mpc->getMaster(n).node*dim+mpc->getMaster(n).dof-1];
-          addDOF(idx,i*dim+k,K,S,set,cell,b2,mpc->getMaster(n).coeff);
-        }
+      int dof = index1*dim+k;
+      if (mpcTable[dof]) {
+        for (int n=masterStart[dof];n<masterStart[dof+1];++n)
+          addDOF(masters[n].eqn,i*dim+k,K,S,set,cell,b2,masters[n].coeff);
       } else
-        addDOF(meqn[index1*dim+k],i*dim+k,K,S,set,cell,b2);
+        addDOF(meqn[dof],i*dim+k,K,S,set,cell,b2);
     }
   }
 }
@@ -125,20 +164,16 @@ void ASMHandler<GridType>::extractValues(Dune::FieldVector<double,comp>& v,
   int l=0;
   for (int i=0;i<vertexsize;++i) {
     int indexi = set.subIndex(*it,i,dim);
-    fixIt it2 = fixedNodes.find(indexi);
     for (int n=0;n<dim;++n) {
-      MPC* mpc = getMPC(indexi,n);
-      if (it2 != fixedNodes.end() && it2->second.first & (1 << n))
-        v[l++] = it2->second.second[n];
-      else if (mpc) {
-        for (size_t m=0;m<mpc->getNoMaster();++m) {
-          int idx = meqn[mpc->getMaster(m).node*dim+mpc->getMaster(m).dof-1];
-          if (idx != -1)
-            v[l] += u[idx]*mpc->getMaster(m).coeff;
-        }
+      int dof = indexi*dim+n;
+      if (fixedDofs[indexi] & (1 << n))
+        v[l++] = fixedNodes.find(indexi)->second.second[n];
+      else if (mpcTable[dof]) {
+        for (int m=masterStart[dof];m<masterStart[dof+1];++m)
+          v[l] += u[localIndex(masters[m].eqn)]*masters[m].coeff;
         l++;
       } else
-        v[l++] = u[meqn[indexi*dim+n]];
+        v[l++] = u[localIndex(meqn[dof])];
     }
   }
 }
@@ -151,36 +186,69 @@ void ASMHandler<GridType>::expandSolution(Vector& result, const Vector& u)
   result = 0;
   int l=0;
   for (int i=0;i<nodes;++i) {
-    fixIt it = fixedNodes.find(i);
-    Direction dir;
-    if (it == fixedNodes.end())
-      dir = NONE;
-    else
-      dir = it->second.first;
+    int dir = fixedDofs[i];
+    fixIt it;
+    if (dir != NONE)
+      it = fixedNodes.find(i);
 
     int flag=1;
     for (int j=0;j<dim;++j) {
       if (dir & flag)
         result[l] = it->second.second[j];
-      else if (meqn[l] != -1)
-        result[l] = u[meqn[l]];
+      else if (meqn[l] != -1 && localIndex(meqn[l]) != -1)
+        result[l] = u[localIndex(meqn[l])];
       l++;
       flag *= 2;
     }
   }
   // second loop - handle MPC couplings
-  l = 0;
-  for (int i=0;i<nodes;++i) {
-    for (int j=0;j<dim;++j) {
-      MPC* mpc = getMPC(i,j);
-      if (mpc) {
-        for (size_t n=0;n<mpc->getNoMaster();++n) {
-          int idx = mpc->getMaster(n).node*dim+mpc->getMaster(n).dof-1;
-          if (meqn[idx] != -1)
-            result[l] += u[meqn[idx]]*mpc->getMaster(n).coeff;
+  for (l=0;l<nodes*dim;++l) {
+    if (mpcTable[l]) {
+      for (int n=masterStart[l];n<masterStart[l+1];++n) {
+        if (localIndex(masters[n].eqn) == -1) {
+          result[l] = 0;
+          break;
         }
+        result[l] += u[localIndex(masters[n].eqn)]*masters[n].coeff;
       }
-      ++l;
+    }
+  }
+}
+
+  template<class GridType>
+void ASMHandler<GridType>::toBlockVector(BlockVector& r, const Vector& v) const
+{
+  r.resize(blockEqn.size()/dim);
+  for (size_t i=0;i<blockEqn.size();++i)
+    r[i/dim][i%dim] = blockEqn[i] == -1 ? 0.0 : v[blockEqn[i]];
+}
+
+  template<class GridType>
+void ASMHandler<GridType>::fromBlockVector(Vector& r, const BlockVector& v) const
+{
+  r.resize(maxeqn);
+  for (size_t i=0;i<blockEqn.size();++i) {
+    if (blockEqn[i] != -1)
+      r[blockEqn[i]] = v[i/dim][i%dim];
+  }
+}
+
+  template<class GridType>
+void ASMHandler<GridType>::zeroOperator()
+{
+  if (blocked) {
+    Ab = 0;
+    // padded DOFs are decoupled, unit diagonal keeps the blocks regular
+    for (size_t i=0;i<blockEqn.size();++i) {
+      if (blockEqn[i] == -1)
+        Ab[i/dim][i/dim][i%dim][i%dim] = 1.0;
+    }
+  } else {
+    A = 0;
+    // rows owned by other processes are identities
+    for (size_t i=0;i<ownedEqn.size();++i) {
+      if (!ownedEqn[i])
+        A[i][i] = 1.0;
     }
   }
 }
@@ -206,8 +274,12 @@ void ASMHandler<GridType>::addMPC(MPC* mpc)
   template<class GridType>
 MPC* ASMHandler<GridType>::getMPC(int node, int dof)
 {
-  if (mpcs.find(node*dim+dof) != mpcs.end())
-    return mpcs[node*dim+dof];
+  if (!mpcTable.empty())
+    return mpcTable[node*dim+dof];
+
+  MPCMap::iterator it = mpcs.find(node*dim+dof);
+  if (it != mpcs.end())
+    return it->second;
 
   return NULL;
 }
@@ -236,7 +308,10 @@ void ASMHandler<GridType>::updateFixedNode(int node,
   template<class GridType>
 void ASMHandler<GridType>::printOperator() const
 {
-  MatrixOps::print(A);
+  if (blocked)
+    Dune::printmatrix(std::cout, Ab, "A", "row");
+  else
+    MatrixOps::print(A);
 }
 
   template<class GridType>
@@ -347,43 +422,168 @@ void ASMHandler<GridType>::preprocess()
     }
   }
   std::cout << "\tnumber of equations: " << maxeqn << std::endl;
+
+  // flat lookup tables for the assembly loops. the MPCs are resolved and
+  // meqn is final, so masters are stored by equation number, dropping
+  // the inactive ones.
+  fixedDofs.assign(nodes, NONE);
+  for (fixIt it = fixedNodes.begin(); it != fixedNodes.end(); ++it)
+    fixedDofs[it->first] = it->second.first;
+  mpcTable.assign(nodes*dim, (MPC*)NULL);
+  masterStart.assign(nodes*dim+1, 0);
+  masters.clear();
+  for (int dof=0;dof<nodes*dim;++dof) {
+    MPCMap::iterator it = mpcs.find(dof);
+    if (it != mpcs.end()) {
+      MPC* mpc = it->second;
+      mpcTable[dof] = mpc;
+      for (size_t n=0;n<mpc->getNoMaster();++n) {
+        MasterEqn m;
+        m.eqn = meqn[mpc->getMaster(n).node*dim+mpc->getMaster(n).dof-1];
+        m.coeff = mpc->getMaster(n).coeff;
+        if (m.eqn != -1)
+          masters.push_back(m);
+      }
+    }
+    masterStart[dof+1] = masters.size();
+  }
+
+  if (blocked) {
+    // one block per node with at least one active DOF. the equations of
+    // a node are numbered consecutively, so the block order follows them.
+    blockDof.resize(maxeqn);
+    blockEqn.clear();
+    for (int indexi=0;indexi<nodes;++indexi) {
+      bool active=false;
+      for (int i=0;i<dim;++i)
+        active |= meqn[indexi*dim+i] != -1;
+      if (!active)
+        continue;
+      int block = blockEqn.size()/dim;
+      for (int i=0;i<dim;++i) {
+        int eqn = meqn[indexi*dim+i];
+        blockEqn.push_back(eqn);
+        if (eqn != -1)
+          blockDof[eqn] = block*dim+i;
+      }
+    }
+    std::cout << "\tnumber of " << dim << "x" << dim << " blocks: "
+              << blockEqn.size()/dim << std::endl;
+  }
 }
 
   template<class GridType>
-void ASMHandler<GridType>::nodeAdjacency(const LeafIterator& it,
-                                         int vertexsize, int row)
+void ASMHandler<GridType>::addElementRow(std::vector<int>& rows, int eqn) const
 {
-  if (row == -1)
+  if (eqn != -1)
+    rows.push_back(blocked ? blockDof[eqn]/dim : eqn);
+}
+
+  template<class GridType>
+void ASMHandler<GridType>::rowColumns(int row,
+                                      const std::vector<int>& rowStart,
+                                      const std::vector<int>& rowElems,
+                                      const std::vector<int>& elemStart,
+                                      const std::vector<int>& elemRows,
+                                      std::vector<int>& cols)
+{
+  cols.clear();
+  for (int i=rowStart[row];i<rowStart[row+1];++i) {
+    int e = rowElems[i];
+    cols.insert(cols.end(), elemRows.begin()+elemStart[e],
+                            elemRows.begin()+elemStart[e+1]);
+  }
+  std::sort(cols.begin(), cols.end());
+  cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+}
+
+  template<class GridType>
+void ASMHandler<GridType>::localColumns(int row,
+                                        const std::vector<int>& rowStart,
+                                        const std::vector<int>& rowElems,
+                                        const std::vector<int>& elemStart,
+                                        const std::vector<int>& elemRows,
+                                        std::vector<int>& cols) const
+{
+  if (localEqn.empty()) {
+    rowColumns(row, rowStart, rowElems, elemStart, elemRows, cols);
     return;
-  const LeafIndexSet& set = gv.leafGridView().indexSet();
-  for (int j=0;j<vertexsize;++j) {
-    int indexj = set.subIndex(*it,j,dim);
-    for (int l=0;l<dim;++l) {
-      MPC* mpc = getMPC(indexj,l);
-      if (mpc) {
-        for (size_t i=0;i<mpc->getNoMaster();++i) {
-          int idx = meqn[mpc->getMaster(i).node*dim+
-            mpc->getMaster(i).dof-1];
-          if (idx != -1)
-            adjacencyPattern[row].insert(idx);
-        }
-      } else if (meqn[indexj*dim+l] != -1)
-        adjacencyPattern[row].insert(meqn[indexj*dim+l]);
+  }
+  if (!ownedEqn[row]) {
+    cols.assign(1, row);
+    return;
+  }
+  // all columns of an owned row are local, and the local numbering
+  // keeps the global order
+  rowColumns(globalEqn[row], rowStart, rowElems, elemStart, elemRows, cols);
+  for (size_t i=0;i<cols.size();++i)
+    cols[i] = localEqn[cols[i]];
+}
+
+  template<class GridType>
+void ASMHandler<GridType>::partitionEquations(const std::vector<int>& rowStart,
+                                              const std::vector<int>& rowElems,
+                                              const std::vector<int>& elemStart,
+                                              const std::vector<int>& elemRows)
+{
+  int cells = elemStart.size()-1;
+  activeCells.assign(cells, 0);
+  for (int e=0;e<cells;++e)
+    activeCells[e] = cellOwner(e) == rank;
+
+  // rowElems is sorted within each row, so the first cell decides the
+  // owner. the cells of the owned rows are assembled here, which pulls
+  // in the slave side cells of periodic MPC couplings.
+  std::vector<char> owned(maxeqn, 0);
+  for (size_t r=0;r<maxeqn;++r) {
+    if (rowStart[r] == rowStart[r+1] || cellOwner(rowElems[rowStart[r]]) != rank)
+      continue;
+    owned[r] = 1;
+    for (int i=rowStart[r];i<rowStart[r+1];++i)
+      activeCells[rowElems[i]] = 1;
+  }
+
+  // the local equations are all rows coupled by the assembled cells
+  localEqn.assign(maxeqn, -1);
+  for (int e=0;e<cells;++e) {
+    if (activeCells[e]) {
+      for (int i=elemStart[e];i<elemStart[e+1];++i)
+        localEqn[elemRows[i]] = 0;
     }
   }
+  globalEqn.clear();
+  ownedEqn.clear();
+  int nowned=0;
+  for (size_t r=0;r<maxeqn;++r) {
+    if (localEqn[r] == -1)
+      continue;
+    localEqn[r] = globalEqn.size();
+    globalEqn.push_back(r);
+    ownedEqn.push_back(owned[r]);
+    nowned += owned[r];
+  }
+  std::cout << "\tprocess " << rank << " of " << nprocs << ": "
+            << nowned << " owned and " << globalEqn.size()-nowned
+            << " copied equations, "
+            << std::count(activeCells.begin(), activeCells.end(), 1)
+            << " of " << cells << " cells" << std::endl;
 }
 
   template<class GridType>
-void ASMHandler<GridType>::determineAdjacencyPattern()
+    template<class M>
+void ASMHandler<GridType>::determineAdjacencyPattern(M& mat)
 {
-  adjacencyPattern.resize(maxeqn);
   std::cout << "\tsetting up sparsity pattern..." << std::endl;
   LoggerHelper help(gv.size(0), 5, 50000);
 
   const LeafIndexSet& set = gv.leafGridView().indexSet();
   LeafIterator itend = gv.leafGridView().template end<0>();
 
-  // iterate over cells
+  // the matrix rows coupled by each cell (CSR). all of them couple to
+  // each other, so this is all the information the pattern needs.
+  std::vector<int> elemStart(1, 0);
+  std::vector<int> elemRows;
+  elemStart.reserve(gv.size(0)+1);
   int cell=0;
   for (LeafIterator it = gv.leafGridView().template begin<0>(); it != itend; ++it, ++cell) {
     Dune::GeometryType gt = it->type();
@@ -392,23 +592,75 @@ void ASMHandler<GridType>::determineAdjacencyPattern()
       Dune::ReferenceElements<double,dim>::general(gt);
 
     int vertexsize = ref.size(dim);
+    size_t start = elemRows.size();
     for (int i=0; i < vertexsize; i++) {
       int indexi = set.subIndex(*it,i,dim);
       for (int k=0;k<dim;++k) {
-        MPC* mpc = getMPC(indexi,k);
-        if (mpc) {
-          for (size_t l=0;l<mpc->getNoMaster();++l) {
-            nodeAdjacency(it,vertexsize,
-                          meqn[mpc->getMaster(l).node*dim+
-                               mpc->getMaster(l).dof-1]);
-          }
+        int dof = indexi*dim+k;
+        if (mpcTable[dof]) {
+          for (int l=masterStart[dof];l<masterStart[dof+1];++l)
+            addElementRow(elemRows, masters[l].eqn);
         } else
-          nodeAdjacency(it,vertexsize,meqn[indexi*dim+k]);
+          addElementRow(elemRows, meqn[dof]);
       }
     }
+    std::sort(elemRows.begin()+start, elemRows.end());
+    elemRows.erase(std::unique(elemRows.begin()+start, elemRows.end()),
+                   elemRows.end());
+    elemStart.push_back(elemRows.size());
     if (cell % 10000 == 0)
       help.log(cell, "\t\t... still processing ... cell ");
   }
+  int cells = cell;
+  int grows = blocked ? blockEqn.size()/dim : maxeqn;
+
+  // invert to the cells contributing to each row (CSR, counting sort)
+  std::vector<int> rowStart(grows+1, 0);
+  for (size_t i=0;i<elemRows.size();++i)
+    ++rowStart[elemRows[i]+1];
+  std::partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+  std::vector<int> rowElems(elemRows.size());
+  {
+    std::vector<int> pos(rowStart.begin(), rowStart.end()-1);
+    for (int e=0;e<cells;++e)
+      for (int i=elemStart[e];i<elemStart[e+1];++i)
+        rowElems[pos[elemRows[i]]++] = e;
+  }
+
+  if (nprocs > 1)
+    partitionEquations(rowStart, rowElems, elemStart, elemRows);
+  int rows = localEqn.empty() ? grows : globalEqn.size();
+
+  // two passes over the rows, first the sizes and then the indices, which
+  // are written directly into the matrix. rows are independent.
+  std::vector<int> rowSize(rows);
+#pragma omp parallel
+  {
+    std::vector<int> cols;
+#pragma omp for schedule(static)
+    for (int r=0;r<rows;++r) {
+      localColumns(r, rowStart, rowElems, elemStart, elemRows, cols);
+      rowSize[r] = cols.size();
+    }
+  }
+
+  size_t nnz = std::accumulate(rowSize.begin(), rowSize.end(), size_t(0));
+  mat.setSize(rows, rows, nnz);
+  mat.setBuildMode(M::random);
+  for (int r=0;r<rows;++r)
+    mat.setrowsize(r, rowSize[r]);
+  mat.endrowsizes();
+
+#pragma omp parallel
+  {
+    std::vector<int> cols;
+#pragma omp for schedule(static)
+    for (int r=0;r<rows;++r) {
+      localColumns(r, rowStart, rowElems, elemStart, elemRows, cols);
+      mat.setIndices(r, cols.begin(), cols.end());
+    }
+  }
+  mat.endindices();
 }
 
 }} // namespace Opm, Elasticity
@@ -0,0 +1,74 @@
+//==============================================================================
+//!
+//! \file block_solver.hpp
+//!
+//! \date Oct 16 2026
+//!
+//! \author Arne Morten Kvarving / SINTEF
+//!
+//! \brief Solver adapter for operators assembled in 3x3 nodal blocks
+//!
+//==============================================================================
+#ifndef OPM_ELASTICITY_BLOCK_SOLVER_HPP_
+#define OPM_ELASTICITY_BLOCK_SOLVER_HPP_
+
+#include <dune/istl/solvers.hh>
+
+#include <opm/elasticity/matrixops.hpp>
+
+namespace Opm {
+  namespace Elasticity {
+
+/*! Template wrapping a solver on the 3x3 block system as a solver on the
+ *  scalar system vectors, so the rest of the upscaling code is unaware
+ *  of the block storage. */
+
+  template<class ASM>
+class BlockSolverAdapter : public Dune::InverseOperator<Vector,Vector>
+{
+  public:
+    typedef std::shared_ptr<Dune::InverseOperator<BlockVector,BlockVector> > OperatorPtr;
+    //! \brief Default constructor
+    //! \param[in] solver_ The solver for the block system
+    //! \param[in] A_ The assembly handler holding the block mapping
+    BlockSolverAdapter(const OperatorPtr& solver_, const ASM& A_) :
+      solver(solver_), A(A_)
+    {
+    }
+
+    //! \brief Apply the solver to a vector
+    //! \param[in] x The solution vector
+    //! \param[in] b The load vector
+    //! \param[in] reduction The wanted residual reduction
+    //! \param[in] res The inverse operator result
+    void apply(Vector& x, Vector& b, double reduction,
+               Dune::InverseOperatorResult& res)
+    {
+      A.toBlockVector(bb, b);
+      A.toBlockVector(xb, x);
+      solver->apply(xb, bb, reduction, res);
+      A.fromBlockVector(x, xb);
+    }
+
+    //! \brief Apply the solver to a vector
+    //! \param[in] x The solution vector
+    //! \param[in] b The load vector
+    //! \param[in] res The inverse operator result
+    void apply(Vector& x, Vector& b, Dune::InverseOperatorResult& res)
+    {
+      A.toBlockVector(bb, b);
+      A.toBlockVector(xb, x);
+      solver->apply(xb, bb, res);
+      A.fromBlockVector(x, xb);
+    }
+  protected:
+    OperatorPtr solver; //!< The block solver
+    const ASM& A;       //!< The assembly handler
+    BlockVector xb;     //!< Block solution work vector
+    BlockVector bb;     //!< Block load work vector
+};
+
+}
+}
+
+#endif
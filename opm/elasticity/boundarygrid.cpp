@@ -64,6 +64,7 @@ BoundaryGrid BoundaryGrid::uniform(const FaceCoord& min, const FaceCoord& max,
   }
 
   result.nodes = (k1+1)*(k2+1);
+  result.buildIndex();
   return result;
 }
 
@@ -84,6 +85,8 @@ void BoundaryGrid::extract(Vertex& res, const Dune::FieldVector<double,3>& coord
 
 void BoundaryGrid::add(const Quad& quad)
 {
+  idxStart.clear();
+  idxQuads.clear();
   grid.push_back(quad);
   Quad& q = grid.back();
 
@@ -114,29 +117,108 @@ inline bool EQUAL2(const BoundaryGrid::FaceCoord& x,
   return hypot(x[0]-y[0],x[1]-y[1]) < tol;
 }
 
+bool BoundaryGrid::locate(Vertex& res, const Quad& q,
+                          const Vertex& coord) const
+{
+  res.q = const_cast<Quad*>(&q);
+  // check if we have exactly a node
+  for (int i=0;i<4;++i) {
+    if (EQUAL2(coord.c,q.v[i].c,1.e-8)) {
+      res.i = q.v[i].i;
+      return true;
+    }
+  }
+
+  return Q4inv(res.c,q,coord.c,1.e-8,1.e-8) > 0;
+}
+
+void BoundaryGrid::buildIndex()
+{
+  idxStart.clear();
+  idxQuads.clear();
+  if (grid.empty())
+    return;
+
+  const double eps = 1.e-8;
+  idxMin = grid[0].bb[0];
+  FaceCoord idxMax = grid[0].bb[1];
+  for (size_t q=1;q<grid.size();++q) {
+    for (int d=0;d<2;++d) {
+      idxMin[d] = std::min(idxMin[d], grid[q].bb[0][d]);
+      idxMax[d] = std::max(idxMax[d], grid[q].bb[1][d]);
+    }
+  }
+
+  // aim for roughly one quad per bucket, respecting the aspect ratio
+  double w = idxMax[0]-idxMin[0];
+  double h = idxMax[1]-idxMin[1];
+  int n = grid.size();
+  if (w > 0 && h > 0) {
+    idxN[0] = std::max(1, int(std::min(double(n), std::sqrt(n*w/h)+0.5)));
+    idxN[1] = std::max(1, std::min(n, (n+idxN[0]-1)/idxN[0]));
+  } else {
+    // degenerate face, only bin along the direction with an extent
+    idxN[0] = w > 0 ? n : 1;
+    idxN[1] = h > 0 ? n : 1;
+  }
+  idxDelta[0] = w > 0 ? w/idxN[0] : 1.0;
+  idxDelta[1] = h > 0 ? h/idxN[1] : 1.0;
+
+  // counting sort of the quads into the buckets overlapped by their
+  // (tolerance-extended) bounding boxes
+  idxStart.assign(idxN[0]*idxN[1]+1, 0);
+  for (int pass=0;pass<2;++pass) {
+    for (size_t q=0;q<grid.size();++q) {
+      int i0 = bucket(grid[q].bb[0][0]-eps, 0);
+      int i1 = bucket(grid[q].bb[1][0]+eps, 0);
+      int j0 = bucket(grid[q].bb[0][1]-eps, 1);
+      int j1 = bucket(grid[q].bb[1][1]+eps, 1);
+      for (int j=j0;j<=j1;++j) {
+        for (int i=i0;i<=i1;++i) {
+          if (pass == 0)
+            ++idxStart[j*idxN[0]+i+1];
+          else
+            idxQuads[idxStart[j*idxN[0]+i]++] = q;
+        }
+      }
+    }
+    if (pass == 0) {
+      for (size_t b=1;b<idxStart.size();++b)
+        idxStart[b] += idxStart[b-1];
+      idxQuads.resize(idxStart.back());
+    } else {
+      // shift the start offsets back in place
+      for (size_t b=idxStart.size()-1;b>0;--b)
+        idxStart[b] = idxStart[b-1];
+      idxStart[0] = 0;
+    }
+  }
+}
+
 bool BoundaryGrid::find(Vertex& res, const Vertex& coord) const
 {
+  res.i = -1;
+  if (!idxStart.empty()) {
+    // only test the quads in the bucket holding the coordinate. as the
+    // bucket lists are sorted, we find the same quad as the linear scan
+    int b = bucket(coord.c[1],1)*idxN[0]+bucket(coord.c[0],0);
+    BoundedPredicate inside(coord.c);
+    for (int k=idxStart[b];k<idxStart[b+1];++k) {
+      const Quad& q = grid[idxQuads[k]];
+      if (inside(q) && locate(res,q,coord))
+        return true;
+    }
+    std::cout << " failed to locate " << coord.c << std::endl;
+    assert(0);
+    return false;
+  }
+
   // find first quad with coord within bounding box 
   std::vector<Quad>::const_iterator it = std::find_if(grid.begin(),grid.end(),
                                                       BoundedPredicate(coord.c));
 
-  res.i = -1;
   while (it != grid.end()) {
-    res.q = const_cast<Quad*>(&(*it));
-    // check if we have exactly a node
-    bool ok=false;
-    for (int i=0;i<4;++i) {
-      if (EQUAL2(coord.c,it->v[i].c,1.e-8)) {
-        res.i = it->v[i].i;
-        ok = true;
-        break;
-      }
-    } 
-    if (!ok && Q4inv(res.c,*it,coord.c,1.e-8,1.e-8) > 0) {
-      ok = true;
-    }
-
-    if (ok)
+    if (locate(res,*it,coord))
       break;
     it = std::find_if(it+1,grid.end(),BoundedPredicate(coord.c));
   }
@@ -24,6 +24,8 @@
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 namespace Opm {
@@ -177,8 +179,16 @@ class BoundaryGrid {
     //! \brief Locate the position of a vertex on the grid
     //! \param[in] coord The coordinate of the vertex
     //! \param[out] res The resulting coordinates
+    //! \details Only the quads in the bucket of the spatial index containing
+    //!          the vertex are tested if buildIndex() has been called,
+    //!          otherwise all quads are scanned.
     bool find(Vertex& res, const Vertex& coord) const;
 
+    //! \brief Bin the quads in a uniform bucket grid to speed up find()
+    //! \details Must be called again after adding quads. The index is
+    //!          read-only afterwards so find() may be called concurrently.
+    void buildIndex();
+
     //! \brief Helper function for extracting given 2D coordinates from a 3D coordinate
     //! \param[in] coord The 3D coordinates of the vertex
     //! \param[in] dir The direction to ignore
@@ -241,6 +251,32 @@ class BoundaryGrid {
     //! \brief Total number of nodes on grid
     size_t nodes;
 
+    //! \brief Lower left corner of the spatial index
+    FaceCoord idxMin;
+    //! \brief Bucket size of the spatial index in each direction
+    FaceCoord idxDelta;
+    //! \brief Number of buckets of the spatial index in each direction
+    int idxN[2];
+    //! \brief Start of the quad list of each bucket in idxQuads
+    std::vector<int> idxStart;
+    //! \brief Quads overlapping each bucket, in ascending order
+    std::vector<int> idxQuads;
+
+    //! \brief Bucket index of a coordinate in a given direction
+    //! \param[in] x The coordinate
+    //! \param[in] dir The direction
+    int bucket(double x, int dir) const
+    {
+      int b = int(std::floor((x-idxMin[dir])/idxDelta[dir]));
+      return std::max(0, std::min(b, idxN[dir]-1));
+    }
+
+    //! \brief Check if a vertex falls within a given quad
+    //! \param[in] q The quad to check
+    //! \param[in] coord The coordinate of the vertex
+    //! \param[out] res The resulting coordinates
+    bool locate(Vertex& res, const Quad& q, const Vertex& coord) const;
+
     //! \brief Print to a stream
     friend std::ostream& operator <<(std::ostream& os, const BoundaryGrid& g)
     {
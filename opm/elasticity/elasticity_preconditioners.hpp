@@ -26,6 +26,10 @@
 #include <dune/istl/paamg/fastamg.hh>
 #include <dune/istl/paamg/twolevelmethod.hh>
 #include <dune/istl/overlappingschwarz.hh>
+#if defined(HAVE_MPI) && HAVE_MPI
+#include <dune/istl/owneroverlapcopy.hh>
+#include <dune/istl/schwarz.hh>
+#endif
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
@@ -61,6 +65,18 @@ typedef Dune::SeqILU0<Matrix, Vector, Vector> ILUSmoother;
 typedef Dune::SeqOverlappingSchwarz<Matrix,Vector,
                               Dune::SymmetricMultiplicativeSchwarzMode, LUSolver> SchwarzSmoother;
 
+//! \brief A linear operator on 3x3 nodal blocks
+typedef Dune::MatrixAdapter<BlockMatrix,BlockVector,BlockVector> BlockOperator;
+
+//! \brief Block SSOR AMG smoother (inverts the nodal 3x3 diagonal blocks)
+typedef Dune::SeqSSOR<BlockMatrix, BlockVector, BlockVector> BlockSSORSmoother;
+
+//! \brief Block GJ AMG smoother
+typedef Dune::SeqJac<BlockMatrix, BlockVector, BlockVector> BlockJACSmoother;
+
+//! \brief Block ILU0 AMG smoother
+typedef Dune::SeqILU0<BlockMatrix, BlockVector, BlockVector> BlockILUSmoother;
+
 //! \brief Overlapping Schwarz preconditioner
 struct Schwarz {
   typedef Dune::SeqOverlappingSchwarz<Matrix, Vector,
@@ -133,6 +149,48 @@ struct AMG1 {
   }
 };
 
+//! \brief An AMG on the 3x3 block operator
+//! \details Aggregates nodes rather than single DOFs, using the Frobenius
+//!          norm of the nodal blocks as coupling metric.
+template<class Smoother>
+struct BlockAMG {
+  //! \brief The coupling metric used in the AMG
+  typedef Dune::Amg::FrobeniusNorm CouplingMetric;
+
+  //! \brief The coupling criterion used in the AMG
+  typedef Dune::Amg::SymmetricCriterion<BlockMatrix, CouplingMetric> CritBase;
+
+  //! \brief The coarsening criterion used in the AMG
+  typedef Dune::Amg::CoarsenCriterion<CritBase> Criterion;
+
+  typedef Dune::Amg::AMG<BlockOperator, BlockVector, Smoother> type;
+
+  //! \brief Setup preconditioner
+  //! \param[in] pre The number of pre-smoothing steps
+  //! \param[in] post The number of post-smoothing steps
+  //! \param[in] target The coarsening target
+  //! \param[in] zcells The wanted number of cells to collapse in z per level
+  //! \param[in] op The block linear operator
+  //! \param[out] copy Whether or not to clone for threads
+  static std::shared_ptr<type>
+                setup(int pre, int post, int target, int zcells,
+                      std::shared_ptr<BlockOperator>& op, bool& copy)
+  {
+    Criterion crit;
+    typename BlockAMG<Smoother>::type::SmootherArgs args;
+    args.relaxationFactor = 1.0;
+    crit.setCoarsenTarget(target);
+    crit.setGamma(1);
+    crit.setNoPreSmoothSteps(pre);
+    crit.setNoPostSmoothSteps(post);
+    crit.setDefaultValuesIsotropic(3, zcells);
+
+    std::cout << "\t collapsing 2x2x" << zcells << " cells per level (3x3 blocks)" << std::endl;
+    copy = true;
+    return std::shared_ptr<type>(new type(*op, crit, args));
+  }
+};
+
 //! \brief A FastAMG 
 struct FastAMG {
   typedef Dune::Amg::FastAMG<Operator, Vector> type;
@@ -197,6 +255,54 @@ struct AMG2Level {
   }
 };
 
+#if defined(HAVE_MPI) && HAVE_MPI
+//! \brief Index information for operators distributed over processes
+typedef Dune::OwnerOverlapCopyCommunication<int,int> ParallelInformation;
+
+//! \brief A linear operator distributed over processes
+typedef Dune::OverlappingSchwarzOperator<Matrix,Vector,Vector,
+                                         ParallelInformation> ParallelOperator;
+
+//! \brief The scalar product of vectors distributed over processes
+typedef Dune::OverlappingSchwarzScalarProduct<Vector,
+                                              ParallelInformation> ParallelScalarProduct;
+
+//! \brief An AMG on a distributed operator
+//! \details The levels are smoothed with \a Smoother on the rows of each
+//!          process, with the copied rows updated from their owners.
+template<class Smoother>
+struct ParallelAMG {
+  //! \brief The smoother on the distributed levels
+  typedef Dune::BlockPreconditioner<Vector,Vector,
+                                    ParallelInformation,Smoother> ParallelSmoother;
+
+  typedef Dune::Amg::AMG<ParallelOperator, Vector,
+                         ParallelSmoother, ParallelInformation> type;
+
+  //! \brief Setup preconditioner
+  //! \param[in] pre The number of pre-smoothing steps
+  //! \param[in] post The number of post-smoothing steps
+  //! \param[in] target The coarsening target
+  //! \param[in] zcells The wanted number of cells to collapse in z per level
+  //! \param[in] op The distributed linear operator
+  //! \param[in] comm The index information of the operator
+  static std::shared_ptr<type>
+                setup(int pre, int post, int target, int zcells,
+                      ParallelOperator& op, ParallelInformation& comm)
+  {
+    typename AMG1<Smoother>::Criterion crit;
+    typename type::SmootherArgs args;
+    args.relaxationFactor = 1.0;
+    crit.setCoarsenTarget(target);
+    crit.setGamma(1);
+    crit.setNoPreSmoothSteps(pre);
+    crit.setNoPostSmoothSteps(post);
+    crit.setDefaultValuesIsotropic(3, zcells);
+    return std::shared_ptr<type>(new type(op, crit, args, comm));
+  }
+};
+#endif
+
 }
 }
 
@@ -20,6 +20,7 @@
 #include <dune/grid/common/mcmgmapper.hh>
 #include <dune/geometry/quadraturerules.hh>
 #include <dune/istl/ilu.hh>
+#include <dune/istl/matrixmarket.hh>
 #include <dune/istl/solvers.hh>
 #include <dune/istl/preconditioners.hh>
 #include <dune/grid/CpGrid.hpp>
@@ -28,6 +29,7 @@
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
 #include <opm/elasticity/asmhandler.hpp>
+#include <opm/elasticity/block_solver.hpp>
 #include <opm/elasticity/boundarygrid.hh>
 #include <opm/elasticity/elasticity.hpp>
 #include <opm/elasticity/elasticity_preconditioners.hpp>
@@ -45,6 +47,9 @@
 #include <opm/parser/eclipse/Parser/Parser.hpp>
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 
+#include <array>
+#include <unordered_map>
+
 namespace Opm {
 namespace Elasticity {
 
@@ -119,6 +124,10 @@ struct LinSolParams {
   //! \brief Preconditioner for mortar block
   MultiplierPreconditioner mortarpre;
 
+  //! \brief Assemble and solve the operator in 3x3 nodal blocks
+  //! \details Only used with MPC couplings and iterative solvers
+  bool block;
+
   //! \brief Parse command line parameters
   //! \param[in] param The parameter group to parse
   void parse(Opm::parameter::ParameterGroup& param)
@@ -166,6 +175,7 @@ struct LinSolParams {
 
     uzawa = param.getDefault<bool>("linsolver_uzawa", false);
     zcells = param.getDefault<int>("linsolver_zcells", 2);
+    block = param.getDefault<bool>("linsolver_block", false);
 
     solver = param.getDefault<std::string>("linsolver_smoother","ssor");
     if (solver == "schwarz")
@@ -241,7 +251,7 @@ class ElasticityUpscale
                       const std::string& file, const std::string& rocklist,
                       bool verbose_)
       :  A(gv_), gv(gv_), tol(tol_), Escale(Escale_), E(gv_), verbose(verbose_),
-         color(gv_)
+         color(gv_), maxCachedElements(10000), elemCacheTol(1.e-6)
     {
       if (rocklist.empty())
         loadMaterialsFromGrid(file);
@@ -273,9 +283,13 @@ class ElasticityUpscale
     //! \param[in] n2 The number of elements on the lambda grid in the Y direction
     //! \param[in] p1 The order of multipliers in the X direction
     //! \param[in] p2 The order of multipliers in the Y direction
+    //! \param[in] cachefile If non-empty, the coupling matrix is loaded from
+    //!                      this file when it matches the discretization,
+    //!                      otherwise it is assembled and stored there
     void periodicBCsMortar(const double* min,
                            const double* max, int n1, int n2,
-                           int p1, int p2);
+                           int p1, int p2,
+                           const std::string& cachefile="");
 
     //! \brief Fix corner nodes
     //! \param[in] min The minimum coordinates on the grid
@@ -287,6 +301,28 @@ class ElasticityUpscale
     //! \param[in] matrix Whether or not to assemble the matrix
     void assemble(int loadcase, bool matrix);
 
+    //! \brief Set the maximum number of cached element matrices
+    //! \details Cells with the same material and the same corner geometry
+    //!          (up to translation, see setElementCacheTolerance()) share
+    //!          their element matrices. Each entry uses about 6kB.
+    //!          Set to 0 to disable.
+    //!          Must be called before the first assemble().
+    //! \param[in] size The maximum number of cache entries
+    void setElementCacheSize(int size)
+    {
+      maxCachedElements = size;
+    }
+
+    //! \brief Set the tolerance for sharing cached element matrices
+    //! \details Corner coordinates are compared in units of this fraction
+    //!          of the smallest cell diameter. Must be called before the
+    //!          first assemble().
+    //! \param[in] reltol The relative tolerance
+    void setElementCacheTolerance(ctype reltol)
+    {
+      elemCacheTol = reltol;
+    }
+
     //! \brief Calculate the average stress vector for the given loadcase
     //! \param[out] sigma The stress vector
     //! \param[in] u The displacement vector
@@ -302,6 +338,41 @@ class ElasticityUpscale
     //! \param[in] params The linear solver parameters
     void setupSolvers(const LinSolParams& params);
 
+    //! \brief Assemble the operator in 3x3 nodal blocks
+    //! \details Must be called before the boundary conditions are
+    //!          established. Only supported with MPC couplings and
+    //!          iterative solvers.
+    //! \param[in] params The linear solver parameters
+    void setBlockAssembly(const LinSolParams& params)
+    {
+      if (params.type != ITERATIVE) {
+        std::cerr << "WARNING: block assembly requires an iterative solver, ignored" << std::endl;
+        return;
+      }
+      A.setBlockAssembly(true);
+    }
+
+#if defined(HAVE_MPI) && HAVE_MPI
+    //! \brief Distribute the assembly and the linear solves over processes
+    //! \details Must be called before the boundary conditions are
+    //!          established. Every process holds the grid and the MPC
+    //!          couplings, while the operator, the preconditioner and the
+    //!          system vectors are split, see ASMHandler::setPartition().
+    //!          Only MPC couplings and iterative solvers are supported,
+    //!          and the load cases must be solved one at a time. Does
+    //!          nothing on a single process.
+    //! \param[in] comm The communicator of the processes
+    void setCommunicator(MPI_Comm comm)
+    {
+      int rank, size;
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_size(comm, &size);
+      mpicomm = comm;
+      if (size > 1)
+        A.setPartition(rank, size);
+    }
+#endif
+
   private:
     //! \brief An iterator over grid vertices
     typedef typename GridType::LeafGridView::template Codim<dim>::Iterator LeafVertexIterator;
@@ -339,6 +410,64 @@ class ElasticityUpscale
     //! \brief Vector holding material parameters for each active grid cell
     std::vector< std::shared_ptr<Material> > materials;
 
+    //! \brief Number of basis functions in an element
+    static const int bfunc = 4+(dim-2)*4;
+
+    //! \brief An element stiffness matrix
+    typedef Dune::FieldMatrix<ctype,dim*bfunc,dim*bfunc> ElementMatrix;
+
+    //! \brief The element load vectors for unit strains (one column per load case)
+    typedef Dune::FieldMatrix<ctype,dim*bfunc,3+(dim-2)*3> ElementLoad;
+
+    //! \brief A cached element
+    struct CachedElement {
+      ElementMatrix K; //!< The stiffness matrix
+      ElementLoad L;   //!< The load vectors
+    };
+
+    //! \brief Key identifying cells with identical element matrices
+    struct ElementKey {
+      const Material* mat;  //!< The material of the cell
+      //! \brief Corner coordinates relative to the first corner, in units of
+      //!        the cache tolerance times the smallest cell diameter
+      std::array<long long,dim*(1<<dim)> x;
+
+      bool operator==(const ElementKey& other) const
+      {
+        return mat == other.mat && x == other.x;
+      }
+    };
+
+    //! \brief Hash for element keys
+    struct ElementKeyHash {
+      size_t operator()(const ElementKey& key) const
+      {
+        size_t h = std::hash<const Material*>()(key.mat);
+        for (size_t i=0;i<key.x.size();++i)
+          h ^= std::hash<long long>()(key.x[i]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+      }
+    };
+
+    //! \brief Compute the element matrices for a cell
+    //! \param[in] it Iterator pointing to the cell
+    //! \param[in] cell The cell index
+    //! \param[out] K If not NULL, the stiffness matrix
+    //! \param[out] L If not NULL, the load vectors for unit strains
+    //! \param[in] loadcase If not -1, only this column of L is computed
+    void elementMatrices(const LeafIterator& it, int cell,
+                         ElementMatrix* K, ElementLoad* L,
+                         int loadcase=-1);
+
+    //! \brief Group cells with identical element matrices and fill the cache
+    void setupElementCache();
+
+    //! \brief The cached element matrices
+    std::vector<CachedElement> elemCache;
+
+    //! \brief The cache entry for each cell, -1 if not cached
+    std::vector<int> elemCacheSlot;
+
     //! \brief Extract the vertices on a given face
     //! \param[in] dir The direction of the face normal
     //! \param[in] coord The coordinate of the face plane
@@ -416,6 +545,44 @@ class ElasticityUpscale
                               const BoundaryGrid& interface, int dir,
                               int n1, int n2, int colofs, double alpha=1.0);
 
+    //! \brief Describe the boundary discretization the mortar block depends on
+    //! \details Includes a hash of the vertices on the vertical sides and
+    //!          their equation numbers, so a different grid or MPC layout
+    //!          with the same sizes gives a different key.
+    //! \param[in] min The minimum coordinates of the grid
+    //! \param[in] max The maximum coordinates of the grid
+    //! \param[in] n1 The number of elements on the lambda grid in the X direction
+    //! \param[in] n2 The number of elements on the lambda grid in the Y direction
+    //! \param[in] p1 The order of multipliers in the X direction
+    //! \param[in] p2 The order of multipliers in the Y direction
+    std::string mortarCacheKey(const double* min, const double* max,
+                               int n1, int n2, int p1, int p2);
+
+    //! \brief Load the mortar coupling matrix from a cache file
+    //! \param[in] file The name of the cache file
+    //! \param[in] key The expected discretization key
+    //! \returns True if a matching matrix was loaded
+    bool loadMortarBlock(const std::string& file, const std::string& key);
+
+    //! \brief Store the mortar coupling matrix in a cache file
+    //! \details The matrix is written in binary to keep the values exact.
+    //! \param[in] file The name of the cache file
+    //! \param[in] key The discretization key
+    void storeMortarBlock(const std::string& file, const std::string& key);
+
+    //! \brief Setup the solvers for the 3x3 block operator
+    //! \param[in] params The linear solver parameters
+    //! \param[in] numsolvers The number of solvers (threads)
+    void setupBlockSolvers(const LinSolParams& params, int numsolvers);
+
+#if defined(HAVE_MPI) && HAVE_MPI
+    //! \brief Setup the solver for the distributed operator
+    //! \details CG with either a parallel AMG or a one-level additive
+    //!          Schwarz preconditioner with ILU0 on each process.
+    //! \param[in] params The linear solver parameters
+    void setupParallelSolver(const LinSolParams& params);
+#endif
+
     //! \brief This function loads and maps materials to active grid cells
     //! \param[in] file The eclipse grid to read materials from
     void loadMaterialsFromGrid(const std::string& file);
@@ -445,14 +612,21 @@ class ElasticityUpscale
     //! \brief Matrix adaptor for the elasticity block
     std::shared_ptr<Operator> op;
 
+    //! \brief Matrix adaptor for the 3x3 block elasticity operator
+    std::shared_ptr<BlockOperator> bop;
+
+    //! \brief The preconditioners for the 3x3 block operator
+    typedef std::shared_ptr<Dune::Preconditioner<BlockVector,BlockVector> > BlockPCPtr;
+    std::vector<BlockPCPtr> bpre;
+
     //! \brief Preconditioner for multiplier block
     typedef MortarBlockEvaluator<Dune::Preconditioner<Vector, Vector> > SchurPreconditioner;
 
     //! \brief Evaluator for multiplier block
     typedef MortarBlockEvaluator<Dune::InverseOperator<Vector, Vector> > SchurEvaluator;
 
-    //! \brief Outer evaluator, used with uzawa
-    std::shared_ptr<SchurEvaluator> op2;
+    //! \brief Outer evaluators, used with uzawa (one per thread)
+    std::vector<std::shared_ptr<SchurEvaluator> > op2;
 
     //! \brief The preconditioner for the elasticity operator
     std::vector<PCPtr> upre;
@@ -460,9 +634,9 @@ class ElasticityUpscale
     //! \brief An LU solve as a preconditioner
     typedef Dune::InverseOperator2Preconditioner<LUSolver,
                                         Dune::SolverCategory::sequential> SeqLU;
-    //! \brief The preconditioner for the multiplier block (used with uzawa)
-    std::shared_ptr<SeqLU> lpre;
-    std::shared_ptr<LUSolver> lprep;
+    //! \brief The preconditioners for the multiplier block (used with uzawa, one per thread)
+    std::vector<std::shared_ptr<SeqLU> > lpre;
+    std::vector<std::shared_ptr<LUSolver> > lprep;
 
     //! \brief Preconditioner for the Mortar system
     typedef std::shared_ptr< MortarSchurPre<PCType> > MortarAmgPtr;
@@ -479,6 +653,32 @@ class ElasticityUpscale
 
     //! \brief Mesh colorizer used with multithreaded assembly
     MeshColorizer<GridType> color;
+
+    //! \brief Maximum number of cached element matrices
+    int maxCachedElements;
+
+    //! \brief Relative tolerance for sharing cached element matrices
+    ctype elemCacheTol;
+
+#if defined(HAVE_MPI) && HAVE_MPI
+    //! \brief The communicator of the processes sharing the operator
+    MPI_Comm mpicomm;
+
+    //! \brief Index information for the distributed operator
+    std::shared_ptr<ParallelInformation> parinfo;
+
+    //! \brief Matrix adaptor for the distributed operator
+    std::shared_ptr<ParallelOperator> parop;
+
+    //! \brief Scalar product for the distributed vectors
+    std::shared_ptr<ParallelScalarProduct> parsp;
+
+    //! \brief The local solver of the Schwarz preconditioner
+    std::shared_ptr<ILUSmoother> parlocal;
+
+    //! \brief The preconditioner for the distributed operator
+    std::shared_ptr<Dune::Preconditioner<Vector,Vector> > parpre;
+#endif
 };
 
 }} // namespace Opm, Elasticity
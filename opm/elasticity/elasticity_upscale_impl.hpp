@@ -12,7 +12,13 @@
 #ifndef OPM_ELASTICITY_UPSCALE_IMPL_HPP
 #define OPM_ELASTICITY_UPSCALE_IMPL_HPP
 
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
 
 #ifdef HAVE_OPENMP
 #include <omp.h>
@@ -106,14 +112,12 @@ IMPL_FUNC(BoundaryGrid, extractMasterFace(Direction dir,
         q.v[2] = maxXmaxY(verts);
         q.v[3] = minXmaxY(verts);
       }
-      std::map<double, std::vector<BoundaryGrid::Quad> >::iterator it;
-      for (it  = nodeMap.begin(); it != nodeMap.end(); ++it) {
-        if (fabs(it->first-q.v[0].c[0]) < 1.e-7) {
-          it->second.push_back(q);
-          break;
-        }
-      }
-      if (it == nodeMap.end())
+      // the first key within tolerance of the coordinate, if any
+      std::map<double, std::vector<BoundaryGrid::Quad> >::iterator it =
+                                   nodeMap.upper_bound(q.v[0].c[0]-1.e-7);
+      if (it != nodeMap.end() && fabs(it->first-q.v[0].c[0]) < 1.e-7)
+        it->second.push_back(q);
+      else
         nodeMap[q.v[0].c[0]].push_back(q);
 
       result.add(q);
@@ -126,19 +130,24 @@ IMPL_FUNC(BoundaryGrid, extractMasterFace(Direction dir,
     for (size_t ii=0;ii<it->second.size();++ii)
       result.addToColumn(p,it->second[ii]);
   }
+  result.buildIndex();
 
   return result;
 }
 
 IMPL_FUNC(void, determineSideFaces(const double* min, const double* max))
 {
-  master.push_back(extractMasterFace(X,min[0]));
-  master.push_back(extractMasterFace(Y,min[1]));
-  master.push_back(extractMasterFace(Z,min[2]));
-
-  slave.push_back(extractFace(X,max[0]));
-  slave.push_back(extractFace(Y,max[1]));
-  slave.push_back(extractFace(Z,max[2]));
+  // the six faces are extracted independently
+  master.resize(3);
+  slave.resize(3);
+#pragma omp parallel for schedule(dynamic,1)
+  for (int k=0;k<6;++k) {
+    Direction dir = k%3 == 0 ? X : (k%3 == 1 ? Y : Z);
+    if (k < 3)
+      master[k] = extractMasterFace(dir,min[k]);
+    else
+      slave[k-3] = extractFace(dir,max[k-3]);
+  }
 }
 
 IMPL_FUNC(void, findBoundaries(double* min, double* max))
@@ -176,12 +185,19 @@ IMPL_FUNC(void, periodicPlane(Direction /*plane */,
                               const std::vector<BoundaryGrid::Vertex>& slavepointgrid,
                               const BoundaryGrid& mastergrid))
 {
-  for (size_t i=0;i<slavepointgrid.size();++i) {
-    BoundaryGrid::Vertex coord;
-    if (mastergrid.find(coord,slavepointgrid[i])) {
-      addMPC(X,slavepointgrid[i].i,coord);
-      addMPC(Y,slavepointgrid[i].i,coord);
-      addMPC(Z,slavepointgrid[i].i,coord);
+  // locate the slave points in parallel, then add the couplings in order
+  int n = slavepointgrid.size();
+  std::vector<BoundaryGrid::Vertex> coords(n);
+  std::vector<char> found(n);
+#pragma omp parallel for schedule(static)
+  for (int i=0;i<n;++i)
+    found[i] = mastergrid.find(coords[i],slavepointgrid[i]);
+
+  for (int i=0;i<n;++i) {
+    if (found[i]) {
+      addMPC(X,slavepointgrid[i].i,coords[i]);
+      addMPC(Y,slavepointgrid[i].i,coords[i]);
+      addMPC(Z,slavepointgrid[i].i,coords[i]);
     }
   }
 }
@@ -303,18 +319,26 @@ IMPL_FUNC(void, assembleBBlockMortar(const BoundaryGrid& b1,
   const Dune::QuadratureRule<ctype,2>& rule = 
                   Dune::QuadratureRules<ctype,2>::rule(gt,quadorder);
 
-  // do the assembly loop
-  typename Dune::QuadratureRule<ctype,2>::const_iterator r;
-  Dune::DynamicMatrix<ctype> E(ubasis.n,(n1+1)*(n2+1),0.0);
+  // do the assembly loop. the element matrices of a group of pillars are
+  // integrated in parallel, while the scatter into B is serial since
+  // pillars share both multiplier and primal DOFs
   LoggerHelper help(interface.size(), 5, 1000);
   for (int g=0;g<5;++g) {
-    for (int p=help.group(g).first;p<help.group(g).second;++p) {
+    int pstart = help.group(g).first;
+    int pend = help.group(g).second;
+    std::vector< std::vector<Dune::DynamicMatrix<ctype> > > Ep(pend-pstart);
+#pragma omp parallel for schedule(dynamic)
+    for (int p=pstart;p<pend;++p) {
       const BoundaryGrid::Quad& qi(interface[p]);
       HexGeometry<2,2,GridType> lg(qi);
+      std::vector<Dune::DynamicMatrix<ctype> >& Es = Ep[p-pstart];
+      Es.resize(b1.colSize(p),
+                Dune::DynamicMatrix<ctype>(ubasis.n,(n1+1)*(n2+1),0.0));
       for (size_t q=0;q<b1.colSize(p);++q) {
         const BoundaryGrid::Quad& qu = b1.getQuad(p,q);
         HexGeometry<2,2,GridType> hex(qu,gv,dir);
-        E = 0;
+        Dune::DynamicMatrix<ctype>& E = Es[q];
+        typename Dune::QuadratureRule<ctype,2>::const_iterator r;
         for (r = rule.begin(); r != rule.end();++r) {
           ctype detJ = hex.integrationElement(r->position());
           if (detJ < 0)
@@ -330,6 +354,13 @@ IMPL_FUNC(void, assembleBBlockMortar(const BoundaryGrid& b1,
             }
           }
         }
+      }
+    }
+
+    for (int p=pstart;p<pend;++p) {
+      for (size_t q=0;q<b1.colSize(p);++q) {
+        const BoundaryGrid::Quad& qu = b1.getQuad(p,q);
+        const Dune::DynamicMatrix<ctype>& E = Ep[p-pstart][q];
 
         // and assemble element contributions
         for (int d=0;d<3;++d) {
@@ -440,81 +471,209 @@ IMPL_FUNC(bool, isOnPoint(GlobalCoordinate coord,
   return delta.one_norm() < tol;
 }
 
-IMPL_FUNC(void, assemble(int loadcase, bool matrix))
+IMPL_FUNC(void, elementMatrices(const LeafIterator& it, int cell,
+                                ElementMatrix* K, ElementLoad* L,
+                                int loadcase))
 {
   const int comp = 3+(dim-2)*3;
-  static const int bfunc = 4+(dim-2)*4;
 
-  Dune::FieldVector<ctype,comp> eps0;
-  eps0 = 0;
-  if (loadcase > -1) {
-    eps0[loadcase] = 1;
-    b[loadcase] = 0;
+  Dune::FieldMatrix<ctype,comp,comp> C;
+  materials[cell]->getConstitutiveMatrix(C);
+  // determine geometry type of the current element and get the matching reference element
+  Dune::GeometryType gt = it->type();
+
+  ElementMatrix Aq;
+  if (K)
+    *K = 0;
+  if (L)
+    *L = 0;
+
+  // get a quadrature rule of order two for the given geometry type
+  const Dune::QuadratureRule<ctype,dim>& rule = Dune::QuadratureRules<ctype,dim>::rule(gt,2);
+  for (typename Dune::QuadratureRule<ctype,dim>::const_iterator r = rule.begin();
+      r != rule.end() ; ++r) {
+    // compute the jacobian inverse transposed to transform the gradients
+    Dune::FieldMatrix<ctype,dim,dim> jacInvTra =
+      it->geometry().jacobianInverseTransposed(r->position());
+
+    ctype detJ = it->geometry().integrationElement(r->position());
+    if (detJ <= 1.e-5 && verbose) {
+      std::cout << "cell " << cell << " is (close to) degenerated, detJ " << detJ << std::endl;
+      double zdiff=0.0;
+      for (int ii=0;ii<4;++ii)
+        zdiff = std::max(zdiff, it->geometry().corner(ii+4)[2]-it->geometry().corner(ii)[2]);
+      std::cout << " - Consider setting ctol larger than " << zdiff << std::endl;
+    }
+
+    Dune::FieldMatrix<ctype,comp,dim*bfunc> B;
+    E.getBmatrix(B,r->position(),jacInvTra);
+
+    if (K) {
+      E.getStiffnessMatrix(Aq,B,C,detJ*r->weight());
+      *K += Aq;
+    }
+
+    // load vectors, -B^T*C*eps0 for each (or the given) unit strain eps0
+    if (L) {
+      const int m0 = loadcase > -1 ? loadcase : 0;
+      const int m1 = loadcase > -1 ? loadcase+1 : comp;
+      for (int n=0;n<dim*bfunc;++n)
+        for (int m=m0;m<m1;++m) {
+          ctype val=0;
+          for (int q=0;q<comp;++q)
+            val += B[q][n]*C[q][m];
+          (*L)[n][m] -= val*detJ*r->weight();
+        }
+    }
+  }
+}
+
+IMPL_FUNC(void, setupElementCache())
+{
+  const int corners = 1 << dim;
+  const int cells = gv.size(0);
+  elemCacheSlot.assign(cells, -1);
+  if (maxCachedElements <= 0)
+    return;
+
+  // the corners are quantized relative to the smallest cell diameter,
+  // so cells matching within the cache tolerance share matrices.
+  // this is independent of the collapse tolerance, which may be raised
+  // for degenerate grids and must not merge cells of different shape.
+  const LeafIterator itend = gv.leafGridView().template end<0>();
+  ctype diam = std::numeric_limits<ctype>::max();
+  for (LeafIterator it = gv.leafGridView().template begin<0>(); it != itend; ++it) {
+    if (it->geometry().corners() != corners)
+      continue;
+    GlobalCoordinate x0 = it->geometry().corner(0);
+    ctype d2 = 0;
+    for (int c=1;c<corners;++c) {
+      GlobalCoordinate x = it->geometry().corner(c);
+      x -= x0;
+      d2 = std::max(d2, x.two_norm2());
+    }
+    if (d2 > 0)
+      diam = std::min(diam, std::sqrt(d2));
   }
+  if (diam == std::numeric_limits<ctype>::max())
+    return;
+  const ctype h = elemCacheTol*diam;
+
+  // group cells by key. the number of groups is bounded to keep the
+  // memory in check on irregular grids, later cells simply stay uncached.
+  const size_t maxGroups = 4*size_t(maxCachedElements);
+  std::unordered_map<ElementKey,int,ElementKeyHash> groups;
+  std::vector<int> group(cells, -1);
+  std::vector<int> count;
+  std::vector<LeafIterator> rep;
+  int cell=0;
+  for (LeafIterator it = gv.leafGridView().template begin<0>(); it != itend; ++it, ++cell) {
+    if (it->geometry().corners() != corners)
+      continue;
+    ElementKey key;
+    key.mat = materials[cell].get();
+    GlobalCoordinate x0 = it->geometry().corner(0);
+    for (int c=0;c<corners;++c) {
+      GlobalCoordinate x = it->geometry().corner(c);
+      for (int d=0;d<dim;++d)
+        key.x[c*dim+d] = std::llround((x[d]-x0[d])/h);
+    }
+    typename std::unordered_map<ElementKey,int,ElementKeyHash>::iterator g = groups.find(key);
+    if (g != groups.end()) {
+      group[cell] = g->second;
+      ++count[g->second];
+    } else if (groups.size() < maxGroups) {
+      group[cell] = count.size();
+      groups.insert(std::make_pair(key, int(count.size())));
+      count.push_back(1);
+      rep.push_back(it);
+    }
+  }
+
+  // cache the most frequent shared elements
+  std::vector<int> order;
+  for (size_t g=0;g<count.size();++g) {
+    if (count[g] > 1)
+      order.push_back(g);
+  }
+  std::sort(order.begin(), order.end(),
+            [&count](int a, int b) { return count[a] > count[b]; });
+  if (order.size() > size_t(maxCachedElements))
+    order.resize(maxCachedElements);
+
+  std::vector<int> slot(count.size(), -1);
+  std::vector<LeafIterator> slotRep;
+  for (size_t s=0;s<order.size();++s) {
+    slot[order[s]] = s;
+    slotRep.push_back(rep[order[s]]);
+  }
+  std::vector<int> slotCell(order.size());
+  int cached=0;
+  for (int c=0;c<cells;++c) {
+    if (group[c] > -1 && slot[group[c]] > -1) {
+      elemCacheSlot[c] = slot[group[c]];
+      slotCell[elemCacheSlot[c]] = c;
+      ++cached;
+    }
+  }
+
+  elemCache.resize(order.size());
+#pragma omp parallel for schedule(static)
+  for (size_t s=0;s<order.size();++s)
+    elementMatrices(slotRep[s], slotCell[s], &elemCache[s].K, &elemCache[s].L);
+
+  std::cout << "\telement cache: " << elemCache.size() << " matrices shared by "
+            << cached << " of " << cells << " cells, hit rate "
+            << (cells > 0 ? 100.0*(cached-int(elemCache.size()))/cells : 0.0)
+            << '%' << std::endl;
+}
+
+IMPL_FUNC(void, assemble(int loadcase, bool matrix))
+{
+  if (elemCacheSlot.empty())
+    setupElementCache();
+
+  if (loadcase > -1)
+    b[loadcase] = 0;
   if (matrix)
-    A.getOperator() = 0;
+    A.zeroOperator();
 
   for (int i=0;i<2;++i) {
     if (color[1].size() && matrix)
       std::cout << "\tprocessing " << (i==0?"red ":"black ") << "elements" << std::endl;
 #pragma omp parallel for schedule(static)
     for (size_t j=0;j<color[i].size();++j) {
-      Dune::FieldMatrix<ctype,comp,comp> C;
-      Dune::FieldMatrix<ctype,dim*bfunc,dim*bfunc> K;
-      Dune::FieldMatrix<ctype,dim*bfunc,dim*bfunc>* KP=0;
+      ElementMatrix K;
+      ElementLoad L;
       Dune::FieldVector<ctype,dim*bfunc> ES;
-      Dune::FieldVector<ctype,dim*bfunc>* EP=0;
-      if (matrix)
-        KP = &K;
-      if (loadcase > -1)
-        EP = &ES;
 
       for (size_t k=0;k<color[i][j].size();++k) {
+        const int cell = color[i][j][k];
+        if (!A.isActiveCell(cell))
+          continue;
         LeafIterator it = gv.leafGridView().template begin<0>();
-        for (int l=0;l<color[i][j][k];++l)
+        for (int l=0;l<cell;++l)
           ++it;
-        materials[color[i][j][k]]->getConstitutiveMatrix(C);
-        // determine geometry type of the current element and get the matching reference element
-        Dune::GeometryType gt = it->type();
-
-        Dune::FieldMatrix<ctype,dim*bfunc,dim*bfunc> Aq;
-        K = 0;
-        ES = 0;
-
-        // get a quadrature rule of order two for the given geometry type
-        const Dune::QuadratureRule<ctype,dim>& rule = Dune::QuadratureRules<ctype,dim>::rule(gt,2);
-        for (typename Dune::QuadratureRule<ctype,dim>::const_iterator r = rule.begin();
-            r != rule.end() ; ++r) {
-          // compute the jacobian inverse transposed to transform the gradients
-          Dune::FieldMatrix<ctype,dim,dim> jacInvTra =
-            it->geometry().jacobianInverseTransposed(r->position());
-
-          ctype detJ = it->geometry().integrationElement(r->position());
-          if (detJ <= 1.e-5 && verbose) {
-            std::cout << "cell " << color[i][j][k] << " is (close to) degenerated, detJ " << detJ << std::endl;
-            double zdiff=0.0;
-            for (int ii=0;ii<4;++ii)
-              zdiff = std::max(zdiff, it->geometry().corner(ii+4)[2]-it->geometry().corner(ii)[2]);
-            std::cout << " - Consider setting ctol larger than " << zdiff << std::endl;
-          }
-
-          Dune::FieldMatrix<ctype,comp,dim*bfunc> B;
-          E.getBmatrix(B,r->position(),jacInvTra);
 
-          if (matrix) {
-            E.getStiffnessMatrix(Aq,B,C,detJ*r->weight());
-            K += Aq;
-          }
+        const ElementMatrix* KP=0;
+        const ElementLoad* LP=0;
+        int slot = elemCacheSlot[cell];
+        if (slot > -1) {
+          KP = &elemCache[slot].K;
+          LP = &elemCache[slot].L;
+        } else {
+          elementMatrices(it, cell, matrix?&K:0, loadcase>-1?&L:0, loadcase);
+          KP = &K;
+          LP = &L;
+        }
 
-          // load vector
-          if (EP) {
-            Dune::FieldVector<ctype,dim*bfunc> temp;
-            temp = Dune::FMatrixHelp::multTransposed(B,Dune::FMatrixHelp::mult(C,eps0));
-            temp *= -detJ*r->weight();
-            ES += temp;
-          }
+        Dune::FieldVector<ctype,dim*bfunc>* EP=0;
+        if (loadcase > -1) {
+          for (int n=0;n<dim*bfunc;++n)
+            ES[n] = (*LP)[n][loadcase];
+          EP = &ES;
         }
-        A.addElement(KP,EP,it,(loadcase > -1)?&b[loadcase]:NULL);
+        A.addElement(matrix?KP:0,EP,it,(loadcase > -1)?&b[loadcase]:NULL);
       }
     }
   }
@@ -538,8 +697,10 @@ IMPL_FUNC(template<int comp> void,
   int m=0;
   sigma = 0;
   double volume=0;
-  for (LeafIterator it = gv.leafGridView().template begin<0>(); it != itend; ++it) {
-    materials[m++]->getConstitutiveMatrix(C);
+  for (LeafIterator it = gv.leafGridView().template begin<0>(); it != itend; ++it, ++m) {
+    if (!A.isOwnedCell(m))
+      continue;
+    materials[m]->getConstitutiveMatrix(C);
     // determine geometry type of the current element and get the matching reference element
     Dune::GeometryType gt = it->type();
 
@@ -567,6 +728,14 @@ IMPL_FUNC(template<int comp> void,
       sigma += s;
     }
   }
+#if defined(HAVE_MPI) && HAVE_MPI
+  // each process integrated the cells it owns
+  if (A.isPartitioned()) {
+    Dune::CollectiveCommunication<MPI_Comm> cc(mpicomm);
+    cc.sum(&sigma[0], comp);
+    volume = cc.sum(volume);
+  }
+#endif
   sigma /= volume;
   if (Escale > 0)
     sigma /= Escale/Emin;
@@ -817,10 +986,129 @@ IMPL_FUNC(void, periodicBCs(const double* min, const double* max))
   periodicPlane(Z,XYZ,slave[2],master[2]);
 }
 
+IMPL_FUNC(std::string, mortarCacheKey(const double* min,
+                                      const double* max,
+                                      int n1, int n2,
+                                      int p1, int p2))
+{
+  // B depends on the vertices on the vertical sides and on the equation
+  // numbers of their DOFs (which shift with the MPC/fixed layout), so the
+  // indices, exact coordinates and equation numbers are hashed (FNV-1a)
+  // into the key
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](const void* data, size_t len) {
+    const unsigned char* c = static_cast<const unsigned char*>(data);
+    for (size_t i=0;i<len;++i)
+      hash = (hash ^ c[i])*1099511628211ULL;
+  };
+  Dune::LeafMultipleCodimMultipleGeomTypeMapper<GridType,
+                                            Dune::MCMGVertexLayout> mapper(gv);
+  const LeafVertexIterator itend = gv.leafGridView().template end<dim>();
+  for (LeafVertexIterator it = gv.leafGridView().template begin<dim>();
+       it != itend; ++it) {
+    GlobalCoordinate c = it->geometry().corner(0);
+    if (isOnPlane(X,c,min[0]) || isOnPlane(X,c,max[0]) ||
+        isOnPlane(Y,c,min[1]) || isOnPlane(Y,c,max[1])) {
+      int idx = mapper.map(*it);
+      mix(&idx, sizeof(idx));
+      for (int d=0;d<dim;++d) {
+        double x = c[d];
+        mix(&x, sizeof(x));
+        int eq = A.getEquationForDof(idx,d);
+        mix(&eq, sizeof(eq));
+      }
+    }
+  }
+
+  std::stringstream str;
+  str << std::setprecision(17) << gv.size(0) << " " << gv.size(dim) << " "
+      << A.getEqns() << " " << n1 << " " << n2 << " " << p1 << " " << p2;
+  for (int i=0;i<3;++i)
+    str << " " << min[i] << " " << max[i];
+  str << " " << std::hex << hash;
+
+  return str.str();
+}
+
+IMPL_FUNC(bool, loadMortarBlock(const std::string& file,
+                                const std::string& key))
+{
+  std::ifstream f((file+".key").c_str());
+  std::string stored;
+  if (!f || !std::getline(f,stored) || stored != key)
+    return false;
+
+  std::ifstream in(file.c_str(), std::ios::binary);
+  int size[3]; // rows, columns, nonzeros
+  if (!in.read(reinterpret_cast<char*>(size), sizeof(size)) ||
+      size[0] != A.getEqns() || size[1] < 0 || size[2] < 0)
+    return false;
+  std::vector<int> rowsize(size[0]), cols(size[2]);
+  std::vector<double> vals(size[2]);
+  in.read(reinterpret_cast<char*>(rowsize.data()), size[0]*sizeof(int));
+  in.read(reinterpret_cast<char*>(cols.data()), size[2]*sizeof(int));
+  in.read(reinterpret_cast<char*>(vals.data()), size[2]*sizeof(double));
+  if (!in)
+    return false;
+  for (size_t k=0;k<cols.size();++k) {
+    if (cols[k] < 0 || cols[k] >= size[1])
+      return false;
+  }
+
+  B.setSize(size[0], size[1], size[2]);
+  B.setBuildMode(Matrix::random);
+  for (int i=0;i<size[0];++i)
+    B.setrowsize(i,rowsize[i]);
+  B.endrowsizes();
+  size_t k=0;
+  for (int i=0;i<size[0];++i) {
+    for (int j=0;j<rowsize[i];++j)
+      B.addindex(i,cols[k++]);
+  }
+  B.endindices();
+
+  // the columns were stored in the sorted order of the matrix
+  k=0;
+  for (Matrix::RowIterator row = B.begin(); row != B.end(); ++row) {
+    for (Matrix::ColIterator col = row->begin(); col != row->end(); ++col)
+      *col = vals[k++];
+  }
+
+  return true;
+}
+
+IMPL_FUNC(void, storeMortarBlock(const std::string& file,
+                                 const std::string& key))
+{
+  // binary, so that runs reusing the cache see exactly the assembled values
+  std::vector<int> rowsize, cols;
+  std::vector<double> vals;
+  const Matrix& Bc = B;
+  for (Matrix::ConstRowIterator row = Bc.begin(); row != Bc.end(); ++row) {
+    rowsize.push_back(row->size());
+    for (Matrix::ConstColIterator col = row->begin(); col != row->end(); ++col) {
+      cols.push_back(col.index());
+      vals.push_back(*col);
+    }
+  }
+  int size[3] = {int(B.N()), int(B.M()), int(cols.size())};
+  std::ofstream out(file.c_str(), std::ios::binary);
+  out.write(reinterpret_cast<const char*>(size), sizeof(size));
+  out.write(reinterpret_cast<const char*>(rowsize.data()), rowsize.size()*sizeof(int));
+  out.write(reinterpret_cast<const char*>(cols.data()), cols.size()*sizeof(int));
+  out.write(reinterpret_cast<const char*>(vals.data()), vals.size()*sizeof(double));
+  out.close();
+
+  // the key is written last, so an interrupted store is not picked up
+  std::ofstream f((file+".key").c_str());
+  f << key << std::endl;
+}
+
 IMPL_FUNC(void, periodicBCsMortar(const double* min, 
                                   const double* max,
                                   int n1, int n2,
-                                  int p1, int p2))
+                                  int p1, int p2,
+                                  const std::string& cachefile))
 {
   // this method
   // 1. fixes the primal corner dofs
@@ -847,15 +1135,26 @@ IMPL_FUNC(void, periodicBCsMortar(const double* min,
   std::cout << "\tinitializing matrix..." << std::endl;
   A.initForAssembly();
 
+  // B only depends on the geometry and the multiplier grids, so it can
+  // be reused when only the materials change
+  std::string key;
+  if (!cachefile.empty()) {
+    key = mortarCacheKey(min,max,n1,n2,p1,p2);
+    if (loadMortarBlock(cachefile,key)) {
+      std::cout << "\tloaded mortar matrix from " << cachefile << std::endl;
+      slave.clear();
+      return;
+    }
+  }
+
   // step 3
-  std::cout << "\treconstructing left face..." << std::endl;
-  master.push_back(extractMasterFace(X, min[0], LEFT, true));
-  std::cout << "\treconstructing right face..." << std::endl;
-  master.push_back(extractMasterFace(X, max[0], RIGHT, true));
-  std::cout << "\treconstructing front face..." << std::endl;
-  master.push_back(extractMasterFace(Y, min[1], LEFT, true));
-  std::cout << "\treconstructing back face..." << std::endl;
-  master.push_back(extractMasterFace(Y, max[1], RIGHT, true));
+  std::cout << "\treconstructing left/right/front/back faces..." << std::endl;
+  master.resize(4);
+#pragma omp parallel for schedule(dynamic,1)
+  for (int k=0;k<4;++k) {
+    master[k] = extractMasterFace(k < 2 ? X : Y, k%2 ? max[k/2] : min[k/2],
+                                  k%2 ? RIGHT : LEFT, true);
+  }
 
   std::cout << "\testablished YZ multiplier grid with " << n2 << "x1" << " elements" << std::endl;
 
@@ -888,6 +1187,11 @@ IMPL_FUNC(void, periodicBCsMortar(const double* min,
   assembleBBlockMortar(master[2], lambday, 1, 1, p1, eqns);
   assembleBBlockMortar(master[3], lambday, 1, 1, p1, eqns, -1.0);
 
+  if (!cachefile.empty()) {
+    std::cout << "\tstoring mortar matrix in " << cachefile << std::endl;
+    storeMortarBlock(cachefile,key);
+  }
+
   master.clear();
   slave.clear();
 }
@@ -908,15 +1212,130 @@ static void applyMortarBlock(int i, const Matrix& B, M& T,
     T[j][i] = v2[j];
 }
 
+  template<class Smoother>
+static void setupBlockAMG(const LinSolParams& params,
+                          std::shared_ptr<BlockOperator>& op, int numsolvers,
+                          std::vector<std::shared_ptr<Dune::Preconditioner<BlockVector,BlockVector> > >& pre)
+{
+  bool copy;
+  std::shared_ptr<typename BlockAMG<Smoother>::type> amg =
+    BlockAMG<Smoother>::setup(params.steps[0], params.steps[1],
+                              params.coarsen_target, params.zcells,
+                              op, copy);
+  pre.push_back(amg);
+  for (int i=1;i<numsolvers;++i) {
+    if (copy)
+      pre.push_back(std::shared_ptr<typename BlockAMG<Smoother>::type>(new typename BlockAMG<Smoother>::type(*amg)));
+    else
+      pre.push_back(amg);
+  }
+}
+
+IMPL_FUNC(void, setupBlockSolvers(const LinSolParams& params, int numsolvers))
+{
+  if (B.N()) {
+    std::cerr << "Block assembly is not supported with mortar couplings" << std::endl;
+    exit(1);
+  }
+  if (params.pre != AMG)
+    std::cout << "\tblock operator: using AMG preconditioner" << std::endl;
+
+  bop.reset(new BlockOperator(A.getBlockOperator()));
+  if (params.smoother == SMOOTH_JACOBI)
+    setupBlockAMG<BlockJACSmoother>(params, bop, numsolvers, bpre);
+  else if (params.smoother == SMOOTH_ILU)
+    setupBlockAMG<BlockILUSmoother>(params, bop, numsolvers, bpre);
+  else {
+    if (params.smoother == SMOOTH_SCHWARZ)
+      std::cerr << "WARNING: Schwarz smoother not available for block operator, using SSOR" << std::endl;
+    setupBlockAMG<BlockSSORSmoother>(params, bop, numsolvers, bpre);
+  }
+
+  for (int i=0;i<numsolvers;++i) {
+    typename BlockSolverAdapter<ASMHandler<GridType> >::OperatorPtr
+      solver(new Dune::CGSolver<BlockVector>(*bop, *bpre[i], params.tol,
+                                             params.maxit,
+                                             verbose?2:(params.report?1:0)));
+    tsolver.push_back(SolverPtr(new BlockSolverAdapter<ASMHandler<GridType> >(solver, A)));
+  }
+}
+
+#if defined(HAVE_MPI) && HAVE_MPI
+IMPL_FUNC(void, setupParallelSolver(const LinSolParams& params))
+{
+  if (B.N() || params.type != ITERATIVE) {
+    std::cerr << "Distributed solves are only supported with MPC couplings "
+              << "and iterative solvers" << std::endl;
+    exit(1);
+  }
+
+  // the global equation numbers identify the rows shared between the
+  // processes. copied rows are identities, updated from their owners.
+  typedef Dune::ParallelLocalIndex<Dune::OwnerOverlapCopyAttributeSet::AttributeSet> LocalIndex;
+  parinfo.reset(new ParallelInformation(mpicomm));
+  const std::vector<int>& geqn = A.getGlobalEqns();
+  parinfo->indexSet().beginResize();
+  for (size_t i=0;i<geqn.size();++i)
+    parinfo->indexSet().add(geqn[i],
+                            LocalIndex(i, A.isOwnedEqn(i) ?
+                                          Dune::OwnerOverlapCopyAttributeSet::owner :
+                                          Dune::OwnerOverlapCopyAttributeSet::copy,
+                                       true));
+  parinfo->indexSet().endResize();
+  parinfo->remoteIndices().template rebuild<false>();
+
+  parop.reset(new ParallelOperator(A.getOperator(), *parinfo));
+  parsp.reset(new ParallelScalarProduct(*parinfo));
+  if (params.pre == SCHWARZ) {
+    parlocal.reset(new ILUSmoother(A.getOperator(), 1.0));
+    parpre.reset(new Dune::BlockPreconditioner<Vector,Vector,ParallelInformation,
+                                               ILUSmoother>(*parlocal, *parinfo));
+  } else {
+    if (params.pre != AMG)
+      std::cout << "\tdistributed operator: using AMG preconditioner" << std::endl;
+    if (params.smoother == SMOOTH_JACOBI)
+      parpre = ParallelAMG<JACSmoother>::setup(params.steps[0], params.steps[1],
+                                               params.coarsen_target, params.zcells,
+                                               *parop, *parinfo);
+    else if (params.smoother == SMOOTH_ILU)
+      parpre = ParallelAMG<ILUSmoother>::setup(params.steps[0], params.steps[1],
+                                               params.coarsen_target, params.zcells,
+                                               *parop, *parinfo);
+    else {
+      if (params.smoother == SMOOTH_SCHWARZ)
+        std::cerr << "WARNING: Schwarz smoother not available for distributed operator, using SSOR" << std::endl;
+      parpre = ParallelAMG<SSORSmoother>::setup(params.steps[0], params.steps[1],
+                                                params.coarsen_target, params.zcells,
+                                                *parop, *parinfo);
+    }
+  }
+
+  tsolver.push_back(SolverPtr(new Dune::CGSolver<Vector>(*parop, *parsp, *parpre,
+                                                         params.tol, params.maxit,
+                                                         verbose?2:(params.report?1:0))));
+}
+#endif
+
 IMPL_FUNC(void, setupSolvers(const LinSolParams& params))
 {
-  int siz = A.getOperator().N(); // system size
+#if defined(HAVE_MPI) && HAVE_MPI
+  if (A.isPartitioned()) {
+    setupParallelSolver(params);
+    for (int i=0;i<6;++i)
+      b[i].resize(A.getOperator().N());
+    return;
+  }
+#endif
+
+  int siz = A.isBlocked() ? A.getEqns() : A.getOperator().N(); // system size
   int numsolvers = 1;
 #ifdef HAVE_OPENMP
    numsolvers = omp_get_max_threads();
 #endif
-          
-  if (params.type == ITERATIVE) {
+
+  if (A.isBlocked()) {
+    setupBlockSolvers(params, numsolvers);
+  } else if (params.type == ITERATIVE) {
     op.reset(new Operator(A.getOperator()));
     bool copy;
     upre.push_back(PC::setup(params.steps[0], params.steps[1],
@@ -1007,19 +1426,26 @@ IMPL_FUNC(void, setupSolvers(const LinSolParams& params))
       }
 
       if (params.uzawa) {
-        std::shared_ptr<Dune::InverseOperator<Vector,Vector> > innersolver;
-
-        innersolver.reset(new Dune::CGSolver<Vector>(*op, *upre[0], params.tol,
-                                                     params.maxit,
-                                                     verbose?2:(params.report?1:0)));
-        op2.reset(new SchurEvaluator(*innersolver, B));
-        lprep.reset(new LUSolver(P));
-        lpre.reset(new SeqLU(*lprep));
-        std::shared_ptr<Dune::InverseOperator<Vector,Vector> > outersolver;
-        outersolver.reset(new Dune::CGSolver<Vector>(*op2, *lpre, params.tol*10,
-                                                     params.maxit,
-                                                     verbose?2:(params.report?1:0)));
-        tsolver.push_back(SolverPtr(new UzawaSolver<Vector, Vector>(innersolver, outersolver, B)));
+        // one complete uzawa scheme per thread. the AMG copies share
+        // the hierarchy with upre[0]
+        for (int i=0;i<numsolvers;++i) {
+          if (copy && i != 0)
+            upre.push_back(PCPtr(new PCType(*upre[0])));
+          std::shared_ptr<Dune::InverseOperator<Vector,Vector> > innersolver;
+          innersolver.reset(new Dune::CGSolver<Vector>(*op, *upre[copy?i:0],
+                                                       params.tol,
+                                                       params.maxit,
+                                                       verbose?2:(params.report?1:0)));
+          op2.push_back(std::shared_ptr<SchurEvaluator>(new SchurEvaluator(*innersolver, B)));
+          lprep.push_back(std::shared_ptr<LUSolver>(new LUSolver(P)));
+          lpre.push_back(std::shared_ptr<SeqLU>(new SeqLU(*lprep.back())));
+          std::shared_ptr<Dune::InverseOperator<Vector,Vector> > outersolver;
+          outersolver.reset(new Dune::CGSolver<Vector>(*op2.back(), *lpre.back(),
+                                                       params.tol*10,
+                                                       params.maxit,
+                                                       verbose?2:(params.report?1:0)));
+          tsolver.push_back(SolverPtr(new UzawaSolver<Vector, Vector>(innersolver, outersolver, B)));
+        }
       } else {
         for (int i=0;i<numsolvers;++i) {
           if (copy && i != 0)
@@ -1087,7 +1513,14 @@ IMPL_FUNC(void, solve(int loadcase))
 
     tsolver[solver]->apply(u[loadcase], b[loadcase], r);
 
-    std::cout << "\tsolution norm: " << u[loadcase].two_norm() << std::endl;
+    double norm = u[loadcase].two_norm();
+#if defined(HAVE_MPI) && HAVE_MPI
+    if (A.isPartitioned()) {
+      parinfo->copyOwnerToAll(u[loadcase], u[loadcase]);
+      norm = parsp->norm(u[loadcase]);
+    }
+#endif
+    std::cout << "\tsolution norm: " << norm << std::endl;
   } catch (Dune::ISTLError& e) {
     std::cerr << "exception thrown " << e << std::endl;
   }
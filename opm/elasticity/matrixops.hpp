@@ -32,6 +32,12 @@ typedef std::vector< std::set<int> > AdjacencyPattern;
 //! \brief A vector holding our RHS
 typedef Dune::BlockVector<Dune::FieldVector<double,1> > Vector;
 
+//! \brief A sparse matrix holding our operator with 3x3 (nodal) blocks
+typedef Dune::BCRSMatrix<Dune::FieldMatrix<double,3,3> > BlockMatrix;
+
+//! \brief A vector with 3 components (one node) per block
+typedef Dune::BlockVector<Dune::FieldVector<double,3> > BlockVector;
+
 //! \brief Helper class with some matrix operations
 class MatrixOps {
   public:
@@ -18,7 +18,9 @@ namespace Opm {
   namespace Elasticity {
 
 /*! Template implementing an Uzawa scheme (block Gaussian-elimination) for
- *  a (symmetric indefinite) saddle-point system */
+ *  a (symmetric indefinite) saddle-point system.
+ *  All temporaries are local to apply(), so instances with separate inner
+ *  and outer solvers may be applied concurrently (one per thread). */
 
   template<class X, class Y>
 class UzawaSolver : public Dune::InverseOperator<X,Y>
@@ -24,6 +24,7 @@
 #include <opm/porsol/blackoil/fluid/FluidMatrixInteractionBlackoil.hpp>
 #include <opm/porsol/blackoil/fluid/FluidStateBlackoil.hpp>
 #include <opm/porsol/blackoil/fluid/BlackoilPVT.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <dune/common/fvector.hh>
 #include <vector>
 
@@ -38,23 +39,39 @@ namespace Opm
 
     /// Class responsible for computing all fluid properties from
     /// face pressures and composition.
-    class BlackoilFluid : public BlackoilDefs
+    /// \tparam PVT  the PVT model, such as BlackoilPVT or BlackoilCo2PVT.
+    template <class PVT>
+    class BasicBlackoilFluid : public BlackoilDefs
     {
     public:
         typedef FluidStateBlackoil FluidState;
         typedef BlackoilFluidData FluidData;
 
         void init(const Opm::Deck& deck)
+        {
+            initCommon(deck);
+            pvt_.init(deck);
+        }
+
+        /// As init(deck), passing param on to the PVT for its options.
+        void init(const Opm::Deck& deck, const parameter::ParameterGroup& param)
+        {
+            initCommon(deck);
+            pvt_.init(deck, param);
+        }
+
+    private:
+        void initCommon(const Opm::Deck& deck)
         {
             fmi_params_.init(deck);
             // FluidSystemBlackoil<>::init(parser);
-            pvt_.init(deck);
             const auto& densityRecord = deck.getKeyword("DENSITY").getRecord(0);
             surface_densities_[Oil] = densityRecord.getItem("OIL").getSIDouble(0);
             surface_densities_[Water] = densityRecord.getItem("WATER").getSIDouble(0);
             surface_densities_[Gas] = densityRecord.getItem("GAS").getSIDouble(0);
         }
 
+    public:
         FluidState computeState(PhaseVec phase_pressure, CompVec z) const
         {
             FluidState state;
@@ -133,9 +150,7 @@ namespace Opm
             std::vector<PhaseVec>& R = states.solution_factor;
             std::vector<PhaseVec>& dR = states.solution_factor_deriv;
             std::vector<PhaseVec>& mu = states.viscosity;
-            pvt_.dBdp(p, z, B, dB);
-            pvt_.dRdp(p, z, R, dR);
-            pvt_.getViscosity(p, z, mu);
+            pvt_.evalAll(p, z, B, dB, R, dR, mu);
         }
 
         /// Input: B, R
@@ -251,7 +266,7 @@ namespace Opm
 
 
     private:
-        BlackoilPVT pvt_;
+        PVT pvt_;
         FluidMatrixInteractionBlackoilParams<double> fmi_params_;
         CompVec surface_densities_;
 
@@ -377,6 +392,10 @@ namespace Opm
     };
 
 
+    /// The fluid with the Eclipse black-oil PVT tables.
+    typedef BasicBlackoilFluid<BlackoilPVT> BlackoilFluid;
+
+
 
     struct FaceFluidData : public BlackoilDefs
     {
@@ -413,10 +432,10 @@ namespace Opm
         FaceFluidData face_data;
 
     public:
-        template <class Grid, class Rock>
+        template <class Grid, class Rock, class Fluid>
         void computeNew(const Grid& grid,
                         const Rock& rock,
-                        const BlackoilFluid& fluid,
+                        const Fluid& fluid,
                         const typename Grid::Vector gravity,
                         const std::vector<PhaseVec>& cell_pressure,
                         const std::vector<PhaseVec>& face_pressure,
@@ -462,9 +481,9 @@ namespace Opm
         }
 
 
-        template <class Grid>
+        template <class Grid, class Fluid>
         void computeUpwindProperties(const Grid& grid,
-                                     const BlackoilFluid& fluid,
+                                     const Fluid& fluid,
                                      const typename Grid::Vector gravity,
                                      const std::vector<PhaseVec>& cell_pressure,
                                      const std::vector<PhaseVec>& face_pressure,
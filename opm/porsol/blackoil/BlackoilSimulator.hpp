@@ -134,7 +134,7 @@ init(const Opm::parameter::ParameterGroup& param)
         double perm_threshold_md = param.getDefault("perm_threshold_md", 0.0);
         double perm_threshold = Opm::unit::convert::from(perm_threshold_md, Opm::prefix::milli*Opm::unit::darcy);
         rock_.init(deck, grid_.globalCell(), perm_threshold);
-        fluid_.init(deck);
+        fluid_.init(deck, param);
         wells_.init(deck, grid_, rock_);
     } else if (fileformat == "cartesian") {
         std::array<int, 3> dims = {{ param.getDefault<int>("nx", 1),
@@ -153,7 +153,7 @@ init(const Opm::parameter::ParameterGroup& param)
         Opm::ParseContext parseContext;
         Opm::Parser parser;
         auto deck = parser.parseFile(param.get<std::string>("filename") , parseContext);
-        fluid_.init(deck);
+        fluid_.init(deck, param);
         wells_.init(deck, grid_, rock_);
     } else {
         OPM_THROW(std::runtime_error, "Unknown file format string: " << fileformat);
@@ -184,7 +184,7 @@ private: // Data
         template <class G, class R>
         void computeNew(const G& grid,
                         const R& rock,
-                        const BlackoilFluid& fluid,
+                        const Fluid& fluid,
                         const typename Grid::Vector gravity,
                         const std::vector<PhaseVec>& cell_pressure,
                         const std::vector<PhaseVec>& face_pressure,
@@ -232,7 +232,7 @@ private: // Methods
     TransportFluidData computeProps(const PhaseVec& pressure,
                                     const CompVec& composition)
     {
-        BlackoilFluid::FluidState state = pfluid_->computeState(pressure, composition);
+        typename Fluid::FluidState state = pfluid_->computeState(pressure, composition);
         TransportFluidData data;
         data.saturation = state.saturation_;
         data.mobility = state.mobility_;
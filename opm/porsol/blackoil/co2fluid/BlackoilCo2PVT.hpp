@@ -19,7 +19,6 @@
 
 #ifndef OPM_BLACKOILCO2PVT_HEADER_INCLUDED
 #define OPM_BLACKOILCO2PVT_HEADER_INCLUDED
-#define OPM_BLACKOILPVT_HEADER_INCLUDED
 
 #define OPM_DEPRECATED __attribute__((deprecated))
 #define OPM_DEPRECATED_MSG(msg) __attribute__((deprecated))
@@ -36,12 +35,19 @@
 #include <opm/porsol/blackoil/fluid/BlackoilDefs.hpp>
 
 #include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
 
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <vector>
+#include <cmath>
+#include <limits>
 
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
 
 namespace Opm
 {
@@ -51,9 +57,23 @@ public:
         
     typedef Opm::FluidSystems::BrineCO2</*Scalar=*/double, Opm::Benchmark3::CO2Tables> FluidSystem;
     typedef Opm::CompositionalFluidState<double, FluidSystem> CompositionalFluidState;
-	
+
+    BlackoilCo2PVT();
+
 	void init(const Opm::Deck& deck);
 
+    /// As init(deck), and builds the state table of tabulateStates() if
+    /// the parameter co2_state_table is true.
+    void init(const Opm::Deck& deck, const parameter::ParameterGroup& param);
+
+    /// Precompute phase states at the current temperature on a grid of
+    /// num_p pressures in [p_min, p_max]. In the one-phase regions
+    /// num_x compositions are used between the pure and the saturated
+    /// phase, so that the phase boundaries are grid lines. States for
+    /// pressures in the table range are then interpolated instead of
+    /// flashed; other pressures still use the flash.
+    void tabulateStates(double p_min, double p_max, int num_p, int num_x);
+
     void generateBlackOilTables(double temperature);
 
     double getViscosity(double press,
@@ -93,6 +113,13 @@ public:
               const std::vector<CompVec>& surfvol,
               std::vector<PhaseVec>& output_R,
               std::vector<PhaseVec>& output_dRdp) const;
+    void evalAll(const std::vector<PhaseVec>& pressures,
+                 const std::vector<CompVec>& surfvol,
+                 std::vector<PhaseVec>& output_B,
+                 std::vector<PhaseVec>& output_dBdp,
+                 std::vector<PhaseVec>& output_R,
+                 std::vector<PhaseVec>& output_dRdp,
+                 std::vector<PhaseVec>& output_mu) const;
 
 private:
 	CompVec surfaceDensities_;
@@ -107,6 +134,54 @@ private:
         double saturation;
     };
     void computeState(SubState& ss, double zBrine, double zCO2, double pressure) const;
+    // Uses the state table if use_table is true and the table covers the
+    // state, otherwise computeState().
+    void evalState(SubState& ss, double zBrine, double zCO2, double pressure, bool use_table) const;
+    bool interpolateState(SubState& ss, double zBrine, double zCO2, double pressure) const;
+    bool inStateTable(double pressure) const;
+    // For the single-value methods, which are typically called for the same
+    // state several times in a row. Inside an OpenMP parallel region the
+    // memo is bypassed.
+    void memoState(SubState& ss, double zBrine, double zCO2, double pressure, bool use_table) const;
+    void clearStateCaches();
+    double phaseB(const SubState& ss, PhaseIndex phase) const;
+    double phaseR(const SubState& ss, PhaseIndex phase) const;
+
+    // Tabulated density, massfrac[wPhase][nComp], massfrac[nPhase][wComp]
+    // and viscosity of both phases.
+    struct TabState
+    {
+        double density[2];
+        double massfrac_wn;
+        double massfrac_nw;
+        double viscosity[2];
+    };
+    void setTabState(TabState& ts, const SubState& ss) const;
+    struct StateTable
+    {
+        double p_min;
+        double p_max;
+        double dp;
+        int num_p;
+        int num_x;
+        // CO2 mass fraction of saturated liquid and gas, per pressure.
+        std::vector<double> xi_w;
+        std::vector<double> xi_n;
+        // Per pressure: the two-phase state, num_x liquid-only states and
+        // num_x gas-only states.
+        std::vector<TabState> states;
+    };
+    StateTable table_;
+    struct Memo
+    {
+        double zBrine;
+        double zCO2;
+        double pressure;
+        bool use_table;
+        SubState ss;
+    };
+    mutable Memo memo_[2];
+    mutable int memo_next_;
     enum {
         wPhase = FluidSystem::liquidPhaseIdx,
         nPhase = FluidSystem::gasPhaseIdx,
@@ -119,6 +194,12 @@ private:
 
 // ------------ Method implementations --------------
 
+BlackoilCo2PVT::BlackoilCo2PVT()
+    : temperature_(300.), memo_next_(0)
+{
+    clearStateCaches();
+}
+
 void BlackoilCo2PVT::init(const Opm::Deck& /* deck */)
 {
 	surfaceDensities_[Water]   = 1000.;
@@ -126,10 +207,66 @@ void BlackoilCo2PVT::init(const Opm::Deck& /* deck */)
 	surfaceDensities_[Oil] = 1000.;
 
     temperature_ = 300.;
+    clearStateCaches();
 
     brineCo2_.init();
 }
 
+void BlackoilCo2PVT::init(const Opm::Deck& deck, const parameter::ParameterGroup& param)
+{
+    init(deck);
+    if (param.getDefault("co2_state_table", false)) {
+        tabulateStates(param.getDefault("co2_table_p_min", 1.0e5),
+                       param.getDefault("co2_table_p_max", 5.0e7),
+                       param.getDefault("co2_table_num_p", 500),
+                       param.getDefault("co2_table_num_x", 21));
+    }
+}
+
+void BlackoilCo2PVT::tabulateStates(double p_min, double p_max, int num_p, int num_x)
+{
+    if (!(p_max > p_min) || num_p < 2 || num_x < 2) {
+        OPM_THROW(std::runtime_error, "Invalid CO2 state table: p in [" << p_min << ", " << p_max
+                  << "], num_p = " << num_p << ", num_x = " << num_x);
+    }
+    clearStateCaches();
+    StateTable table;
+    table.p_min = p_min;
+    table.p_max = p_max;
+    table.dp = (p_max - p_min)/(num_p - 1);
+    table.num_p = num_p;
+    table.num_x = num_x;
+    table.xi_w.resize(num_p);
+    table.xi_n.resize(num_p);
+    table.states.resize(num_p*(1 + 2*num_x));
+    // Surface volumes of a unit mass with CO2 mass fraction xi.
+    const double rho_brine = surfaceDensities_[Oil];
+    const double rho_co2 = surfaceDensities_[Gas];
+    SubState ss;
+    for (int i = 0; i < num_p; ++i) {
+        const double p = (i == num_p - 1) ? p_max : p_min + i*table.dp;
+        TabState* ts = &table.states[i*(1 + 2*num_x)];
+        computeState(ss, 0.5/rho_brine, 0.5/rho_co2, p);
+        if (!(ss.saturation > 0.0 && ss.saturation < 1.0)) {
+            OPM_THROW(std::runtime_error, "No two-phase CO2-brine state at p = " << p
+                      << " and T = " << temperature_);
+        }
+        setTabState(ts[0], ss);
+        table.xi_w[i] = ss.massfrac[wPhase][nComp];
+        table.xi_n[i] = ss.massfrac[nPhase][nComp];
+        for (int j = 0; j < num_x; ++j) {
+            const double eta = double(j)/(num_x - 1);
+            double xi = eta*table.xi_w[i];
+            computeState(ss, (1.0 - xi)/rho_brine, xi/rho_co2, p);
+            setTabState(ts[1 + j], ss);
+            xi = table.xi_n[i] + eta*(1.0 - table.xi_n[i]);
+            computeState(ss, (1.0 - xi)/rho_brine, xi/rho_co2, p);
+            setTabState(ts[1 + num_x + j], ss);
+        }
+    }
+    table_ = table;
+}
+
 void BlackoilCo2PVT::generateBlackOilTables(double temperature)
 {
     std::cout << "\n Generating pvt tables for the eclipse black oil formulation\n using the oil component as brine and the gas component as co_2." << std::endl;
@@ -139,6 +276,7 @@ void BlackoilCo2PVT::generateBlackOilTables(double temperature)
     }
 
     temperature_ = temperature;
+    clearStateCaches();
 
     CompVec z;
     z[Water] = 0.0;
@@ -247,64 +385,75 @@ BlackoilCo2PVT::CompVec BlackoilCo2PVT::surfaceDensities() const
 
 double BlackoilCo2PVT::getViscosity(double press, const CompVec& surfvol, PhaseIndex phase) const
 {
+    if (phase == Aqua) {
+        return 1.0e-10;
+    }
     SubState ss;
-    computeState(ss, surfvol[Oil], surfvol[Gas], press);
-    switch(phase) {
-    case Aqua: return 1.0e-10;
-    case Liquid: return ss.phaseViscosity[wPhase];
-    case Vapour: return ss.phaseViscosity[nPhase];
-    };
-    return 1.0e-10;
+    memoState(ss, surfvol[Oil], surfvol[Gas], press, true);
+    return phase == Liquid ? ss.phaseViscosity[wPhase] : ss.phaseViscosity[nPhase];
 }
 
 
 double BlackoilCo2PVT::getSaturation(double press, const CompVec& surfvol, PhaseIndex phase) const
 {
+    if (phase == Aqua) {
+        return 0.0;
+    }
     SubState ss;
-    computeState(ss, surfvol[Oil], surfvol[Gas], press);
-    switch(phase) {
-    case Aqua: return 0.0;
-    case Liquid: return ss.saturation;
-    case Vapour: return 1.0 - ss.saturation;
-    };
-    return 0.0;
+    memoState(ss, surfvol[Oil], surfvol[Gas], press, true);
+    return phase == Liquid ? ss.saturation : 1.0 - ss.saturation;
 }
     
     
 double BlackoilCo2PVT::B(double press, const CompVec& surfvol, PhaseIndex phase) const
 {
+    if (phase == Aqua) {
+        return 1.0;
+    }
     SubState ss;
-    computeState(ss, surfvol[Oil], surfvol[Gas], press);
-    switch(phase) {
-    case Aqua: return 1.0;
-    case Liquid: return surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10);
-    case Vapour: return surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10);
-    };
-    return 1.0;
+    memoState(ss, surfvol[Oil], surfvol[Gas], press, true);
+    return phaseB(ss, phase);
 }
 
+// The difference quotients evaluate both pressures the same way, from the
+// table or from the flash, so that a table edge between them does not
+// show up in the derivative.
 double BlackoilCo2PVT::dBdp(double press, const CompVec& surfvol, PhaseIndex phase) const
 {
+    if (phase == Aqua) {
+        return 0.0;
+    }
     const double dp = 100.;
-    return (B(press+dp,surfvol,phase)-B(press,surfvol,phase))/dp;
+    const bool tab = inStateTable(press) && inStateTable(press + dp);
+    SubState ss;
+    memoState(ss, surfvol[Oil], surfvol[Gas], press + dp, tab);
+    const double B_dp = phaseB(ss, phase);
+    memoState(ss, surfvol[Oil], surfvol[Gas], press, tab);
+    return (B_dp - phaseB(ss, phase))/dp;
 }
 
 double BlackoilCo2PVT::R(double press, const CompVec& surfvol, PhaseIndex phase) const
 {
+    if (phase == Aqua) {
+        return 0.0;
+    }
     SubState ss;
-    computeState(ss, surfvol[Oil], surfvol[Gas], press);
-    switch(phase) {
-    case Aqua: return 0.0;
-    case Liquid: return (ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10);
-    case Vapour: return (ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10);
-    };
-    return 0.0;
+    memoState(ss, surfvol[Oil], surfvol[Gas], press, true);
+    return phaseR(ss, phase);
 }
 
 double BlackoilCo2PVT::dRdp(double press, const CompVec& surfvol, PhaseIndex phase) const
 {
+    if (phase == Aqua) {
+        return 0.0;
+    }
     const double dp = 100.;
-    return (R(press+dp,surfvol,phase)-R(press,surfvol,phase))/dp;
+    const bool tab = inStateTable(press) && inStateTable(press + dp);
+    SubState ss;
+    memoState(ss, surfvol[Oil], surfvol[Gas], press + dp, tab);
+    const double R_dp = phaseR(ss, phase);
+    memoState(ss, surfvol[Oil], surfvol[Gas], press, tab);
+    return (R_dp - phaseR(ss, phase))/dp;
 }
 
 void BlackoilCo2PVT::getViscosity(const std::vector<PhaseVec>& pressures,
@@ -315,7 +464,7 @@ void BlackoilCo2PVT::getViscosity(const std::vector<PhaseVec>& pressures,
     output.resize(num);
     SubState ss;
     for (int i = 0; i < num; ++i) {
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid], true);
         output[i][Aqua] = 1.0e-10;
         output[i][Liquid] = ss.phaseViscosity[wPhase];
         output[i][Vapour] = ss.phaseViscosity[nPhase];
@@ -330,7 +479,7 @@ void BlackoilCo2PVT::B(const std::vector<PhaseVec>& pressures,
     output.resize(num);
     SubState ss;
     for (int i = 0; i < num; ++i) {
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid], true);
         output[i][Aqua] = 1.0;
         output[i][Liquid] = surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10);
         output[i][Vapour] = surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10);
@@ -348,11 +497,12 @@ void BlackoilCo2PVT::dBdp(const std::vector<PhaseVec>& pressures,
     SubState ss;
     const double dp = 100.;
     for (int i = 0; i < num; ++i) {
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]);
+        const bool tab = inStateTable(pressures[i][Liquid]) && inStateTable(pressures[i][Liquid] + dp);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid], tab);
         output_B[i][Aqua] = 1.0;
         output_B[i][Liquid] = surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10);
         output_B[i][Vapour] = surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10);
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]+dp);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]+dp, tab);
         output_dBdp[i][Aqua] = 0.0;
         output_dBdp[i][Liquid] = (surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10) - output_B[i][Liquid])/dp;
         output_dBdp[i][Vapour] = (surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10) - output_B[i][Vapour])/dp;
@@ -367,7 +517,7 @@ void BlackoilCo2PVT::R(const std::vector<PhaseVec>& pressures,
     output.resize(num);
     SubState ss;
     for (int i = 0; i < num; ++i) {
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid], true);
         output[i][Aqua] = 0.0;
         output[i][Liquid] = (ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10);
         output[i][Vapour] = (ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10);
@@ -385,17 +535,209 @@ void BlackoilCo2PVT::dRdp(const std::vector<PhaseVec>& pressures,
     SubState ss;
     const double dp = 100.;
     for (int i = 0; i < num; ++i) {
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]);
+        const bool tab = inStateTable(pressures[i][Liquid]) && inStateTable(pressures[i][Liquid] + dp);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid], tab);
+        output_R[i][Aqua] = 0.0;
+        output_R[i][Liquid] = (ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10);
+        output_R[i][Vapour] = (ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]+dp, tab);
+        output_dRdp[i][Aqua] = 0.0;
+        output_dRdp[i][Liquid] = ((ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10) - output_R[i][Liquid])/dp;
+        output_dRdp[i][Vapour] = ((ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10) - output_R[i][Vapour])/dp;
+    }
+}
+
+// Same results as dBdp(), dRdp() and getViscosity(), with two instead of
+// five flash computations per cell.
+void BlackoilCo2PVT::evalAll(const std::vector<PhaseVec>& pressures,
+                             const std::vector<CompVec>& surfvol,
+                             std::vector<PhaseVec>& output_B,
+                             std::vector<PhaseVec>& output_dBdp,
+                             std::vector<PhaseVec>& output_R,
+                             std::vector<PhaseVec>& output_dRdp,
+                             std::vector<PhaseVec>& output_mu) const
+{
+    int num = pressures.size();
+    output_B.resize(num);
+    output_dBdp.resize(num);
+    output_R.resize(num);
+    output_dRdp.resize(num);
+    output_mu.resize(num);
+    SubState ss;
+    const double dp = 100.;
+    for (int i = 0; i < num; ++i) {
+        const bool tab = inStateTable(pressures[i][Liquid]) && inStateTable(pressures[i][Liquid] + dp);
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid], tab);
+        output_B[i][Aqua] = 1.0;
+        output_B[i][Liquid] = surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10);
+        output_B[i][Vapour] = surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10);
         output_R[i][Aqua] = 0.0;
         output_R[i][Liquid] = (ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10);
         output_R[i][Vapour] = (ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10);
-        computeState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]+dp);
+        output_mu[i][Aqua] = 1.0e-10;
+        output_mu[i][Liquid] = ss.phaseViscosity[wPhase];
+        output_mu[i][Vapour] = ss.phaseViscosity[nPhase];
+        evalState(ss, surfvol[i][Oil], surfvol[i][Gas], pressures[i][Liquid]+dp, tab);
+        output_dBdp[i][Aqua] = 0.0;
+        output_dBdp[i][Liquid] = (surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10) - output_B[i][Liquid])/dp;
+        output_dBdp[i][Vapour] = (surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10) - output_B[i][Vapour])/dp;
         output_dRdp[i][Aqua] = 0.0;
         output_dRdp[i][Liquid] = ((ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10) - output_R[i][Liquid])/dp;
         output_dRdp[i][Vapour] = ((ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10) - output_R[i][Vapour])/dp;
     }
 }
     
+void BlackoilCo2PVT::clearStateCaches()
+{
+    table_ = StateTable();
+    for (int i = 0; i < 2; ++i) {
+        memo_[i].pressure = std::numeric_limits<double>::quiet_NaN();
+    }
+    memo_next_ = 0;
+}
+
+void BlackoilCo2PVT::setTabState(BlackoilCo2PVT::TabState& ts, const BlackoilCo2PVT::SubState& ss) const
+{
+    for (int phase = 0; phase < 2; ++phase) {
+        ts.density[phase] = ss.density[phase];
+        ts.viscosity[phase] = ss.phaseViscosity[phase];
+    }
+    ts.massfrac_wn = ss.massfrac[wPhase][nComp];
+    ts.massfrac_nw = ss.massfrac[nPhase][wComp];
+}
+
+void BlackoilCo2PVT::memoState(BlackoilCo2PVT::SubState& ss, double zBrine, double zCO2, double pressure, bool use_table) const
+{
+    use_table = use_table && inStateTable(pressure);
+#ifdef HAVE_OPENMP
+    if (omp_in_parallel()) {
+        evalState(ss, zBrine, zCO2, pressure, use_table);
+        return;
+    }
+#endif
+    for (int i = 0; i < 2; ++i) {
+        const Memo& m = memo_[i];
+        if (m.pressure == pressure && m.zBrine == zBrine && m.zCO2 == zCO2 && m.use_table == use_table) {
+            ss = m.ss;
+            return;
+        }
+    }
+    Memo& m = memo_[memo_next_];
+    memo_next_ = 1 - memo_next_;
+    evalState(m.ss, zBrine, zCO2, pressure, use_table);
+    m.zBrine = zBrine;
+    m.zCO2 = zCO2;
+    m.pressure = pressure;
+    m.use_table = use_table;
+    ss = m.ss;
+}
+
+void BlackoilCo2PVT::evalState(BlackoilCo2PVT::SubState& ss, double zBrine, double zCO2, double pressure, bool use_table) const
+{
+    if (!use_table || !interpolateState(ss, zBrine, zCO2, pressure)) {
+        computeState(ss, zBrine, zCO2, pressure);
+    }
+}
+
+bool BlackoilCo2PVT::inStateTable(double pressure) const
+{
+    return !table_.states.empty() && pressure >= table_.p_min && pressure <= table_.p_max;
+}
+
+double BlackoilCo2PVT::phaseB(const BlackoilCo2PVT::SubState& ss, PhaseIndex phase) const
+{
+    switch(phase) {
+    case Aqua: return 1.0;
+    case Liquid: return surfaceDensities_[Oil]/(ss.massfrac[wPhase][wComp]*ss.density[wPhase]+1.0e-10);
+    case Vapour: return surfaceDensities_[Gas]/(ss.massfrac[nPhase][nComp]*ss.density[nPhase]+1.0e-10);
+    };
+    return 1.0;
+}
+
+double BlackoilCo2PVT::phaseR(const BlackoilCo2PVT::SubState& ss, PhaseIndex phase) const
+{
+    switch(phase) {
+    case Aqua: return 0.0;
+    case Liquid: return (ss.massfrac[wPhase][nComp]*surfaceDensities_[Oil])/(ss.massfrac[wPhase][wComp]*surfaceDensities_[Gas]+1.0e-10);
+    case Vapour: return (ss.massfrac[nPhase][wComp]*surfaceDensities_[Gas])/(ss.massfrac[nPhase][nComp]*surfaceDensities_[Oil]+1.0e-10);
+    };
+    return 0.0;
+}
+
+bool BlackoilCo2PVT::interpolateState(BlackoilCo2PVT::SubState& ss, double zBrine, double zCO2, double pressure) const
+{
+    const StateTable& tab = table_;
+    if (tab.states.empty() || !(pressure >= tab.p_min && pressure <= tab.p_max)) {
+        return false;
+    }
+    const double massH20 = surfaceDensities_[Oil]*zBrine;
+    const double massCO2 = surfaceDensities_[Gas]*zCO2;
+    const double mass = massH20 + massCO2;
+    if (!(mass > 0.0) || massH20 < 0.0 || massCO2 < 0.0) {
+        return false;
+    }
+    const double xi = massCO2/mass;
+    const int i = std::min(int((pressure - tab.p_min)/tab.dp), tab.num_p - 2);
+    const double t = (pressure - tab.p_min)/tab.dp - i;
+    const double xi_w = (1.0 - t)*tab.xi_w[i] + t*tab.xi_w[i+1];
+    const double xi_n = (1.0 - t)*tab.xi_n[i] + t*tab.xi_n[i+1];
+    const int stride = 1 + 2*tab.num_x;
+
+    // Find the (up to) four table states around (pressure, xi) and their weights.
+    int offset = 0;
+    double s = 0.0;
+    if (xi <= xi_w) {
+        // Liquid only, between pure brine and saturated liquid.
+        const double eta = (tab.num_x - 1)*xi/xi_w;
+        const int j = std::min(int(eta), tab.num_x - 2);
+        offset = 1 + j;
+        s = eta - j;
+    } else if (xi >= xi_n) {
+        // Gas only, between saturated gas and pure CO2.
+        const double eta = (tab.num_x - 1)*(xi - xi_n)/(1.0 - xi_n);
+        const int j = std::min(int(eta), tab.num_x - 2);
+        offset = 1 + tab.num_x + j;
+        s = eta - j;
+    }
+    const TabState* ts0 = &tab.states[i*stride + offset];
+    const TabState* ts1 = &tab.states[(i + 1)*stride + offset];
+    const double w00 = (1.0 - t)*(1.0 - s);
+    const double w01 = (1.0 - t)*s;
+    const double w10 = t*(1.0 - s);
+    const double w11 = t*s;
+    // In the two-phase region offset is 0 and s is 0, so ts0[1] and ts1[1]
+    // get zero weight.
+    for (int phase = 0; phase < 2; ++phase) {
+        ss.density[phase] = w00*ts0[0].density[phase] + w01*ts0[1].density[phase]
+            + w10*ts1[0].density[phase] + w11*ts1[1].density[phase];
+        ss.phaseViscosity[phase] = w00*ts0[0].viscosity[phase] + w01*ts0[1].viscosity[phase]
+            + w10*ts1[0].viscosity[phase] + w11*ts1[1].viscosity[phase];
+    }
+    ss.massfrac[wPhase][nComp] = w00*ts0[0].massfrac_wn + w01*ts0[1].massfrac_wn
+        + w10*ts1[0].massfrac_wn + w11*ts1[1].massfrac_wn;
+    ss.massfrac[nPhase][wComp] = w00*ts0[0].massfrac_nw + w01*ts0[1].massfrac_nw
+        + w10*ts1[0].massfrac_nw + w11*ts1[1].massfrac_nw;
+    ss.massfrac[wPhase][wComp] = 1.0 - ss.massfrac[wPhase][nComp];
+    ss.massfrac[nPhase][nComp] = 1.0 - ss.massfrac[nPhase][wComp];
+
+    // Phase volumes as in computeState().
+    if (xi <= xi_w) {
+        ss.saturation = 1.0;
+        ss.phaseVolume[wPhase] = mass/ss.density[wPhase];
+        ss.phaseVolume[nPhase] = 0.0;
+    } else if (xi >= xi_n) {
+        ss.saturation = 0.0;
+        ss.phaseVolume[wPhase] = 0.0;
+        ss.phaseVolume[nPhase] = mass/ss.density[nPhase];
+    } else {
+        double detX = ss.massfrac[wPhase][wComp]*ss.massfrac[nPhase][nComp]-ss.massfrac[wPhase][nComp]*ss.massfrac[nPhase][wComp];
+        ss.phaseVolume[wPhase] = (massH20*ss.massfrac[nPhase][nComp] - massCO2*ss.massfrac[nPhase][wComp])/(ss.density[wPhase]*detX);
+        ss.phaseVolume[nPhase] = (massCO2*ss.massfrac[wPhase][wComp] - massH20*ss.massfrac[wPhase][nComp])/(ss.density[nPhase]*detX);
+        ss.saturation = ss.phaseVolume[wPhase]/(ss.phaseVolume[wPhase]+ss.phaseVolume[nPhase]);
+    }
+    return true;
+}
+
 void BlackoilCo2PVT::computeState(BlackoilCo2PVT::SubState& ss, double zBrine, double zCO2, double pressure) const
 {
                
@@ -491,8 +833,6 @@ void BlackoilCo2PVT::computeState(BlackoilCo2PVT::SubState& ss, double zBrine, d
 }
     
     
-    
-typedef BlackoilCo2PVT BlackoilPVT;
 
 } // Opm
 
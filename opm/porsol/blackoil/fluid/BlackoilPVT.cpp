@@ -97,6 +97,11 @@ namespace Opm
         }
     }
 
+    void BlackoilPVT::init(const Deck& deck, const parameter::ParameterGroup&)
+    {
+        init(deck);
+    }
+
     BlackoilPVT::CompVec BlackoilPVT::surfaceDensities() const
     {
         return densities_;
@@ -217,4 +222,31 @@ namespace Opm
         }
     }
 
+    void BlackoilPVT::evalAll(const std::vector<PhaseVec>& pressures,
+                              const std::vector<CompVec>& surfvol,
+                              std::vector<PhaseVec>& output_B,
+                              std::vector<PhaseVec>& output_dBdp,
+                              std::vector<PhaseVec>& output_R,
+                              std::vector<PhaseVec>& output_dRdp,
+                              std::vector<PhaseVec>& output_mu) const
+    {
+        int num = pressures.size();
+        output_B.resize(num);
+        output_dBdp.resize(num);
+        output_R.resize(num);
+        output_dRdp.resize(num);
+        output_mu.resize(num);
+        for (int phase = 0; phase < numPhases; ++phase) {
+            propsForPhase(PhaseIndex(phase)).evalAll(pressures, surfvol, phase,
+                                                     data1_, data2_, data3_, data4_, data5_);
+            for (int i = 0; i < num; ++i) {
+                output_B[i][phase] = data1_[i];
+                output_dBdp[i][phase] = data2_[i];
+                output_R[i][phase] = data3_[i];
+                output_dRdp[i][phase] = data4_[i];
+                output_mu[i][phase] = data5_[i];
+            }
+        }
+    }
+
 } // namespace Opm
@@ -24,6 +24,7 @@
 #include "MiscibilityProps.hpp"
 #include "BlackoilDefs.hpp"
 #include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <string>
 
@@ -34,6 +35,8 @@ namespace Opm
     {
     public:
         void init(const Deck& deck);
+        /// Same as init(deck), there are no parameters for tabulated PVT.
+        void init(const Deck& deck, const parameter::ParameterGroup& param);
 
         double getViscosity(double press,
                             const CompVec& surfvol,
@@ -69,6 +72,13 @@ namespace Opm
                   const std::vector<CompVec>& surfvol,
                   std::vector<PhaseVec>& output_R,
                   std::vector<PhaseVec>& output_dRdp) const;
+        void evalAll(const std::vector<PhaseVec>& pressures,
+                     const std::vector<CompVec>& surfvol,
+                     std::vector<PhaseVec>& output_B,
+                     std::vector<PhaseVec>& output_dBdp,
+                     std::vector<PhaseVec>& output_R,
+                     std::vector<PhaseVec>& output_dRdp,
+                     std::vector<PhaseVec>& output_mu) const;
 
     private:
 	int region_number_;
@@ -80,6 +90,9 @@ namespace Opm
 	CompVec densities_;
         mutable std::vector<double> data1_;
         mutable std::vector<double> data2_;
+        mutable std::vector<double> data3_;
+        mutable std::vector<double> data4_;
+        mutable std::vector<double> data5_;
     };
 
 }
@@ -196,4 +196,31 @@ namespace Opm
         output_dRdp.resize(num, 0.0);
     }
 
+    void MiscibilityDead::evalAll(const std::vector<PhaseVec>& pressures,
+                                  const std::vector<CompVec>&,
+                                  int phase,
+                                  std::vector<double>& output_B,
+                                  std::vector<double>& output_dBdp,
+                                  std::vector<double>& output_R,
+                                  std::vector<double>& output_dRdp,
+                                  std::vector<double>& output_mu) const
+    {
+        int num = pressures.size();
+        output_B.resize(num);
+        output_dBdp.resize(num);
+        output_mu.resize(num);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const double p = pressures[i][phase];
+            const double Bg = 1.0/one_over_B_(p);
+            output_B[i] = Bg;
+            output_dBdp[i] = -Bg*Bg*one_over_B_.derivative(p);
+            output_mu[i] = viscosity_(p);
+        }
+        output_R.clear();
+        output_R.resize(num, 0.0);
+        output_dRdp.clear();
+        output_dRdp.resize(num, 0.0);
+    }
+
 }
@@ -82,6 +82,15 @@ namespace Opm
                           std::vector<double>& output_R,
                           std::vector<double>& output_dRdp) const;
 
+        virtual void evalAll(const std::vector<PhaseVec>& pressures,
+                             const std::vector<CompVec>& surfvol,
+                             int phase,
+                             std::vector<double>& output_B,
+                             std::vector<double>& output_dBdp,
+                             std::vector<double>& output_R,
+                             std::vector<double>& output_dRdp,
+                             std::vector<double>& output_mu) const;
+
     private:
 	// PVT properties of dry gas or dead oil
         Opm::utils::UniformTableLinear<double> one_over_B_;
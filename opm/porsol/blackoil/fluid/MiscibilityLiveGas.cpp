@@ -191,6 +191,111 @@ namespace Opm
         }
     }
 
+    void MiscibilityLiveGas::evalAll(const std::vector<PhaseVec>& pressures,
+                                     const std::vector<CompVec>& surfvol,
+                                     int phase,
+                                     std::vector<double>& output_B,
+                                     std::vector<double>& output_dBdp,
+                                     std::vector<double>& output_R,
+                                     std::vector<double>& output_dRdp,
+                                     std::vector<double>& output_mu) const
+    {
+        assert(pressures.size() == surfvol.size());
+        int num = pressures.size();
+        output_B.resize(num);
+        output_dBdp.resize(num);
+        output_R.resize(num);
+        output_dRdp.resize(num);
+        output_mu.resize(num);
+        for (int i = 0; i < num; ++i) {
+            evalAllSingle(pressures[i][phase], surfvol[i],
+                          output_B[i], output_dBdp[i], output_R[i], output_dRdp[i], output_mu[i]);
+        }
+    }
+
+    // Same results as B(), dBdp(), R(), dRdp() and getViscosity(), but
+    // each table is searched only once.
+    void MiscibilityLiveGas::evalAllSingle(const double press, const surfvol_t& surfvol,
+                                           double& B, double& dBdp, double& R, double& dRdp,
+                                           double& mu) const
+    {
+        const std::vector<double>& psat = saturated_gas_table_[0];
+        const int is = tableIndex(psat, press);
+        const double dp = press - psat[is];
+        const double dpsat = psat[is+1] - psat[is];
+        const double dRsat = (saturated_gas_table_[3][is+1] - saturated_gas_table_[3][is])/dpsat;
+        const double Rsat = dRsat*dp + saturated_gas_table_[3][is];
+        const double maxR = surfvol[Liquid]/surfvol[Vapour];
+        const bool saturated = Rsat < maxR;
+
+        // Vaporised oil-gas ratio.
+        if (surfvol[Liquid] == 0.0) {
+            R = 0.0;
+        } else {
+            R = saturated ? Rsat : maxR;
+        }
+        dRdp = saturated ? dRsat : 0.0;
+
+        // Formation volume factor and viscosity, see miscible_gas().
+        double val[2];
+        double dBval;
+        if (saturated) {
+            for (int item = 1; item <= 2; ++item) {
+                const std::vector<double>& table = saturated_gas_table_[item];
+                val[item-1] = (table[is+1] - table[is])/dpsat*dp + table[is];
+            }
+            dBval = (saturated_gas_table_[1][is+1] - saturated_gas_table_[1][is])/dpsat;
+        } else {
+            const int ltp = psat.size() - 1;
+            const bool has_undersat = undersat_gas_tables_[is][0].size() >= 2;
+            // Values of both items at maxR in undersaturated table section k.
+            double uval[2][2];
+            for (int k = 0; k < 2; ++k) {
+                const std::vector<std::vector<double> >& table = undersat_gas_tables_[is + k];
+                if (table[0].size() < 2) {
+                    continue;
+                }
+                const int j = tableIndex(table[0], maxR);
+                const double dr = maxR - table[0][j];
+                for (int item = 1; item <= 2; ++item) {
+                    uval[k][item-1] = (table[item][j+1] - table[item][j])/(table[0][j+1] - table[0][j])*dr
+                        + table[item][j];
+                }
+            }
+            if (has_undersat) {
+                dBval = (uval[1][0] - uval[0][0])/dpsat;
+            } else {
+                dBval = (saturated_gas_table_[1][is+1] - saturated_gas_table_[1][is])/dpsat;
+            }
+            const double w = dp/dpsat;
+            for (int item = 1; item <= 2; ++item) {
+                if (is == 0 && press < psat[0]) {
+                    // Extrapolate from first table section
+                    val[item-1] = linearInterpolation(undersat_gas_tables_[0][0],
+                                                      undersat_gas_tables_[0][item], maxR);
+                } else if (is+1 == ltp && press > psat[ltp]) {
+                    // Extrapolate from last table section
+                    val[item-1] = linearInterpolation(undersat_gas_tables_[ltp][0],
+                                                      undersat_gas_tables_[ltp][item], maxR);
+                } else if (!has_undersat) {
+                    val[item-1] = saturated_gas_table_[item][is] +
+                        w*(saturated_gas_table_[item][is+1] - saturated_gas_table_[item][is]);
+                } else {
+                    val[item-1] = uval[0][item-1] + w*(uval[1][item-1] - uval[0][item-1]);
+                }
+            }
+        }
+        mu = val[1];
+        if (surfvol[Vapour] == 0.0) {
+            // To handle no-gas case.
+            B = 1.0;
+            dBdp = 0.0;
+        } else {
+            B = val[0];
+            dBdp = dBval;
+        }
+    }
+
     double MiscibilityLiveGas::miscible_gas(double press, const surfvol_t& surfvol, int item,
 					    bool deriv) const
     {
@@ -78,10 +78,21 @@ namespace Opm
                           std::vector<double>& output_R,
                           std::vector<double>& output_dRdp) const;
 
+        virtual void evalAll(const std::vector<PhaseVec>& pressures,
+                             const std::vector<CompVec>& surfvol,
+                             int phase,
+                             std::vector<double>& output_B,
+                             std::vector<double>& output_dBdp,
+                             std::vector<double>& output_R,
+                             std::vector<double>& output_dRdp,
+                             std::vector<double>& output_mu) const;
+
     protected:
 	// item:  1=B  2=mu;
 	double miscible_gas(double press, const surfvol_t& surfvol, int item,
 			    bool deriv = false) const;
+        void evalAllSingle(double press, const surfvol_t& surfvol,
+                           double& B, double& dBdp, double& R, double& dRdp, double& mu) const;
 	// PVT properties of wet gas (with vaporised oil)
 	std::vector<std::vector<double> > saturated_gas_table_;	
 	std::vector<std::vector<std::vector<double> > > undersat_gas_tables_;
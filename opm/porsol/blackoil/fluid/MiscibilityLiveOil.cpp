@@ -282,6 +282,29 @@ namespace Opm
         }
     }
 
+    void MiscibilityLiveOil::evalAll(const std::vector<PhaseVec>& pressures,
+                                     const std::vector<CompVec>& surfvol,
+                                     int phase,
+                                     std::vector<double>& output_B,
+                                     std::vector<double>& output_dBdp,
+                                     std::vector<double>& output_R,
+                                     std::vector<double>& output_dRdp,
+                                     std::vector<double>& output_mu) const
+    {
+        assert(pressures.size() == surfvol.size());
+        int num = pressures.size();
+        output_B.resize(num);
+        output_dBdp.resize(num);
+        output_R.resize(num);
+        output_dRdp.resize(num);
+        output_mu.resize(num);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            evalAllSingle(pressures[i][phase], surfvol[i],
+                          output_B[i], output_dBdp[i], output_R[i], output_dRdp[i], output_mu[i]);
+        }
+    }
+
 
     double MiscibilityLiveOil::evalR(double press, const surfvol_t& surfvol) const
     {
@@ -337,6 +360,66 @@ namespace Opm
     }
 
 
+    // Same results as evalBDeriv(), evalRDeriv() and getViscosity(), but
+    // each table is searched only once.
+    void MiscibilityLiveOil::evalAllSingle(const double press, const surfvol_t& surfvol,
+                                           double& B, double& dBdp, double& R, double& dRdp,
+                                           double& mu) const
+    {
+        const std::vector<double>& psat = saturated_oil_table_[0];
+        const int is = tableIndex(psat, press);
+        const double dp = press - psat[is];
+        const double dpsat = psat[is+1] - psat[is];
+        const double dRsat = (saturated_oil_table_[3][is+1] - saturated_oil_table_[3][is])/dpsat;
+        const double Rsat = dRsat*dp + saturated_oil_table_[3][is];
+
+        // Solution ratio.
+        if (surfvol[Vapour] == 0.0) {
+            R = 0.0;
+            dRdp = 0.0;
+        } else {
+            const double maxR = surfvol[Vapour]/surfvol[Liquid];
+            if (Rsat < maxR) {
+                R = Rsat;
+                dRdp = dRsat;
+            } else {
+                R = maxR;
+                dRdp = 0.0;
+            }
+        }
+
+        // Inverse formation volume factor and viscosity, see miscible_oil().
+        const double maxR = (surfvol[Liquid] == 0.0) ? 0.0 : surfvol[Vapour]/surfvol[Liquid];
+        double Binv, dBinv;
+        if (Rsat < maxR) {  // Saturated case
+            dBinv = (saturated_oil_table_[1][is+1] - saturated_oil_table_[1][is])/dpsat;
+            Binv = dBinv*dp + saturated_oil_table_[1][is];
+            mu = (saturated_oil_table_[2][is+1] - saturated_oil_table_[2][is])/dpsat*dp
+                + saturated_oil_table_[2][is];
+        } else {  // Undersaturated case
+            const int ir = tableIndex(saturated_oil_table_[3], maxR);
+            const double w = (maxR - saturated_oil_table_[3][ir]) /
+                (saturated_oil_table_[3][ir+1] - saturated_oil_table_[3][ir]);
+            double val[2][2];
+            double dval[2];
+            for (int k = 0; k < 2; ++k) {
+                const std::vector<std::vector<double> >& table = undersat_oil_tables_[ir + k];
+                assert(table[0].size() >= 2);
+                const int j = tableIndex(table[0], press);
+                const double dpu = table[0][j+1] - table[0][j];
+                dval[k] = (table[1][j+1] - table[1][j])/dpu;
+                val[k][0] = dval[k]*(press - table[0][j]) + table[1][j];
+                val[k][1] = (table[2][j+1] - table[2][j])/dpu*(press - table[0][j]) + table[2][j];
+            }
+            Binv = val[0][0] + w*(val[1][0] - val[0][0]);
+            dBinv = dval[0] + w*(dval[1] - dval[0]);
+            mu = val[0][1] + w*(val[1][1] - val[0][1]);
+        }
+        B = 1.0/Binv;
+        dBdp = -B*B*dBinv;
+    }
+
+
     double MiscibilityLiveOil::miscible_oil(double press, const surfvol_t& surfvol,
 					    int item, bool deriv) const
     {
@@ -79,11 +79,22 @@ namespace Opm
                           std::vector<double>& output_R,
                           std::vector<double>& output_dRdp) const;
 
+        virtual void evalAll(const std::vector<PhaseVec>& pressures,
+                             const std::vector<CompVec>& surfvol,
+                             int phase,
+                             std::vector<double>& output_B,
+                             std::vector<double>& output_dBdp,
+                             std::vector<double>& output_R,
+                             std::vector<double>& output_dRdp,
+                             std::vector<double>& output_mu) const;
+
     protected:
         double evalR(double press, const surfvol_t& surfvol) const;
         void evalRDeriv(double press, const surfvol_t& surfvol, double& R, double& dRdp) const;
         double evalB(double press, const surfvol_t& surfvol) const;
         void evalBDeriv(double press, const surfvol_t& surfvol, double& B, double& dBdp) const;
+        void evalAllSingle(double press, const surfvol_t& surfvol,
+                           double& B, double& dBdp, double& R, double& dRdp, double& mu) const;
 
 	// item:  1=B  2=mu;
 	double miscible_oil(double press, const surfvol_t& surfvol, int item,
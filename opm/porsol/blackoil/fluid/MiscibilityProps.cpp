@@ -50,4 +50,18 @@ namespace Opm
     {
     }
 
+    void MiscibilityProps::evalAll(const std::vector<PhaseVec>& pressures,
+                                   const std::vector<CompVec>& surfvol,
+                                   int phase,
+                                   std::vector<double>& output_B,
+                                   std::vector<double>& output_dBdp,
+                                   std::vector<double>& output_R,
+                                   std::vector<double>& output_dRdp,
+                                   std::vector<double>& output_mu) const
+    {
+        dBdp(pressures, surfvol, phase, output_B, output_dBdp);
+        dRdp(pressures, surfvol, phase, output_R, output_dRdp);
+        getViscosity(pressures, surfvol, phase, output_mu);
+    }
+
 } // namespace Opm
@@ -79,6 +79,19 @@ namespace Opm
                           int phase,
                           std::vector<double>& output_R,
                           std::vector<double>& output_dRdp) const = 0;
+
+        /// B, dB/dp, R, dR/dp and viscosity of one phase for all cells
+        /// in one call. The default implementation calls the separate
+        /// methods above; subclasses override it to share the table
+        /// lookups between the quantities.
+        virtual void evalAll(const std::vector<PhaseVec>& pressures,
+                             const std::vector<CompVec>& surfvol,
+                             int phase,
+                             std::vector<double>& output_B,
+                             std::vector<double>& output_dBdp,
+                             std::vector<double>& output_R,
+                             std::vector<double>& output_dRdp,
+                             std::vector<double>& output_mu) const;
     };
 
 } // namespace Opm
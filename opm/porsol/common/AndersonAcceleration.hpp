@@ -0,0 +1,200 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_ANDERSONACCELERATION_HEADER
+#define OPM_ANDERSONACCELERATION_HEADER
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm
+{
+
+    /// @brief Anderson acceleration of a fixed-point iteration x = G(x).
+    ///
+    /// After every evaluation g = G(x), call accelerate(x, g), which
+    /// replaces g by a combination of the last depth() + 1 evaluations
+    /// that minimizes the linearized fixed-point residual G(x) - x
+    /// (Walker & Ni, SIAM J. Numer. Anal. 49(4), 2011).
+    /// The history must be reset() whenever the map G changes.
+    class AndersonAcceleration
+    {
+    public:
+        /// @param depth number of previous residual differences used.
+        /// @param regularization relative Tikhonov regularization of
+        ///        the least-squares problem.
+        explicit AndersonAcceleration(const int depth = 5,
+                                      const double regularization = 1e-10)
+            : depth_(depth), regularization_(regularization)
+        {
+            if (depth_ < 1) {
+                OPM_THROW(std::runtime_error, "Anderson acceleration depth must be positive, got " << depth_);
+            }
+        }
+
+        /// Forget all previous iterates.
+        void reset()
+        {
+            dF_.clear();
+            dG_.clear();
+            f_prev_.clear();
+            g_prev_.clear();
+        }
+
+        int depth() const
+        {
+            return depth_;
+        }
+
+        /// Number of residual differences currently in use.
+        int historySize() const
+        {
+            return dF_.size();
+        }
+
+        /// @param x the last iterate.
+        /// @param g on input G(x), on output the accelerated next iterate.
+        void accelerate(const std::vector<double>& x, std::vector<double>& g)
+        {
+            const std::size_t n = x.size();
+            assert(g.size() == n);
+            std::vector<double> f(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                f[i] = g[i] - x[i];
+            }
+            if (!f_prev_.empty()) {
+                std::vector<double> df(n), dg(n);
+                for (std::size_t i = 0; i < n; ++i) {
+                    df[i] = f[i] - f_prev_[i];
+                    dg[i] = g[i] - g_prev_[i];
+                }
+                dF_.push_back(df);
+                dG_.push_back(dg);
+                if (int(dF_.size()) > depth_) {
+                    dF_.pop_front();
+                    dG_.pop_front();
+                }
+            }
+            f_prev_.swap(f);
+            g_prev_ = g;
+
+            const int m = dF_.size();
+            if (m == 0) {
+                return;
+            }
+
+            // Solve min |f - dF*gamma| by the (regularized) normal equations,
+            // which is adequate for the small depths used in practice.
+            const std::vector<double>& fc = f_prev_;
+            std::vector<double> A(m*m), b(m);
+            double trace = 0.0;
+            for (int j = 0; j < m; ++j) {
+                b[j] = dot(dF_[j], fc);
+                for (int k = j; k < m; ++k) {
+                    A[j*m + k] = A[k*m + j] = dot(dF_[j], dF_[k]);
+                }
+                trace += A[j*m + j];
+            }
+            if (trace == 0.0) {
+                return;
+            }
+            for (int j = 0; j < m; ++j) {
+                A[j*m + j] += regularization_*trace/m;
+            }
+            std::vector<double> gamma;
+            if (!solveSmall(m, A, b, gamma)) {
+                // Singular least-squares system, restart.
+                reset();
+                return;
+            }
+            for (int j = 0; j < m; ++j) {
+                const std::vector<double>& dg = dG_[j];
+                for (std::size_t i = 0; i < n; ++i) {
+                    g[i] -= gamma[j]*dg[i];
+                }
+            }
+        }
+
+    private:
+        static double dot(const std::vector<double>& a, const std::vector<double>& b)
+        {
+            double s = 0.0;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                s += a[i]*b[i];
+            }
+            return s;
+        }
+
+        // Gaussian elimination with partial pivoting on a dense m x m system.
+        static bool solveSmall(const int m, std::vector<double> A, std::vector<double> b,
+                               std::vector<double>& x)
+        {
+            for (int c = 0; c < m; ++c) {
+                int piv = c;
+                for (int r = c + 1; r < m; ++r) {
+                    if (std::fabs(A[r*m + c]) > std::fabs(A[piv*m + c])) {
+                        piv = r;
+                    }
+                }
+                if (A[piv*m + c] == 0.0) {
+                    return false;
+                }
+                if (piv != c) {
+                    for (int k = 0; k < m; ++k) {
+                        std::swap(A[c*m + k], A[piv*m + k]);
+                    }
+                    std::swap(b[c], b[piv]);
+                }
+                for (int r = c + 1; r < m; ++r) {
+                    const double factor = A[r*m + c]/A[c*m + c];
+                    for (int k = c; k < m; ++k) {
+                        A[r*m + k] -= factor*A[c*m + k];
+                    }
+                    b[r] -= factor*b[c];
+                }
+            }
+            x.assign(m, 0.0);
+            for (int r = m - 1; r >= 0; --r) {
+                double s = b[r];
+                for (int k = r + 1; k < m; ++k) {
+                    s -= A[r*m + k]*x[k];
+                }
+                x[r] = s/A[r*m + r];
+            }
+            return true;
+        }
+
+        int depth_;
+        double regularization_;
+        std::deque<std::vector<double> > dF_;
+        std::deque<std::vector<double> > dG_;
+        std::vector<double> f_prev_;
+        std::vector<double> g_prev_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_ANDERSONACCELERATION_HEADER
@@ -0,0 +1,140 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BRENTROOTFINDER_HEADER
+#define OPM_BRENTROOTFINDER_HEADER
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Opm
+{
+
+    /// @brief Brent's method for a zero of a scalar function in a bracket.
+    ///
+    /// Same calling convention as the RegulaFalsi root finder, but combines
+    /// inverse quadratic interpolation, secant steps and bisection, which
+    /// typically needs far fewer function evaluations on the smooth,
+    /// monotone functions we bracket.
+    /// The last function evaluation is always at the returned root, so
+    /// functors caching their last state (such as
+    /// MatchSaturatedVolumeFunctor) are consistent with the result.
+    struct BrentRootFinder
+    {
+        /// @param f functor, f(a) and f(b) must have opposite signs.
+        /// @param tolerance absolute tolerance on the root.
+        template <class Functor>
+        static double solve(const Functor& f,
+                            double a,
+                            double b,
+                            const int max_iter,
+                            const double tolerance,
+                            int& iterations_used)
+        {
+            double fa = f(a);
+            double fb = f(b);
+            double last_x = b;
+            if (fa == 0.0) {
+                iterations_used = 0;
+                f(a);
+                return a;
+            }
+            if (fa*fb > 0.0) {
+                OPM_THROW(std::runtime_error, "BrentRootFinder: zero not bracketed, f(" << a << ") = "
+                          << fa << " and f(" << b << ") = " << fb);
+            }
+            double c = a;
+            double fc = fa;
+            double d = b - a;
+            double e = d;
+            const double eps = std::numeric_limits<double>::epsilon();
+            for (int iter = 1; iter <= max_iter; ++iter) {
+                if ((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0)) {
+                    c = a;
+                    fc = fa;
+                    d = e = b - a;
+                }
+                if (std::fabs(fc) < std::fabs(fb)) {
+                    a = b;
+                    b = c;
+                    c = a;
+                    fa = fb;
+                    fb = fc;
+                    fc = fa;
+                }
+                const double tol = 2.0*eps*std::fabs(b) + 0.5*tolerance;
+                const double m = 0.5*(c - b);
+                if (std::fabs(m) <= tol || fb == 0.0) {
+                    iterations_used = iter;
+                    if (last_x != b) {
+                        f(b);
+                    }
+                    return b;
+                }
+                if (std::fabs(e) >= tol && std::fabs(fa) > std::fabs(fb)) {
+                    // Try interpolation.
+                    const double s = fb/fa;
+                    double p, q;
+                    if (a == c) {
+                        // Secant step.
+                        p = 2.0*m*s;
+                        q = 1.0 - s;
+                    } else {
+                        // Inverse quadratic interpolation.
+                        const double qa = fa/fc;
+                        const double r = fb/fc;
+                        p = s*(2.0*m*qa*(qa - r) - (b - a)*(r - 1.0));
+                        q = (qa - 1.0)*(r - 1.0)*(s - 1.0);
+                    }
+                    if (p > 0.0) {
+                        q = -q;
+                    } else {
+                        p = -p;
+                    }
+                    if (2.0*p < std::min(3.0*m*q - std::fabs(tol*q), std::fabs(e*q))) {
+                        e = d;
+                        d = p/q;
+                    } else {
+                        // Interpolation failed, bisect.
+                        d = m;
+                        e = m;
+                    }
+                } else {
+                    d = m;
+                    e = m;
+                }
+                a = b;
+                fa = fb;
+                b += (std::fabs(d) > tol) ? d : (m > 0.0 ? tol : -tol);
+                fb = f(b);
+                last_x = b;
+            }
+            OPM_THROW(std::runtime_error, "BrentRootFinder: maximum number of iterations (" << max_iter
+                      << ") exceeded, current interval is [" << std::min(b, c) << ", "
+                      << std::max(b, c) << "]");
+        }
+    };
+
+} // namespace Opm
+
+#endif // OPM_BRENTROOTFINDER_HEADER
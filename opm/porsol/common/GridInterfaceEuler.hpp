@@ -366,6 +366,20 @@ namespace Opm
             {
                 return pgrid_->mapper().map(*iter_);
             }
+
+            /// The partition type of the cell, InteriorEntity unless
+            /// the grid is distributed over several processes.
+            Dune::PartitionType partitionType() const
+            {
+                return iter_->partitionType();
+            }
+
+            /// The id of the cell in the grid's global id set, which
+            /// is the same on all processes holding the cell.
+            typename GridInterface::GridType::GlobalIdSet::IdType globalId() const
+            {
+                return pgrid_->grid().globalIdSet().id(*iter_);
+            }
         protected:
             const GridInterface* pgrid_;
             EntityPointerType iter_;
@@ -173,6 +173,15 @@ namespace Opm {
         typedef Dune::BlockVector<ScalarVectorBlockType> ScalarBlockVector;
         typedef Dune::BCRSMatrix <ScalarMatrixBlockType> ScalarBCRSMatrix;
 
+        LinearSolverBICGSTAB()
+            : precond_reuse_(1), solves_since_setup_(0)
+        {}
+
+        /// The ILU(0) factorisation is recomputed every n-th solve only.
+        /// Since BiCGSTAB iterates to the same tolerance, an older
+        /// factorisation only affects the number of iterations.
+        void setPreconditionerReuse(int n) { precond_reuse_ = std::max(n, 1); }
+
         void
         solve(const ScalarBCRSMatrix&  A,
               const ScalarBlockVector& b,
@@ -182,21 +191,37 @@ namespace Opm {
                                 ScalarBlockVector,
                                 ScalarBlockVector> opA(A);
 
-            Dune::SeqILU0<ScalarBCRSMatrix,
-                          ScalarBlockVector,
-                          ScalarBlockVector> precond(A, 1.0);
+            if (!precond_ || solves_since_setup_ >= precond_reuse_
+                || precond_size_ != A.N() || precond_nnz_ != A.nonzeroes()) {
+                precond_.reset(new Precond(A, 1.0));
+                precond_size_ = A.N();
+                precond_nnz_ = A.nonzeroes();
+                solves_since_setup_ = 0;
+            }
+            ++solves_since_setup_;
 
             int maxit  = A.N();
             double tol = 5.0e-7;
             int verb   = 0;
 
             Dune::BiCGSTABSolver<ScalarBlockVector>
-                solver(opA, precond, tol, maxit, verb);
+                solver(opA, *precond_, tol, maxit, verb);
 
             ScalarBlockVector           bcpy(b);
             Dune::InverseOperatorResult res;
             solver.apply(x, bcpy, res);
         }
+
+    private:
+        typedef Dune::SeqILU0<ScalarBCRSMatrix,
+                              ScalarBlockVector,
+                              ScalarBlockVector> Precond;
+
+        std::unique_ptr<Precond> precond_;
+        std::size_t precond_size_;
+        std::size_t precond_nnz_;
+        int precond_reuse_;
+        int solves_since_setup_;
     };
 
     class LinearSolverISTLAMG {
@@ -213,6 +213,99 @@ namespace Opm {
 
 
 
+    /// @brief
+    ///    Wrapper for a data pointer which makes an InlineData
+    ///    matrix copy the elements instead of sharing them.
+    ///
+    /// @tparam T
+    ///    Element type of the FullMatrix.
+    template<typename T>
+    struct InlineCopy {
+        /// @brief Constructor.
+        ///
+        /// @param [in] d
+        ///    Initial data vector, or NULL for an all-zero matrix.
+        explicit InlineCopy(const T* d) : data(d) {}
+
+        /// @brief Initial data vector.
+        const T* data;
+    };
+
+    /// @brief
+    ///    FullMatrix StoragePolicy which provides immutable object
+    ///    sharing semantics, or object owning semantics for small
+    ///    matrices (at most 3-by-3) without dynamic memory
+    ///    allocation when the data cannot be shared.
+    ///
+    /// @tparam T
+    ///    Element type of the FullMatrix.  Often @code T @endcode is
+    ///    an alias for @code double @endcode.
+    template<typename T>
+    class InlineData {
+    public:
+        /// @brief Storage element access.
+        ///
+        /// @param [in] i
+        ///    Linear element index.
+        ///
+        /// @return
+        ///    Storage element at index @code i @endcode.
+        const T& operator[](int i) const { return data()[i]; }
+
+        /// @brief Data size query.
+        ///
+        /// @return Number of elements in storage std::array.
+        int size() const { return sz_; }
+
+        /// @brief Direct access to all data.
+        ///
+        /// @return Pointer to first element of storage std::array.
+        const T* data() const { return shared_ ? shared_ : own_; }
+
+    protected:
+        /// @brief Constructor sharing the data.
+        ///
+        /// @param [in] sz
+        ///    Number of elements in FullMatrix storage std::array.
+        ///
+        /// @param [in] data
+        ///    Initial data vector.  Must be non-NULL and point to a
+        ///    @code sz @endcode-element data vector.
+        InlineData(int sz, const T* data)
+            : sz_(sz), shared_(data)
+        {
+            assert (shared_ != 0);
+        }
+
+        /// @brief Constructor copying the data.
+        ///
+        /// @param [in] sz
+        ///    Number of elements in FullMatrix storage std::array.
+        ///    At most 9.
+        ///
+        /// @param [in] data
+        ///    Initial data vector.  If non-NULL, must contain @code
+        ///    sz @endcode elements which will be copied.  If NULL,
+        ///    the elements are zero.
+        InlineData(int sz, InlineCopy<T> data)
+            : sz_(sz), shared_(0)
+        {
+            assert (sz_ <= 9);
+            if (data.data) {
+                std::copy(data.data, data.data + sz, own_);
+            } else {
+                std::fill(own_, own_ + sz, T(0));
+            }
+        }
+
+    private:
+        int      sz_;
+        const T* shared_;
+        T        own_[9];
+    };
+
+
+
 
 
     // ----------------------------------------------------------------------
@@ -575,11 +668,13 @@ namespace Opm {
 
     /// @brief
     ///    Convenience typedefs for C-ordered @code FullMatrix
-    ///    @endcode types with 'Owning', 'Shared' and 'Immutable
-    ///    Shared' matrix element storage semantics.
+    ///    @endcode types with 'Owning', 'Shared', 'Immutable
+    ///    Shared' and 'Immutable Shared or Inline' matrix element
+    ///    storage semantics.
     typedef FullMatrix<double, OwnData,             COrdering>        OwnCMatrix;
     typedef FullMatrix<double, SharedData,          COrdering>        SharedCMatrix;
     typedef const FullMatrix<double, ImmutableSharedData, COrdering>  ImmutableCMatrix;
+    typedef const FullMatrix<double, InlineData,          COrdering>  InlineCMatrix;
 
 
     /// @brief
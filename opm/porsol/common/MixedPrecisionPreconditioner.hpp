@@ -0,0 +1,160 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_MIXEDPRECISIONPRECONDITIONER_HEADER
+#define OPM_MIXEDPRECISIONPRECONDITIONER_HEADER
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+namespace Opm
+{
+
+    /// Copy the blocks of src into dst, converting between block types
+    /// of the same size (typically double to float). dst is resized if
+    /// needed.
+    template <class SrcVector, class DstVector>
+    void convertVector(const SrcVector& src, DstVector& dst)
+    {
+        if (dst.N() != src.N()) {
+            dst.resize(src.N());
+        }
+        for (typename SrcVector::size_type i = 0; i < src.N(); ++i) {
+            for (int k = 0; k < int(src[i].size()); ++k) {
+                dst[i][k] = src[i][k];
+            }
+        }
+    }
+
+
+    /// Copy the entries of src into dst, converting between block types
+    /// of the same size (typically double to float). The sparsity pattern
+    /// of dst is rebuilt only if it differs from that of src, so repeated
+    /// copies of a matrix with fixed structure only copy the values.
+    template <class SrcMatrix, class DstMatrix>
+    void convertMatrix(const SrcMatrix& src, DstMatrix& dst)
+    {
+        typedef typename SrcMatrix::ConstRowIterator SrcRowIter;
+        typedef typename SrcMatrix::ConstColIterator SrcColIter;
+        typedef typename DstMatrix::ColIterator      DstColIter;
+        typedef typename DstMatrix::block_type       DstBlock;
+
+        bool same_pattern = dst.N() == src.N() && dst.M() == src.M()
+            && dst.nonzeroes() == src.nonzeroes();
+        for (SrcRowIter ri = src.begin(); same_pattern && ri != src.end(); ++ri) {
+            DstColIter dci = dst[ri.index()].begin();
+            for (SrcColIter ci = ri->begin(); ci != ri->end(); ++ci, ++dci) {
+                if (dci == dst[ri.index()].end() || dci.index() != ci.index()) {
+                    same_pattern = false;
+                    break;
+                }
+            }
+        }
+        if (!same_pattern) {
+            DstMatrix pattern(src.N(), src.M(), src.nonzeroes(), DstMatrix::row_wise);
+            for (typename DstMatrix::CreateIterator row = pattern.createbegin();
+                 row != pattern.createend(); ++row) {
+                for (SrcColIter ci = src[row.index()].begin(); ci != src[row.index()].end(); ++ci) {
+                    row.insert(ci.index());
+                }
+            }
+            dst = pattern;
+        }
+        for (SrcRowIter ri = src.begin(); ri != src.end(); ++ri) {
+            DstColIter dci = dst[ri.index()].begin();
+            for (SrcColIter ci = ri->begin(); ci != ri->end(); ++ci, ++dci) {
+                for (int r = 0; r < int(DstBlock::rows); ++r) {
+                    for (int c = 0; c < int(DstBlock::cols); ++c) {
+                        (*dci)[r][c] = (*ci)[r][c];
+                    }
+                }
+            }
+        }
+    }
+
+
+    /// @brief Applies a preconditioner that works in lower precision,
+    /// typically an AMG hierarchy built on a single precision copy of the
+    /// matrix, to double precision vectors.
+    ///
+    /// The defect is rounded to the inner vector type, the inner
+    /// preconditioner is applied, and the correction is converted back.
+    /// The Krylov solver using this preconditioner still works in double
+    /// precision, so the attainable residual is not limited by the inner
+    /// precision, while the preconditioner moves half the data.
+    template <class Vector, class InnerVector>
+    class MixedPrecisionPreconditioner : public Dune::Preconditioner<Vector, Vector>
+    {
+    public:
+        typedef Dune::Preconditioner<InnerVector, InnerVector> InnerPreconditioner;
+
+        enum {
+            // The category the preconditioner is part of.
+            category = Dune::SolverCategory::sequential
+        };
+
+        /// @param inner is not owned, and must outlive this object.
+        explicit MixedPrecisionPreconditioner(InnerPreconditioner& inner)
+            : inner_(inner)
+        {
+        }
+
+        virtual void pre(Vector& x, Vector& b)
+        {
+            // The inner vectors are members, since some preconditioners
+            // keep references to the vectors passed to pre().
+            convertVector(x, x_);
+            convertVector(b, b_);
+            inner_.pre(x_, b_);
+        }
+
+        virtual void apply(Vector& v, const Vector& d)
+        {
+            convertVector(d, d_);
+            if (v_.N() != d_.N()) {
+                v_.resize(d_.N());
+            }
+            v_ = 0.0;
+            inner_.apply(v_, d_);
+            convertVector(v_, v);
+        }
+
+        virtual void post(Vector& x)
+        {
+            convertVector(x, x_);
+            inner_.post(x_);
+        }
+
+    private:
+        InnerPreconditioner& inner_;
+        InnerVector x_;
+        InnerVector b_;
+        InnerVector v_;
+        InnerVector d_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_MIXEDPRECISIONPRECONDITIONER_HEADER
@@ -0,0 +1,248 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/porsol/common/PerformanceLog.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#if defined(HAVE_MPI) && HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm
+{
+
+    namespace
+    {
+        std::string jsonEscape(const std::string& s)
+        {
+            std::string out;
+            for (std::string::size_type i = 0; i < s.size(); ++i) {
+                if (s[i] == '"' || s[i] == '\\') {
+                    out += '\\';
+                }
+                out += s[i];
+            }
+            return out;
+        }
+
+        double mean(const PerformanceLog::Entry& e)
+        {
+            return e.samples > 0 ? e.total/e.samples : 0.0;
+        }
+    }
+
+
+    double wallClockTime()
+    {
+        typedef std::chrono::steady_clock Clock;
+        return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    }
+
+
+    PerformanceLog::Entry::Entry()
+        : is_timer(false),
+          samples(0),
+          total(0.0),
+          min(std::numeric_limits<double>::max()),
+          max(-std::numeric_limits<double>::max()),
+          ranks(1)
+    {
+    }
+
+
+    PerformanceLog& PerformanceLog::global()
+    {
+        static PerformanceLog log;
+        return log;
+    }
+
+
+    void PerformanceLog::addTime(const std::string& name, double seconds)
+    {
+        add(name, true, seconds);
+    }
+
+
+    void PerformanceLog::addCount(const std::string& name, double count)
+    {
+        add(name, false, count);
+    }
+
+
+    void PerformanceLog::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+
+    PerformanceLog::Entry PerformanceLog::entry(const std::string& name) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, Entry>::const_iterator it = entries_.find(name);
+        return it == entries_.end() ? Entry() : it->second;
+    }
+
+
+    void PerformanceLog::add(const std::string& name, bool is_timer, double value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& e = entries_[name];
+        e.is_timer = is_timer;
+        ++e.samples;
+        e.total += value;
+        e.min = std::min(e.min, value);
+        e.max = std::max(e.max, value);
+    }
+
+
+    void PerformanceLog::merge(Entry& into, const Entry& from)
+    {
+        into.is_timer = from.is_timer;
+        into.samples += from.samples;
+        into.total += from.total;
+        into.min = std::min(into.min, from.min);
+        into.max = std::max(into.max, from.max);
+        into.ranks += from.ranks;
+    }
+
+
+    void PerformanceLog::gatherRanks()
+    {
+#if defined(HAVE_MPI) && HAVE_MPI
+        int rank, size;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+        if (size == 1) {
+            return;
+        }
+
+        // Entries are sent as text lines, since the ranks need not
+        // have the same set of names.
+        std::ostringstream os;
+        os << std::setprecision(17);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (std::map<std::string, Entry>::const_iterator it = entries_.begin();
+                 it != entries_.end(); ++it) {
+                const Entry& e = it->second;
+                os << it->first << '\t' << e.is_timer << ' ' << e.samples << ' ' << e.total
+                   << ' ' << e.min << ' ' << e.max << ' ' << e.ranks << '\n';
+            }
+        }
+        const std::string sendbuf = os.str();
+        int sendcount = sendbuf.size();
+        std::vector<int> counts(size), displs(size, 0);
+        MPI_Gather(&sendcount, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, MPI_COMM_WORLD);
+        std::vector<char> recvbuf;
+        if (rank == 0) {
+            for (int r = 1; r < size; ++r) {
+                displs[r] = displs[r - 1] + counts[r - 1];
+            }
+            recvbuf.resize(displs[size - 1] + counts[size - 1] + 1);
+        }
+        MPI_Gatherv(const_cast<char*>(sendbuf.data()), sendcount, MPI_CHAR,
+                    recvbuf.empty() ? 0 : &recvbuf[0], &counts[0], &displs[0], MPI_CHAR,
+                    0, MPI_COMM_WORLD);
+        if (rank != 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int r = 1; r < size; ++r) {
+            std::istringstream is(std::string(&recvbuf[displs[r]], counts[r]));
+            std::string name;
+            while (std::getline(is, name, '\t')) {
+                Entry e;
+                is >> e.is_timer >> e.samples >> e.total >> e.min >> e.max >> e.ranks;
+                is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::map<std::string, Entry>::iterator it = entries_.find(name);
+                if (it == entries_.end()) {
+                    entries_[name] = e;
+                } else {
+                    merge(it->second, e);
+                }
+            }
+        }
+#endif
+    }
+
+
+    void PerformanceLog::writeJSON(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        os << "{";
+        for (std::map<std::string, Entry>::const_iterator it = entries_.begin();
+             it != entries_.end(); ++it) {
+            const Entry& e = it->second;
+            os << (it == entries_.begin() ? "\n" : ",\n")
+               << "  \"" << jsonEscape(it->first) << "\": {"
+               << "\"type\": \"" << (e.is_timer ? "timer" : "counter") << "\", "
+               << "\"samples\": " << e.samples << ", "
+               << "\"total\": " << e.total << ", "
+               << "\"mean\": " << mean(e) << ", "
+               << "\"min\": " << e.min << ", "
+               << "\"max\": " << e.max << ", "
+               << "\"ranks\": " << e.ranks << "}";
+        }
+        os << "\n}\n";
+    }
+
+
+    void PerformanceLog::writeCSV(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        os << "name,type,samples,total,mean,min,max,ranks\n";
+        for (std::map<std::string, Entry>::const_iterator it = entries_.begin();
+             it != entries_.end(); ++it) {
+            const Entry& e = it->second;
+            os << it->first << ',' << (e.is_timer ? "timer" : "counter") << ','
+               << e.samples << ',' << e.total << ',' << mean(e) << ','
+               << e.min << ',' << e.max << ',' << e.ranks << '\n';
+        }
+    }
+
+
+    void PerformanceLog::writeReport(const std::string& filename) const
+    {
+        std::ofstream os(filename.c_str());
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Could not open timing report file " << filename);
+        }
+        const std::string ext = ".csv";
+        if (filename.size() >= ext.size()
+            && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0) {
+            writeCSV(os);
+        } else {
+            writeJSON(os);
+        }
+    }
+
+} // namespace Opm
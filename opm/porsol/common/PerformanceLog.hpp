@@ -0,0 +1,118 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PERFORMANCELOG_HEADER
+#define OPM_PERFORMANCELOG_HEADER
+
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace Opm
+{
+
+    /// Wall-clock time in seconds since an arbitrary fixed point.
+    double wallClockTime();
+
+    /// @brief Named wall-clock timings and counters.
+    ///
+    /// Every call to addTime() or addCount() is one sample of the named
+    /// entry. Samples may be added concurrently from several threads,
+    /// and the entries of all MPI ranks can be merged with gatherRanks().
+    /// Entries are meant for coarse steps such as a linear solve or a
+    /// pressure point, not for per-cell work.
+    class PerformanceLog
+    {
+    public:
+        struct Entry
+        {
+            Entry();
+            bool is_timer;
+            long samples;
+            double total;
+            double min;
+            double max;
+            int ranks;
+        };
+
+        /// The log used by the library code.
+        static PerformanceLog& global();
+
+        void addTime(const std::string& name, double seconds);
+        void addCount(const std::string& name, double count);
+        void clear();
+
+        /// Entry for name, or an empty entry if there are no samples.
+        Entry entry(const std::string& name) const;
+
+        /// Merge the entries of all MPI ranks onto rank 0. Collective,
+        /// must be called by all ranks. Without MPI, does nothing.
+        void gatherRanks();
+
+        /// One object per entry, keyed on the entry name.
+        void writeJSON(std::ostream& os) const;
+        /// One line per entry, with a header line.
+        void writeCSV(std::ostream& os) const;
+        /// Writes CSV if filename ends in ".csv", JSON otherwise.
+        void writeReport(const std::string& filename) const;
+
+    private:
+        void add(const std::string& name, bool is_timer, double value);
+        static void merge(Entry& into, const Entry& from);
+
+        std::map<std::string, Entry> entries_;
+        mutable std::mutex mutex_;
+    };
+
+
+    /// Adds the wall-clock time between construction and destruction
+    /// to the named entry of a PerformanceLog.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const std::string& name,
+                             PerformanceLog& log = PerformanceLog::global())
+            : name_(name), log_(log), start_(wallClockTime())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            log_.addTime(name_, elapsed());
+        }
+
+        /// Seconds since construction.
+        double elapsed() const
+        {
+            return wallClockTime() - start_;
+        }
+
+    private:
+        ScopedTimer(const ScopedTimer&);
+        ScopedTimer& operator=(const ScopedTimer&);
+
+        std::string name_;
+        PerformanceLog& log_;
+        double start_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_PERFORMANCELOG_HEADER
@@ -59,6 +59,10 @@ namespace Opm
 	{
 	    mob = 1.0/m.mob;
 	}
+	void setTo(const ScalarMobility& m)
+	{
+	    mob = m.mob;
+	}
 	template <class Vec>
 	Vec multiply(const Vec& v)
 	{
@@ -125,6 +129,14 @@ namespace Opm
         template<class Vector>
         void phaseMobilitiesDeriv(int c, double s, Vector& dmob) const;
 
+        /// @brief Batched evaluation of the saturation functions in the cells [begin, end).
+        /// Same as ReservoirPropertyCommon::saturationFunctions(), but looks up the
+        /// rock once per cell and shares the relperm values between all outputs.
+        template <class Mobility>
+        void saturationFunctions(int begin, int end, const double* saturation,
+                                 Mobility* mob_first, Mobility* mob_second,
+                                 double* frac_flow, double* cap_press) const;
+
 	/// @brief Computes cfl factors. Called from ReservoirPropertyCommon::init().
         void computeCflFactors();
     private:
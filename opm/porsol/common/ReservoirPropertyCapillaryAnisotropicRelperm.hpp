@@ -77,6 +77,10 @@ namespace Opm
 	    tensor_storage_ = m.tensor_storage_;
 	    invert(mob);
 	}
+	void setTo(const TensorMobility& m)
+	{
+	    tensor_storage_ = m.tensor_storage_;
+	}
 	template <class Vec>
 	Vec multiply(const Vec& v)
 	{
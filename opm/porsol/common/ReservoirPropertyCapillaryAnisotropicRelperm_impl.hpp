@@ -48,7 +48,7 @@ namespace Opm
 									  double saturation,
 									  MatrixType& phase_mob) const
     {
-	const int region = Super::rock_.size() > 0 ? Super::cell_to_rock_[cell_index] : -1;
+	const int region = Super::static_data_->rock.size() > 0 ? Super::static_data_->cell_to_rock[cell_index] : -1;
 	phaseMobilityByRock(phase_index, region, saturation, phase_mob);
     }
 
@@ -84,8 +84,8 @@ namespace Opm
 
 	double visc = phase_index == 0 ? Super::viscosity1_ : Super::viscosity2_;
 	if (rock_index != -1) {
-	    assert (rock_index < int(Super::rock_.size()));
-	    Super::rock_[rock_index].kr(phase_index, saturation, phase_mob);
+	    assert (rock_index < int(Super::static_data_->rock.size()));
+	    Super::static_data_->rock[rock_index].kr(phase_index, saturation, phase_mob);
 	    //using namespace boost::lambda;
 	    std::transform(phase_mob.data(), phase_mob.data() + dim*dim,
 			   phase_mob.data(), boost::lambda::_1/visc);
@@ -153,7 +153,7 @@ namespace Opm
     template <int dim>
     void ReservoirPropertyCapillaryAnisotropicRelperm<dim>::computeCflFactors()
     {
-        if (Super::rock_.empty()) {
+        if (Super::static_data_->rock.empty()) {
             std::array<double, 3> fac = computeSingleRockCflFactors(-1);
             Super::cfl_factor_ = fac[0];
             Super::cfl_factor_gravity_ = fac[1];
@@ -162,7 +162,7 @@ namespace Opm
             Super::cfl_factor_ = 1e100;
             Super::cfl_factor_gravity_ = 1e100;
             Super::cfl_factor_capillary_ = 1e100;
-            for (int r = 0; r < int(Super::rock_.size()); ++r) {
+            for (int r = 0; r < int(Super::static_data_->rock.size()); ++r) {
                 std::array<double, 3> fac = computeSingleRockCflFactors(r);
                 Super::cfl_factor_ = std::min(Super::cfl_factor_, fac[0]);
                 Super::cfl_factor_gravity_ = std::min(Super::cfl_factor_gravity_, fac[1]);
@@ -111,17 +111,58 @@ namespace Opm
 
 
 
+    template <int dim>
+    template <class Mobility>
+    void ReservoirPropertyCapillary<dim>::saturationFunctions(int begin, int end,
+                                                              const double* saturation,
+                                                              Mobility* mob_first,
+                                                              Mobility* mob_second,
+                                                              double* frac_flow,
+                                                              double* cap_press) const
+    {
+        const bool has_rock = !Super::static_data_->rock.empty();
+        for (int c = begin; c < end; ++c) {
+            const double s = saturation[c];
+            double krw, kro;
+            if (has_rock) {
+                const RockJfunc& rock = Super::static_data_->rock[Super::static_data_->cell_to_rock[c]];
+                rock.krw(s, krw);
+                rock.kro(s, kro);
+            } else {
+                // Same quadratic rel-perms as relPermFirstPhase() and relPermSecondPhase().
+                krw = s * s;
+                kro = (1 - s) * (1 - s);
+            }
+            const double l1 = krw / Super::viscosity1_;
+            const double l2 = kro / Super::viscosity2_;
+            if (mob_first) {
+                mob_first[c].mob = l1;
+            }
+            if (mob_second) {
+                mob_second[c].mob = l2;
+            }
+            if (frac_flow) {
+                frac_flow[c] = l1/(l1 + l2);
+            }
+            if (cap_press) {
+                cap_press[c] = Super::capillaryPressure(c, s);
+            }
+        }
+    }
+
+
+
     // ------ Private methods ------
 
 
     template <int dim>
     double ReservoirPropertyCapillary<dim>::relPermFirstPhase(int cell_index, double saturation) const
     {
-        if (Super::rock_.size() > 0) {
-            const int region = Super::cell_to_rock_[cell_index];
-            assert (region < int(Super::rock_.size()));
+        if (Super::static_data_->rock.size() > 0) {
+            const int region = Super::static_data_->cell_to_rock[cell_index];
+            assert (region < int(Super::static_data_->rock.size()));
 	    double res;
-	    Super::rock_[region].krw(saturation, res);
+	    Super::static_data_->rock[region].krw(saturation, res);
             return res;
         } else {
             // HACK ALERT!
@@ -135,11 +176,11 @@ namespace Opm
     ReservoirPropertyCapillary<dim>::
     relPermFirstPhaseDeriv(int cell_index, double saturation) const
     {
-        if (Super::rock_.size() > 0) {
-            const int region = Super::cell_to_rock_[cell_index];
-            assert (region < int(Super::rock_.size()));
+        if (Super::static_data_->rock.size() > 0) {
+            const int region = Super::static_data_->cell_to_rock[cell_index];
+            assert (region < int(Super::static_data_->rock.size()));
             double res;
-            Super::rock_[region].dkrw(saturation, res);
+            Super::static_data_->rock[region].dkrw(saturation, res);
             return res;
         } else {
             // HACK ALERT!
@@ -154,11 +195,11 @@ namespace Opm
     template <int dim>
     double ReservoirPropertyCapillary<dim>::relPermSecondPhase(int cell_index, double saturation) const
     {
-        if (Super::rock_.size() > 0) {
-            const int region = Super::cell_to_rock_[cell_index];
-            assert (region < int(Super::rock_.size()));
+        if (Super::static_data_->rock.size() > 0) {
+            const int region = Super::static_data_->cell_to_rock[cell_index];
+            assert (region < int(Super::static_data_->rock.size()));
 	    double res;
-	    Super::rock_[region].kro(saturation, res);
+	    Super::static_data_->rock[region].kro(saturation, res);
             return res;
         } else {
             // HACK ALERT!
@@ -172,11 +213,11 @@ namespace Opm
     ReservoirPropertyCapillary<dim>::
     relPermSecondPhaseDeriv(int cell_index, double saturation) const
     {
-        if (Super::rock_.size() > 0) {
-            const int region = Super::cell_to_rock_[cell_index];
-            assert (region < int(Super::rock_.size()));
+        if (Super::static_data_->rock.size() > 0) {
+            const int region = Super::static_data_->cell_to_rock[cell_index];
+            assert (region < int(Super::static_data_->rock.size()));
             double res;
-            Super::rock_[region].dkro(saturation, res);
+            Super::static_data_->rock[region].dkro(saturation, res);
             return res;
         } else {
             // HACK ALERT!
@@ -199,8 +240,8 @@ namespace Opm
             ff_gravity = l1*l2/(l1 + l2);
         } else {
             double krw, kro;
-	    Super::rock_[rock].krw(s, krw);
-            Super::rock_[rock].kro(s, kro);
+	    Super::static_data_->rock[rock].krw(s, krw);
+            Super::static_data_->rock[rock].kro(s, kro);
             double l1 = krw/Super::viscosity1_;
             double l2 = kro/Super::viscosity2_;
             ff_first = l1/(l1 + l2);
@@ -228,7 +269,7 @@ namespace Opm
         cflFracFlows(rock, 0.0, last_ff1, last_ffg);
         double max_ffg = last_ffg;
         double max_derpc = rock == -1 ? 0.0 :
-            std::fabs(Super::rock_[rock].capPressDeriv(min_perm_matrix, max_poro, 0.0));
+            std::fabs(Super::static_data_->rock[rock].capPressDeriv(min_perm_matrix, max_poro, 0.0));
         for (int i = 1; i < N; ++i) {
             double s = double(i)*delta;
             double ff1, ffg;
@@ -239,7 +280,7 @@ namespace Opm
             max_derg = std::max(max_derg, est_deriv_ffg);
             max_ffg = std::max(max_ffg, ffg);
             max_derpc = rock == -1 ? 0.0 :
-                std::max(max_derpc, std::fabs(Super::rock_[rock].capPressDeriv(min_perm_matrix, max_poro, s)));
+                std::max(max_derpc, std::fabs(Super::static_data_->rock[rock].capPressDeriv(min_perm_matrix, max_poro, s)));
             last_ff1 = ff1;
             last_ffg = ffg;
         }
@@ -253,25 +294,25 @@ namespace Opm
     template <int dim>
     void ReservoirPropertyCapillary<dim>::computeCflFactors()
     {
-        if (Super::rock_.empty()) {
+        if (Super::static_data_->rock.empty()) {
             std::array<double, 3> fac = computeSingleRockCflFactors(-1, 0.0, 0.0);
             Super::cfl_factor_ = fac[0];
             Super::cfl_factor_gravity_ = fac[1];
             Super::cfl_factor_capillary_ = fac[2];
         } else {
             // Compute min perm and max poro per rock (for J-scaling cap pressure funcs).
-            std::vector<double> min_perm(Super::rock_.size(), 1e100);
-            std::vector<double> max_poro(Super::rock_.size(), 0.0);
-            int num_cells = Super::porosity_.size();
+            std::vector<double> min_perm(Super::static_data_->rock.size(), 1e100);
+            std::vector<double> max_poro(Super::static_data_->rock.size(), 0.0);
+            int num_cells = Super::static_data_->porosity.size();
             for (int c = 0; c < num_cells; ++c) {
-                int r = Super::cell_to_rock_[c];
+                int r = Super::static_data_->cell_to_rock[c];
                 min_perm[r] = std::min(min_perm[r], trace(Super::permeability(c))/double(dim));
                 max_poro[r] = std::max(max_poro[r], Super::porosity(c));
             }
             Super::cfl_factor_ = 1e100;
             Super::cfl_factor_gravity_ = 1e100;
             Super::cfl_factor_capillary_ = 0.0;
-            for (int r = 0; r < int(Super::rock_.size()); ++r) {
+            for (int r = 0; r < int(Super::static_data_->rock.size()); ++r) {
                 std::array<double, 3> fac = computeSingleRockCflFactors(r, min_perm[r], max_poro[r]);
                 Super::cfl_factor_ = std::min(Super::cfl_factor_, fac[0]);
                 Super::cfl_factor_gravity_ = std::min(Super::cfl_factor_gravity_, fac[1]);
@@ -41,6 +41,8 @@
 
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 
+#include <memory>
+
 namespace Opm
 {
 
@@ -49,6 +51,10 @@ namespace Opm
     /// @brief Enum for the kind of permeability field originally retrieved.
     enum PermeabilityKind { ScalarPerm, DiagonalPerm, TensorPerm, None, Invalid };
 
+    /// @brief Enum for how the permeability field is stored, full dim x dim
+    ///        tensors or only their diagonals.
+    enum PermeabilityStorage { FullPermStorage, DiagonalPermStorage };
+
 
 
 
@@ -58,8 +64,10 @@ namespace Opm
     class ReservoirPropertyCommon
     {
     public:
-        /// @brief Tensor type for read-only access to permeability.
-        typedef ImmutableCMatrix PermTensor;
+        /// @brief Tensor type for read-only access to permeability. A view
+        /// into the field for full storage, an inline copy for diagonal
+        /// storage.
+        typedef InlineCMatrix    PermTensor;
         /// @brief Tensor type to be used for holding copies of permeability tensors.
         typedef OwnCMatrix       MutablePermTensor;
         /// @brief Tensor type for read and write access to permeability.
@@ -108,6 +116,13 @@ namespace Opm
         /// @param d2 the densitity of the second (oil) phase.
         void setDensities(double d1, double d2);
 
+        /// @brief Use uniformly sampled rock tables with O(1) lookup.
+        /// @param num_intervals initial number of sample intervals per curve,
+        ///                      zero restores the exact tables.
+        /// @param tolerance interpolation error bound, relative to the
+        ///                  range of each curve.
+        void setSampledRockTables(int num_intervals, double tolerance);
+
 	/// @brief Viscosity of first (water) phase.
 	/// @return the viscosity value.
         double viscosityFirstPhase() const;
@@ -150,10 +165,32 @@ namespace Opm
         PermTensor permeability(int cell_index) const;
 
         /// @brief Read- and write-access to permeability. Use with caution.
+        /// Switches to full tensor storage if only diagonals are stored.
         /// @param cell_index index of a grid cell.
         /// @return permeability value of the cell.
 	SharedPermTensor permeabilityModifiable(int cell_index);
 
+        /// @brief Assign the permeability of a cell. Keeps diagonal storage
+        /// if the tensor is diagonal, otherwise switches to full storage.
+        /// @param cell_index index of a grid cell.
+        /// @param K the new permeability tensor of the cell.
+        template<class Tensor>
+        void setPermeability(int cell_index, const Tensor& K);
+
+        /// @brief Copy all permeability tensors into one array.
+        /// @param[out] perm dim*dim values per cell, C ordered.
+        void permeabilityField(std::vector<double>& perm) const;
+
+        /// @brief How the permeability field is stored.
+        PermeabilityStorage permeabilityStorage() const;
+
+        /// @brief Change how the permeability field is stored. Diagonal
+        /// storage uses dim instead of dim*dim values per cell, and is
+        /// chosen by init() when the input has no off-diagonal components.
+        /// @param storage the new storage mode. Throws if diagonal storage
+        ///                is requested for a field with off-diagonal components.
+        void setPermeabilityStorage(PermeabilityStorage storage);
+
         /// @brief Densities for both phases.
 	/// @tparam Vector a class with size() and operator[].
         /// @param cell_index index of a grid cell (not used).
@@ -199,6 +236,19 @@ namespace Opm
         /// @return maximum saturation in given cell.
         double s_max(int c) const;
 
+        /// @brief Batched evaluation of the saturation functions in the cells [begin, end).
+        /// The output arrays are indexed by cell, and null outputs are skipped.
+        /// @tparam Mobility the mobility type of the implementing class.
+        /// @param saturation cell saturations, indexed by cell.
+        /// @param[out] mob_first mobilities of the first phase.
+        /// @param[out] mob_second mobilities of the second phase.
+        /// @param[out] frac_flow fractional flows of the first phase.
+        /// @param[out] cap_press capillary pressures.
+        template <class Mobility>
+        void saturationFunctions(int begin, int end, const double* saturation,
+                                 Mobility* mob_first, Mobility* mob_second,
+                                 double* frac_flow, double* cap_press) const;
+
         /// @brief Inverse of the capillary pressure function.
         /// @param cell_index index of a grid cell.
         /// @param cap_press a capillary pressure value.
@@ -229,13 +279,27 @@ namespace Opm
 	// Supporting Barton/Nackman trick (also known as the curiously recurring template pattern).
 	RPImpl& asImpl();
 
+        // Rock tables and per-cell data that do not change after init().
+        // Copies share them, so that several copies with different
+        // permeabilities (see UpscalerBase::initWorker()) hold them once.
+        struct StaticData {
+            std::vector<double>   porosity;
+            std::vector<double>   ntg;
+            std::vector<double>   swcr;
+            std::vector<double>   sowcr;
+            std::vector<RockType> rock;
+            std::vector<int>      cell_to_rock;
+        };
+
+        // Write access to the static data. Unshares it first if it is
+        // shared with a copy.
+        StaticData& modifiableStaticData();
+
 	// Data members.
-        std::vector<double>        porosity_;
-        std::vector<double>        ntg_;
-        std::vector<double>        swcr_;
-        std::vector<double>        sowcr_;
+        std::shared_ptr<StaticData> static_data_;
         std::vector<double>        permeability_;
         std::vector<unsigned char> permfield_valid_;
+        PermeabilityStorage        perm_storage_;
         double density1_;
         double density2_;
         double viscosity1_;
@@ -243,8 +307,6 @@ namespace Opm
         double cfl_factor_;
         double cfl_factor_gravity_;
         double cfl_factor_capillary_;
-        std::vector<RockType> rock_;
-        std::vector<int> cell_to_rock_;
         PermeabilityKind permeability_kind_;
     };
 
@@ -256,13 +256,15 @@ namespace Opm
 
     template <int dim, class RPImpl, class RockType>
     ReservoirPropertyCommon<dim, RPImpl, RockType>::ReservoirPropertyCommon()
+        : static_data_(std::make_shared<StaticData>()),
+          perm_storage_(FullPermStorage),
 #if 1
-        : density1_  (1013.9*Opm::unit::kilogram/Opm::unit::cubic(Opm::unit::meter)),
+          density1_  (1013.9*Opm::unit::kilogram/Opm::unit::cubic(Opm::unit::meter)),
           density2_  ( 834.7*Opm::unit::kilogram/Opm::unit::cubic(Opm::unit::meter)),
           viscosity1_(   1.0*Opm::prefix::centi*Opm::unit::Poise),
           viscosity2_(   3.0*Opm::prefix::centi*Opm::unit::Poise),
 #else
-        : density1_  (1000.0*Opm::unit::kilogram/Opm::unit::cubic(Opm::unit::meter)),
+          density1_  (1000.0*Opm::unit::kilogram/Opm::unit::cubic(Opm::unit::meter)),
           density2_  (1000.0*Opm::unit::kilogram/Opm::unit::cubic(Opm::unit::meter)),
           viscosity1_(   1000.0*Opm::prefix::centi*Opm::unit::Poise),
           viscosity2_(   1000.0*Opm::prefix::centi*Opm::unit::Poise),
@@ -302,11 +304,12 @@ namespace Opm
         // may care about J-scaling. They still have to implement
         // setUseJfunctionScaling() and setSigmaAndTheta(), though the
         // latter may throw if called for a rock where it does not make sense.
-        int num_rocks = rock_.size();
+        StaticData& sd = modifiableStaticData();
+        int num_rocks = sd.rock.size();
         for (int i = 0; i < num_rocks; ++i) {
-            rock_[i].setUseJfunctionScaling(use_jfunction_scaling);
+            sd.rock[i].setUseJfunctionScaling(use_jfunction_scaling);
             if (use_jfunction_scaling) {
-                rock_[i].setSigmaAndTheta(sigma, theta);
+                sd.rock[i].setSigmaAndTheta(sigma, theta);
             }
         }
         // End of added section.
@@ -321,19 +324,26 @@ namespace Opm
                                                               const double uniform_poro,
                                                               const double uniform_perm)
     {
+        StaticData& sd = modifiableStaticData();
         permfield_valid_.assign(num_cells, std::vector<unsigned char>::value_type(1));
-        porosity_.assign(num_cells, uniform_poro);
-        permeability_.assign(dim*dim*num_cells, 0.0);
-        for (int i = 0; i < num_cells; ++i) {
-            SharedPermTensor K = permeabilityModifiable(i);
-            for (int dd = 0; dd < dim; ++dd) {
-                K(dd, dd) = uniform_perm;
-            }
-        }
-        cell_to_rock_.assign(num_cells, 0);
+        sd.porosity.assign(num_cells, uniform_poro);
+        perm_storage_ = DiagonalPermStorage;
+        permeability_.assign(dim*num_cells, uniform_perm);
+        sd.cell_to_rock.assign(num_cells, 0);
         asImpl().computeCflFactors();
     }
 
+    template <int dim, class RPImpl, class RockType>
+    void ReservoirPropertyCommon<dim, RPImpl, RockType>::setSampledRockTables(int num_intervals,
+                                                                              double tolerance)
+    {
+        StaticData& sd = modifiableStaticData();
+        int num_rocks = sd.rock.size();
+        for (int i = 0; i < num_rocks; ++i) {
+            sd.rock[i].setSampledTables(num_intervals, tolerance);
+        }
+    }
+
     template <int dim, class RPImpl, class RockType>
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::setViscosities(double v1, double v2)
     {
@@ -379,25 +389,25 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::porosity(int cell_index) const
     {
-        return porosity_[cell_index];
+        return static_data_->porosity[cell_index];
     }
 
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::ntg(int cell_index) const
     {
-        return ntg_[cell_index];
+        return static_data_->ntg[cell_index];
     }
 
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::swcr(int cell_index) const
     {
-        return swcr_[cell_index];
+        return static_data_->swcr[cell_index];
     }
 
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::sowcr(int cell_index) const
     {
-        return sowcr_[cell_index];
+        return static_data_->sowcr[cell_index];
     }
 
 
@@ -407,8 +417,14 @@ namespace Opm
     {
         assert (permfield_valid_[cell_index]);
 
-        const PermTensor K(dim, dim, &permeability_[dim*dim*cell_index]);
-        return K;
+        if (perm_storage_ == DiagonalPermStorage) {
+            double k[dim*dim] = { 0.0 };
+            for (int dd = 0; dd < dim; ++dd) {
+                k[(dim + 1)*dd] = permeability_[dim*cell_index + dd];
+            }
+            return PermTensor(dim, dim, InlineCopy<double>(k));
+        }
+        return PermTensor(dim, dim, &permeability_[dim*dim*cell_index]);
     }
 
 
@@ -417,6 +433,9 @@ namespace Opm
     ReservoirPropertyCommon<dim, RPImpl, RockType>::permeabilityModifiable(int cell_index)
     {
         // Typically only used for assigning synthetic perm values.
+        // The caller may write off-diagonal components, so the
+        // diagonal storage cannot be kept.
+        setPermeabilityStorage(FullPermStorage);
         SharedPermTensor K(dim, dim, &permeability_[dim*dim*cell_index]);
 
         // Trust caller!
@@ -426,6 +445,95 @@ namespace Opm
     }
 
 
+    template <int dim, class RPImpl, class RockType>
+    template<class Tensor>
+    void ReservoirPropertyCommon<dim, RPImpl, RockType>::setPermeability(int cell_index,
+                                                                         const Tensor& K)
+    {
+        if (perm_storage_ == DiagonalPermStorage) {
+            bool diagonal = true;
+            for (int i = 0; i < dim; ++i) {
+                for (int j = 0; j < dim; ++j) {
+                    if (i != j && K(i,j) != 0.0) {
+                        diagonal = false;
+                    }
+                }
+            }
+            if (diagonal) {
+                for (int dd = 0; dd < dim; ++dd) {
+                    permeability_[dim*cell_index + dd] = K(dd,dd);
+                }
+                permfield_valid_[cell_index] = std::vector<unsigned char>::value_type(1);
+                return;
+            }
+        }
+        SharedPermTensor Kc = permeabilityModifiable(cell_index);
+        for (int i = 0; i < dim; ++i) {
+            for (int j = 0; j < dim; ++j) {
+                Kc(i,j) = K(i,j);
+            }
+        }
+    }
+
+
+    template <int dim, class RPImpl, class RockType>
+    void ReservoirPropertyCommon<dim, RPImpl, RockType>::permeabilityField(std::vector<double>& perm) const
+    {
+        if (perm_storage_ == FullPermStorage) {
+            perm = permeability_;
+            return;
+        }
+        const int num_cells = permeability_.size()/dim;
+        perm.assign(dim*dim*num_cells, 0.0);
+        for (int c = 0; c < num_cells; ++c) {
+            for (int dd = 0; dd < dim; ++dd) {
+                perm[dim*dim*c + (dim + 1)*dd] = permeability_[dim*c + dd];
+            }
+        }
+    }
+
+
+    template <int dim, class RPImpl, class RockType>
+    PermeabilityStorage ReservoirPropertyCommon<dim, RPImpl, RockType>::permeabilityStorage() const
+    {
+        return perm_storage_;
+    }
+
+
+    template <int dim, class RPImpl, class RockType>
+    void ReservoirPropertyCommon<dim, RPImpl, RockType>::setPermeabilityStorage(PermeabilityStorage storage)
+    {
+        if (storage == perm_storage_) {
+            return;
+        }
+        if (storage == FullPermStorage) {
+            std::vector<double> full;
+            permeabilityField(full);
+            permeability_.swap(full);
+        } else {
+            const int num_cells = permeability_.size()/(dim*dim);
+            for (int c = 0; c < num_cells; ++c) {
+                for (int i = 0; i < dim; ++i) {
+                    for (int j = 0; j < dim; ++j) {
+                        if (i != j && permeability_[dim*dim*c + dim*i + j] != 0.0) {
+                            OPM_THROW(std::runtime_error, "Cell " << c << " has off-diagonal "
+                                      "permeability, cannot use diagonal storage.");
+                        }
+                    }
+                }
+            }
+            std::vector<double> diag(dim*num_cells);
+            for (int c = 0; c < num_cells; ++c) {
+                for (int dd = 0; dd < dim; ++dd) {
+                    diag[dim*c + dd] = permeability_[dim*dim*c + (dim + 1)*dd];
+                }
+            }
+            permeability_.swap(diag);
+        }
+        perm_storage_ = storage;
+    }
+
+
     template <int dim, class RPImpl, class RockType>
     template<class Vector>
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::phaseDensities(int /*cell_index*/, Vector& density) const
@@ -466,9 +574,9 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::capillaryPressure(int cell_index, double saturation) const
         {
-            if (rock_.size() > 0) {
-                int r = cell_to_rock_[cell_index];
-                return rock_[r].capPress(permeability(cell_index), porosity(cell_index), saturation);
+            if (static_data_->rock.size() > 0) {
+                int r = static_data_->cell_to_rock[cell_index];
+                return static_data_->rock[r].capPress(permeability(cell_index), porosity(cell_index), saturation);
             } else {
                 // HACK ALERT!
                 // Use zero capillary pressure if no known rock table exists.
@@ -476,12 +584,40 @@ namespace Opm
             }
     }
 
+    template <int dim, class RPImpl, class RockType>
+    template <class Mobility>
+    void ReservoirPropertyCommon<dim, RPImpl, RockType>::saturationFunctions(int begin, int end,
+                                                                            const double* saturation,
+                                                                            Mobility* mob_first,
+                                                                            Mobility* mob_second,
+                                                                            double* frac_flow,
+                                                                            double* cap_press) const
+    {
+        // Generic version, implementations may provide a fused one.
+        const RPImpl& impl = static_cast<const RPImpl&>(*this);
+        for (int c = begin; c < end; ++c) {
+            const double s = saturation[c];
+            if (mob_first) {
+                impl.phaseMobility(0, c, s, mob_first[c].mob);
+            }
+            if (mob_second) {
+                impl.phaseMobility(1, c, s, mob_second[c].mob);
+            }
+            if (frac_flow) {
+                frac_flow[c] = impl.fractionalFlow(c, s);
+            }
+            if (cap_press) {
+                cap_press[c] = capillaryPressure(c, s);
+            }
+        }
+    }
+
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::capillaryPressureDeriv(int cell_index, double saturation) const
     {
-        if (rock_.size() > 0) {
-            int r = cell_to_rock_[cell_index];
-            double dpc = rock_[r].capPressDeriv(permeability(cell_index), porosity(cell_index), saturation);
+        if (static_data_->rock.size() > 0) {
+            int r = static_data_->cell_to_rock[cell_index];
+            double dpc = static_data_->rock[r].capPressDeriv(permeability(cell_index), porosity(cell_index), saturation);
             return dpc;
         } else {
             // HACK ALERT!
@@ -492,9 +628,9 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::s_min(int cell_index) const
     {
-        if (rock_.size() > 0) {
-            int r = cell_to_rock_[cell_index];
-            return rock_[r].s_min();
+        if (static_data_->rock.size() > 0) {
+            int r = static_data_->cell_to_rock[cell_index];
+            return static_data_->rock[r].s_min();
         } else {
             // HACK ALERT!
             // Use zero as minimum saturation if no known rock table exists.
@@ -505,9 +641,9 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::s_max(int cell_index) const
     {
-        if (rock_.size() > 0) {
-            int r = cell_to_rock_[cell_index];
-            return rock_[r].s_max();
+        if (static_data_->rock.size() > 0) {
+            int r = static_data_->cell_to_rock[cell_index];
+            return static_data_->rock[r].s_max();
         } else {
             // HACK ALERT!
             // Use 1 as maximum saturation if no known rock table exists.
@@ -518,9 +654,9 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     double ReservoirPropertyCommon<dim, RPImpl, RockType>::saturationFromCapillaryPressure(int cell_index, double cap_press) const
     {
-        if (rock_.size() > 0) {
-            int r = cell_to_rock_[cell_index];
-            return rock_[r].satFromCapPress(permeability(cell_index), porosity(cell_index), cap_press);
+        if (static_data_->rock.size() > 0) {
+            int r = static_data_->cell_to_rock[cell_index];
+            return static_data_->rock[r].satFromCapPress(permeability(cell_index), porosity(cell_index), cap_press);
         } else {
             // HACK ALERT!
             // Use a zero saturation if no known rock table exists.
@@ -532,7 +668,7 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::writeSintefLegacyFormat(const std::string& grid_prefix) const
     {
-        int num_cells = porosity_.size();
+        int num_cells = static_data_->porosity.size();
         // Write porosity.
         {
             std::string filename = grid_prefix + "-poro.dat";
@@ -541,7 +677,7 @@ namespace Opm
                 OPM_THROW(std::runtime_error, "Could not open file " << filename);
             }
             file << num_cells << '\n';
-            std::copy(porosity_.begin(), porosity_.end(), std::ostream_iterator<double>(file, "\n"));
+            std::copy(static_data_->porosity.begin(), static_data_->porosity.end(), std::ostream_iterator<double>(file, "\n"));
         }
         // Write permeability.
         {
@@ -551,15 +687,17 @@ namespace Opm
                 OPM_THROW(std::runtime_error, "Could not open file " << filename);
             }
             file << num_cells << '\n';
+            std::vector<double> perm;
+            permeabilityField(perm);
             switch (permeability_kind_) {
             case TensorPerm:
-                std::copy(permeability_.begin(), permeability_.end(), std::ostream_iterator<double>(file, "\n"));
+                std::copy(perm.begin(), perm.end(), std::ostream_iterator<double>(file, "\n"));
                 break;
             case DiagonalPerm:
                 for (int c = 0; c < num_cells; ++c) {
                     int index = c*dim*dim;
                     for (int dd = 0; dd < dim; ++dd) {
-                        file << permeability_[index + (dim + 1)*dd] << ' ';
+                        file << perm[index + (dim + 1)*dd] << ' ';
                     }
                     file << '\n';
                 }
@@ -567,7 +705,7 @@ namespace Opm
             case ScalarPerm:
             case None: // Treated like a scalar permeability.
                 for (int c = 0; c < num_cells; ++c) {
-                    file << permeability_[c*dim*dim] << '\n';
+                    file << perm[c*dim*dim] << '\n';
                 }
                 break;
             default:
@@ -589,11 +727,25 @@ namespace Opm
 
 
 
+    template <int dim, class RPImpl, class RockType>
+    typename ReservoirPropertyCommon<dim, RPImpl, RockType>::StaticData&
+    ReservoirPropertyCommon<dim, RPImpl, RockType>::modifiableStaticData()
+    {
+        if (static_data_.use_count() > 1) {
+            static_data_ = std::make_shared<StaticData>(*static_data_);
+        }
+        return *static_data_;
+    }
+
+
+
+
     template <int dim, class RPImpl, class RockType>
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::assignPorosity(const Opm::Deck& deck,
                                                                         const std::vector<int>& global_cell)
     {
-        porosity_.assign(global_cell.size(), 1.0);
+        StaticData& sd = modifiableStaticData();
+        sd.porosity.assign(global_cell.size(), 1.0);
 
         if (deck.hasKeyword("PORO")) {
             Opm::EclipseGridInspector insp(deck);
@@ -605,8 +757,8 @@ namespace Opm
                       "logical cartesian size of the grid: "
                       << poro.size() << " != " << num_global_cells);
             }
-            for (int c = 0; c < int(porosity_.size()); ++c) {
-                porosity_[c] = poro[global_cell[c]];
+            for (int c = 0; c < int(sd.porosity.size()); ++c) {
+                sd.porosity[c] = poro[global_cell[c]];
             }
         }
     }
@@ -615,7 +767,8 @@ namespace Opm
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::assignNTG(const Opm::Deck& deck,
                                                                    const std::vector<int>& global_cell)
     {
-        ntg_.assign(global_cell.size(), 1.0);
+        StaticData& sd = modifiableStaticData();
+        sd.ntg.assign(global_cell.size(), 1.0);
 
         if (deck.hasKeyword("NTG")) {
             Opm::EclipseGridInspector insp(deck);
@@ -627,8 +780,8 @@ namespace Opm
                       "logical cartesian size of the grid: "
                       << ntg.size() << " != " << num_global_cells);
             }
-            for (int c = 0; c < int(ntg_.size()); ++c) {
-                ntg_[c] = ntg[global_cell[c]];
+            for (int c = 0; c < int(sd.ntg.size()); ++c) {
+                sd.ntg[c] = ntg[global_cell[c]];
             }
         }
     }
@@ -637,7 +790,8 @@ namespace Opm
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::assignSWCR(const Opm::Deck& deck,
                                                                     const std::vector<int>& global_cell)
     {
-        swcr_.assign(global_cell.size(), 0.0);
+        StaticData& sd = modifiableStaticData();
+        sd.swcr.assign(global_cell.size(), 0.0);
 
         if (deck.hasKeyword("SWCR")) {
             Opm::EclipseGridInspector insp(deck);
@@ -650,8 +804,8 @@ namespace Opm
                       "logical cartesian size of the grid: "
                       << swcr.size() << " != " << num_global_cells);
             }
-            for (int c = 0; c < int(swcr_.size()); ++c) {
-                swcr_[c] = swcr[global_cell[c]];
+            for (int c = 0; c < int(sd.swcr.size()); ++c) {
+                sd.swcr[c] = swcr[global_cell[c]];
             }
         }
     }
@@ -660,7 +814,8 @@ namespace Opm
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::assignSOWCR(const Opm::Deck& deck,
                                                                      const std::vector<int>& global_cell)
     {
-        sowcr_.assign(global_cell.size(), 0.0);
+        StaticData& sd = modifiableStaticData();
+        sd.sowcr.assign(global_cell.size(), 0.0);
 
         if (deck.hasKeyword("SOWCR")) {
             Opm::EclipseGridInspector insp(deck);
@@ -673,8 +828,8 @@ namespace Opm
                       "logical cartesian size of the grid: "
                       << sowcr.size() << " != " << num_global_cells);
             }
-            for (int c = 0; c < int(sowcr_.size()); ++c) {
-                sowcr_[c] = sowcr[global_cell[c]];
+            for (int c = 0; c < int(sd.sowcr.size()); ++c) {
+                sd.sowcr[c] = sowcr[global_cell[c]];
             }
         }
     }
@@ -689,8 +844,6 @@ namespace Opm
         int num_global_cells = dims[0]*dims[1]*dims[2];
         assert (num_global_cells > 0);
 
-        permeability_.assign(dim * dim * global_cell.size(), 0.0);
-
         std::vector<const std::vector<double>*> tensor;
         tensor.reserve(10);
 
@@ -700,6 +853,12 @@ namespace Opm
         static_assert(dim == 3, "");
         std::array<int,9> kmap;
         permeability_kind_ = fillTensor(deck, tensor, kmap);
+
+        // Only keep the diagonals unless the input has off-diagonal
+        // components.
+        perm_storage_ = (permeability_kind_ == TensorPerm) ? FullPermStorage : DiagonalPermStorage;
+        const int stride = (perm_storage_ == FullPermStorage) ? dim*dim : dim;
+        permeability_.assign(stride * global_cell.size(), 0.0);
         for (int i = 1; i < int(tensor.size()); ++i) {
             if (int(tensor[i]->size()) != num_global_cells) {
                 OPM_THROW(std::runtime_error, "All permeability fields must have the same size as the "
@@ -719,16 +878,24 @@ namespace Opm
             const int nc  = global_cell.size();
             int       off = 0;
 
-            for (int c = 0; c < nc; ++c, off += dim*dim) {
-                SharedPermTensor K(dim, dim, &permeability_[off]);
-                int       kix  = 0;
+            for (int c = 0; c < nc; ++c, off += stride) {
                 const int glob = global_cell[c];
 
-                for (int i = 0; i < dim; ++i) {
-                    for (int j = 0; j < dim; ++j, ++kix) {
-                        K(i,j) = (*tensor[kmap[kix]])[glob];
+                if (perm_storage_ == DiagonalPermStorage) {
+                    for (int i = 0; i < dim; ++i) {
+                        permeability_[off + i] = std::max((*tensor[kmap[(dim + 1)*i]])[glob],
+                                                          perm_threshold);
+                    }
+                } else {
+                    SharedPermTensor K(dim, dim, &permeability_[off]);
+                    int kix = 0;
+
+                    for (int i = 0; i < dim; ++i) {
+                        for (int j = 0; j < dim; ++j, ++kix) {
+                            K(i,j) = (*tensor[kmap[kix]])[glob];
+                        }
+                        K(i,i) = std::max(K(i,i), perm_threshold);
                     }
-                    K(i,i) = std::max(K(i,i), perm_threshold);
                 }
 
                 permfield_valid_[c] = std::vector<unsigned char>::value_type(1);
@@ -743,9 +910,10 @@ namespace Opm
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::assignRockTable(const Opm::Deck& deck,
                                                           const std::vector<int>& global_cell)
     {
+        StaticData& sd = modifiableStaticData();
         const int nc = global_cell.size();
 
-        cell_to_rock_.assign(nc, 0);
+        sd.cell_to_rock.assign(nc, 0);
 
         if (deck.hasKeyword("SATNUM")) {
             Opm::EclipseGridInspector insp(deck);
@@ -759,7 +927,7 @@ namespace Opm
             }
             for (int c = 0; c < nc; ++c) {
                 // Note: SATNUM is FORTRANish, ranging from 1 to n, therefore we subtract one.
-                cell_to_rock_[c] = satnum[global_cell[c]] - 1;
+                sd.cell_to_rock[c] = satnum[global_cell[c]] - 1;
             }
         }
         else if (deck.hasKeyword("ROCKTYPE")) {
@@ -774,7 +942,7 @@ namespace Opm
             }
             for (int c = 0; c < nc; ++c) {
                 // Note: ROCKTYPE is FORTRANish, ranging from 1 to n, therefore we subtract one.
-                cell_to_rock_[c] = satnum[global_cell[c]] - 1;
+                sd.cell_to_rock[c] = satnum[global_cell[c]] - 1;
             }
         }
     }
@@ -785,6 +953,7 @@ namespace Opm
     template <int dim, class RPImpl, class RockType>
     void ReservoirPropertyCommon<dim, RPImpl, RockType>::readRocks(const std::string& rock_list_file)
     {
+        StaticData& sd = modifiableStaticData();
         std::ifstream rl(rock_list_file.c_str());
         if (!rl) {
             OPM_THROW(std::runtime_error, "Could not open file " << rock_list_file);
@@ -792,14 +961,14 @@ namespace Opm
         int num_rocks = -1;
         rl >> num_rocks;
         assert(num_rocks >= 1);
-        rock_.resize(num_rocks);
+        sd.rock.resize(num_rocks);
         std::string dir(rock_list_file.begin(), rock_list_file.begin() + rock_list_file.find_last_of('/') + 1);
         for (int i = 0; i < num_rocks; ++i) {
             std::string spec;
             while (spec.empty()) {
                 std::getline(rl, spec);
             }
-            rock_[i].read(dir, spec);
+            sd.rock[i].read(dir, spec);
         }
     }
 
@@ -66,6 +66,13 @@ namespace Opm
             OPM_THROW(std::runtime_error, "RockAnisotropicRelperm cannot accept sigma and theta arguments.");
         }
 
+        void setSampledTables(const int num_intervals, const double)
+        {
+            if (num_intervals > 0) {
+                OPM_THROW(std::runtime_error, "RockAnisotropicRelperm cannot use sampled tables.");
+            }
+        }
+
 
 	template <template <class> class SP, class OP>
 	void kr(const int phase_index, const double saturation, FullMatrix<double, SP, OP>& kr_value) const
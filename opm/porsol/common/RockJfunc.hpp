@@ -39,6 +39,7 @@
 #include <dune/common/fvector.hh>
 #include <opm/core/utility/NonuniformTableLinear.hpp>
 #include <opm/porsol/common/Matrix.hpp>
+#include <opm/porsol/common/SampledTableLinear.hpp>
 
 #include <fstream>
 #include <vector>
@@ -67,24 +68,48 @@ namespace Opm
             sigma_cos_theta_ = sigma*std::cos(theta);
         }
 
+        /// Use uniformly sampled tables, with lookups not needing any
+        /// search, instead of the exact tables for krw, kro, J and the
+        /// inverse of J. Each curve starts with num_intervals intervals,
+        /// doubled until the interpolation error is below tolerance
+        /// relative to the range of the curve; a curve that does not get
+        /// there keeps its exact table. With num_intervals == 0 all
+        /// exact tables are used again, for validation.
+        void setSampledTables(const int num_intervals, const double tolerance)
+        {
+            krw_sampled_ = sampleCurve(svals_, krwvals_, num_intervals, tolerance,
+                                       [this](double s) { return krw_(s); });
+            kro_sampled_ = sampleCurve(svals_, krovals_, num_intervals, tolerance,
+                                       [this](double s) { return kro_(s); });
+            Jfunc_sampled_ = sampleCurve(svals_, Jvals_, num_intervals, tolerance,
+                                         [this](double s) { return Jfunc_(s); });
+            // The inverse has the J values as breakpoints.
+            std::vector<double> Jsorted(Jvals_);
+            std::sort(Jsorted.begin(), Jsorted.end());
+            invJfunc_sampled_ = sampleCurve(Jsorted, svals_, num_intervals, tolerance,
+                                            [this](double J) { return Jfunc_.inverse(J); });
+        }
+
 	void krw(const double saturation, double& krw_value) const
 	{
-	    krw_value = krw_(saturation);
+	    krw_value = krw_sampled_.empty() ? krw_(saturation) : krw_sampled_(saturation);
 	}
 
 	void kro(const double saturation, double& kro_value) const
 	{
-	    kro_value = kro_(saturation);
+	    kro_value = kro_sampled_.empty() ? kro_(saturation) : kro_sampled_(saturation);
 	}
 
 	void dkrw(const double saturation, double& dkrw_value) const
 	{
-	    dkrw_value = krw_.derivative(saturation);
+	    dkrw_value = krw_sampled_.empty() ? krw_.derivative(saturation)
+                                              : krw_sampled_.derivative(saturation);
 	}
 
 	void dkro(const double saturation, double& dkro_value) const
 	{
-	    dkro_value = kro_.derivative(saturation);
+	    dkro_value = kro_sampled_.empty() ? kro_.derivative(saturation)
+                                              : kro_sampled_.derivative(saturation);
 	}
 
 	double s_min() const
@@ -104,10 +129,10 @@ namespace Opm
                 // \sigma \cos \theta is by default approximated by 1.0;
                 // k is approximated by the average of the diagonal terms.
                 double sqrt_k_phi = std::sqrt(trace(perm)/(perm.numRows()*poro));
-                return Jfunc_(saturation)*sigma_cos_theta_/sqrt_k_phi;
+                return Jfunc(saturation)*sigma_cos_theta_/sqrt_k_phi;
             } else {
                 // The Jfunc_ table actually contains the pressure directly.
-                return Jfunc_(saturation);
+                return Jfunc(saturation);
             }
 	}
 
@@ -119,10 +144,10 @@ namespace Opm
                 // \sigma \cos \theta is by default approximated by 1.0;
                 // k is approximated by the average of the diagonal terms.
                 double sqrt_k_phi = std::sqrt(trace(perm)/(perm.numRows()*poro));
-                return Jfunc_.derivative(saturation)*sigma_cos_theta_/sqrt_k_phi;
+                return JfuncDeriv(saturation)*sigma_cos_theta_/sqrt_k_phi;
             } else {
                 // The Jfunc_ table actually contains the pressure directly.
-                return Jfunc_.derivative(saturation);
+                return JfuncDeriv(saturation);
             }
 	}
 
@@ -135,10 +160,10 @@ namespace Opm
                 // \sigma \cos \theta is by default approximated by 1.0;
                 // k is approximated by the average of the diagonal terms.
                 double sqrt_k_phi = std::sqrt(trace(perm)/(perm.numRows()*poro));
-                s = Jfunc_.inverse(cap_press*sqrt_k_phi/sigma_cos_theta_);
+                s = JfuncInverse(cap_press*sqrt_k_phi/sigma_cos_theta_);
             } else {
                 // The Jfunc_ table actually contains the pressure directly.
-                s = Jfunc_.inverse(cap_press);
+                s = JfuncInverse(cap_press);
             }
             s = std::min(s_max_, std::max(s_min_, s));
             return s;
@@ -159,6 +184,49 @@ namespace Opm
 	}
 
     private:
+	double Jfunc(const double s) const
+	{
+	    return Jfunc_sampled_.empty() ? Jfunc_(s) : Jfunc_sampled_(s);
+	}
+
+	double JfuncDeriv(const double s) const
+	{
+	    return Jfunc_sampled_.empty() ? Jfunc_.derivative(s) : Jfunc_sampled_.derivative(s);
+	}
+
+	double JfuncInverse(const double J) const
+	{
+	    return invJfunc_sampled_.empty() ? Jfunc_.inverse(J) : invJfunc_sampled_(J);
+	}
+
+	// Returns an empty table if the tolerance cannot be met, or if
+	// num_intervals is zero.
+	template <class Func>
+	static SampledTableLinear sampleCurve(const std::vector<double>& x,
+					      const std::vector<double>& y,
+					      const int num_intervals,
+					      const double tolerance,
+					      const Func& f)
+	{
+	    const int max_doublings = 8;
+	    if (num_intervals <= 0 || x.size() < 2 || !(x.back() > x.front())) {
+		return SampledTableLinear();
+	    }
+	    const double range = *std::max_element(y.begin(), y.end())
+		- *std::min_element(y.begin(), y.end());
+	    const double abs_tol = tolerance*std::max(range, 1e-300);
+	    int n = num_intervals;
+	    for (int k = 0; k <= max_doublings; ++k, n *= 2) {
+		SampledTableLinear table(x.front(), x.back(), n, f);
+		if (table.maxError(x, f) <= abs_tol) {
+		    return table;
+		}
+	    }
+	    std::cout << "Warning: could not sample rock curve to relative tolerance " << tolerance
+		      << " with " << n/2 << " intervals, using exact table." << std::endl;
+	    return SampledTableLinear();
+	}
+
 	void readStatoilFormat(std::istream& is)
 	{
             /* Skip lines at the top of the file starting with '#' or '--' */
@@ -215,6 +283,12 @@ namespace Opm
 	    std::vector<double> invsvals(svals);
 	    std::reverse(invsvals.begin(), invsvals.end());
 	    invJfunc_ = TabFunc(invJfunc, invsvals);
+	    // Kept for (re)building and checking sampled tables.
+	    svals_ = svals;
+	    krwvals_ = krw;
+	    krovals_ = kro;
+	    Jvals_ = Jfunc;
+	    krw_sampled_ = kro_sampled_ = Jfunc_sampled_ = invJfunc_sampled_ = SampledTableLinear();
 	}
 
 	typedef NonuniformTableLinear<double> TabFunc;
@@ -222,6 +296,14 @@ namespace Opm
 	TabFunc kro_;
 	TabFunc Jfunc_;
 	TabFunc invJfunc_;
+	SampledTableLinear krw_sampled_;
+	SampledTableLinear kro_sampled_;
+	SampledTableLinear Jfunc_sampled_;
+	SampledTableLinear invJfunc_sampled_;
+	std::vector<double> svals_;
+	std::vector<double> krwvals_;
+	std::vector<double> krovals_;
+	std::vector<double> Jvals_;
 	bool use_jfunction_scaling_;
 	double sigma_cos_theta_;
 	double s_min_;
@@ -0,0 +1,126 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_SAMPLEDTABLELINEAR_HEADER
+#define OPM_SAMPLEDTABLELINEAR_HEADER
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm
+{
+
+    /// @brief A function sampled on a uniform grid and evaluated by
+    /// linear interpolation.
+    ///
+    /// The interval containing an argument follows directly from the
+    /// argument, so lookups need no search. The left value and slope of
+    /// each interval are stored next to each other. Outside the domain
+    /// the end values are used, and the derivative is the slope of the
+    /// end interval, as for NonuniformTableLinear.
+    class SampledTableLinear
+    {
+    public:
+        SampledTableLinear()
+            : xmin_(0.0), xmax_(0.0), dx_(0.0), inv_dx_(0.0), num_intervals_(0)
+        {
+        }
+
+        /// @param f function sampled at num_intervals + 1 uniformly
+        ///          spaced points in [xmin, xmax].
+        template <class Func>
+        SampledTableLinear(const double xmin, const double xmax,
+                           const int num_intervals, const Func& f)
+            : xmin_(xmin), xmax_(xmax), num_intervals_(num_intervals)
+        {
+            if (!(xmax > xmin) || num_intervals < 1) {
+                OPM_THROW(std::runtime_error, "SampledTableLinear: invalid domain [" << xmin << ", "
+                          << xmax << "] or number of intervals " << num_intervals);
+            }
+            dx_ = (xmax - xmin)/num_intervals;
+            inv_dx_ = 1.0/dx_;
+            data_.resize(2*num_intervals);
+            double y0 = f(xmin);
+            for (int i = 0; i < num_intervals; ++i) {
+                const double x1 = (i + 1 == num_intervals) ? xmax : xmin + (i + 1)*dx_;
+                const double y1 = f(x1);
+                data_[2*i] = y0;
+                data_[2*i + 1] = (y1 - y0)/(x1 - (xmin + i*dx_));
+                y0 = y1;
+            }
+        }
+
+        bool empty() const
+        {
+            return data_.empty();
+        }
+
+        int numIntervals() const
+        {
+            return num_intervals_;
+        }
+
+        double operator()(const double x) const
+        {
+            const double xc = std::min(std::max(x, xmin_), xmax_);
+            const int i = interval(xc);
+            return data_[2*i] + (xc - (xmin_ + i*dx_))*data_[2*i + 1];
+        }
+
+        double derivative(const double x) const
+        {
+            const double xc = std::min(std::max(x, xmin_), xmax_);
+            return data_[2*interval(xc) + 1];
+        }
+
+        /// Largest deviation from f at the points x. For a piecewise
+        /// linear f, passing its breakpoints gives the maximum error over
+        /// the whole domain.
+        template <class Func>
+        double maxError(const std::vector<double>& x, const Func& f) const
+        {
+            double err = 0.0;
+            for (std::size_t k = 0; k < x.size(); ++k) {
+                err = std::max(err, std::fabs((*this)(x[k]) - f(x[k])));
+            }
+            return err;
+        }
+
+    private:
+        // Requires xmin_ <= x <= xmax_.
+        int interval(const double x) const
+        {
+            return std::min(static_cast<int>((x - xmin_)*inv_dx_), num_intervals_ - 1);
+        }
+
+        double xmin_;
+        double xmax_;
+        double dx_;
+        double inv_dx_;
+        int num_intervals_;
+        std::vector<double> data_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_SAMPLEDTABLELINEAR_HEADER
@@ -264,11 +264,11 @@ namespace Opm
 //         phase_mobilities_[0].resize(num_cells);
 //         phase_mobilities_[1].resize(num_cells);
         std::vector<double> fractional_flow_(num_cells);
-        for (int i = 0; i < num_cells; ++i) {
-//             for (int phase = 0; phase < 2; ++phase) {
-//                 rp.phaseMobility(phase, i, saturation[i], phase_mobilities_[phase][i]);
-//             }
-            fractional_flow_[i] = rp.fractionalFlow(i, saturation[i]);
+        if (num_cells > 0) {
+            typedef typename ReservoirProperties::Mobility Mob;
+            rp.saturationFunctions(0, num_cells, &saturation[0],
+                                   static_cast<Mob*>(0), static_cast<Mob*>(0),
+                                   &fractional_flow_[0], 0);
         }
 
         // Write data.
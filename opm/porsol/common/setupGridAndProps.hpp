@@ -73,10 +73,17 @@ namespace Opm
     {
         // Initialize grid and reservoir properties.
         // Parts copied from Dune::CpGrid::init().
+        // With "load_balance", the grid is partitioned over the MPI
+        // processes before the properties are read, so that they are
+        // only stored for the cells of this process.
         std::string fileformat = param.getDefault<std::string>("fileformat", "cartesian");
+        bool load_balance = param.getDefault("load_balance", false);
         if (fileformat == "sintef_legacy") {
             std::string grid_prefix = param.get<std::string>("grid_prefix");
             grid.readSintefLegacyFormat(grid_prefix);
+            if (load_balance) {
+                grid.loadBalance();
+            }
             OPM_MESSAGE("Warning: We do not yet read legacy reservoir properties. Using defaults.");
             res_prop.init(grid.size(0));
         } else if (fileformat == "eclipse") {
@@ -95,6 +102,9 @@ namespace Opm
                 Opm::EclipseGrid inputGrid(deck);
                 grid.processEclipseFormat(inputGrid, periodic_extension, turn_normals, clip_z);
             }
+            if (load_balance) {
+                grid.loadBalance();
+            }
             // Save EGRID file in case we are writing ECL output.
             if (param.getDefault("output_ecl", false)) {
                 OPM_THROW(std::runtime_error, "Saving to EGRID files is not yet implemented");
@@ -123,6 +133,11 @@ namespace Opm
             }
             res_prop.init(deck, grid.globalCell(), perm_threshold, rl_ptr,
                           use_j, sigma, theta);
+            int rock_table_intervals = param.getDefault("rock_table_intervals", 0);
+            if (rock_table_intervals > 0) {
+                double rock_table_tolerance = param.getDefault("rock_table_tolerance", 1e-3);
+                res_prop.setSampledRockTables(rock_table_intervals, rock_table_tolerance);
+            }
         } else if (fileformat == "cartesian") {
             std::array<int, 3> dims = {{ param.getDefault<int>("nx", 1),
                                     param.getDefault<int>("ny", 1),
@@ -131,6 +146,9 @@ namespace Opm
                                          param.getDefault<double>("dy", 1.0),
                                          param.getDefault<double>("dz", 1.0) }};
             grid.createCartesian(dims, cellsz);
+            if (load_balance) {
+                grid.loadBalance();
+            }
             double default_poro = param.getDefault("default_poro", 0.2);
             double default_perm_md = param.getDefault("default_perm_md", 100.0);
             double default_perm = Opm::unit::convert::from(default_perm_md, Opm::prefix::milli*Opm::unit::darcy);
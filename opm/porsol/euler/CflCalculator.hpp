@@ -42,6 +42,9 @@
 #include <opm/porsol/common/Matrix.hpp>
 #include <opm/porsol/common/MatrixInverse.hpp>
 
+#include <algorithm>
+#include <vector>
+
 
 namespace Opm {
     namespace cfl_calculator {
@@ -110,7 +113,8 @@ namespace Opm {
 			loc_perm_aver = Opm::utils::arithmeticAverage<PermTensor, MutablePermTensor>(K0, K1);
 			permdata = loc_perm_aver.data();
 		    } else {
-			permdata = resprop.permeability(f->cellIndex()).data();
+			loc_perm_aver = MutablePermTensor(resprop.permeability(f->cellIndex()));
+			permdata = loc_perm_aver.data();
 		    }
 		    PermTensor loc_perm(dimension, dimension, permdata);
 		    typename Grid::Vector loc_halfface_normal = f->normal();
@@ -160,7 +164,8 @@ namespace Opm {
 			loc_perm_aver = Opm::utils::arithmeticAverage<PermTensor, MutablePermTensor>(K0, K1);
 			permdata = loc_perm_aver.data();
 		    } else {
-			permdata = resprop.permeability(f->cellIndex()).data();
+			loc_perm_aver = MutablePermTensor(resprop.permeability(f->cellIndex()));
+			permdata = loc_perm_aver.data();
 		    }
 		    // PermTensor loc_perm(dimension, dimension, permdata);
                     MutablePermTensor loc_perm(dimension, dimension, permdata);
@@ -175,6 +180,129 @@ namespace Opm {
 	    return dt;
 	}
 
+
+	/// @brief Per-cell version of findCFLtimeVelocity().
+	/// On return, dt[c] holds the viscous cfl time of cell c.
+	/// Cells without any flux get dt = 1e100.
+	template <class Grid, class ReservoirProperties, class PressureSolution>
+	void findCFLtimeVelocityPerCell(const Grid& grid,
+					const ReservoirProperties& resprop,
+					const PressureSolution& pressure_sol,
+					std::vector<double>& dt)
+	{
+	    dt.assign(grid.numberOfCells(), 1e100);
+	    typename Grid::CellIterator c = grid.cellbegin();
+	    for (; c != grid.cellend(); ++c) {
+		double flux_p = 0.0;
+		double flux_n = 0.0;
+		typename Grid::CellIterator::FaceIterator f = c->facebegin();
+		for (; f != c->faceend(); ++f) {
+		    const double loc_flux = pressure_sol.outflux(f);
+		    if (loc_flux > 0) {
+			flux_p += loc_flux;
+		    } else {
+			flux_n -= loc_flux;
+		    }
+		}
+		const double flux = std::max(flux_n, flux_p);
+		if (flux > 0.0) {
+		    const double loc_dt = (resprop.cflFactor()*c->volume()*resprop.porosity(c->index()))/flux;
+		    if (loc_dt == 0.0) {
+			OPM_THROW(std::runtime_error, "Cfl computation gave dt = 0.0");
+		    }
+		    dt[c->index()] = std::min(dt[c->index()], loc_dt);
+		}
+	    }
+	}
+
+
+	/// @brief Per-cell version of findCFLtimeGravity().
+	/// On return, dt[c] holds the gravity cfl time of cell c.
+	template <class Grid, class ReservoirProperties>
+	void findCFLtimeGravityPerCell(const Grid& grid,
+				       const ReservoirProperties& resprop,
+				       const typename Grid::Vector& gravity,
+				       std::vector<double>& dt)
+	{
+	    typedef typename ReservoirProperties::PermTensor PermTensor;
+	    typedef typename ReservoirProperties::MutablePermTensor MutablePermTensor;
+	    const int dimension = Grid::Vector::dimension;
+	    dt.assign(grid.numberOfCells(), 1e100);
+	    typename Grid::CellIterator c = grid.cellbegin();
+	    for (; c != grid.cellend(); ++c) {
+		double flux = 0.0;
+		typename Grid::CellIterator::FaceIterator f = c->facebegin();
+		for (; f != c->faceend(); ++f) {
+		    MutablePermTensor loc_perm_aver;
+		    const double* permdata = 0;
+		    if (!f->boundary()) {
+			PermTensor K0 = resprop.permeability(f->cellIndex());
+			PermTensor K1 = resprop.permeability(f->neighbourCellIndex());
+			loc_perm_aver = Opm::utils::arithmeticAverage<PermTensor, MutablePermTensor>(K0, K1);
+			permdata = loc_perm_aver.data();
+		    } else {
+			loc_perm_aver = MutablePermTensor(resprop.permeability(f->cellIndex()));
+			permdata = loc_perm_aver.data();
+		    }
+		    PermTensor loc_perm(dimension, dimension, permdata);
+		    typename Grid::Vector loc_halfface_normal = f->normal();
+		    double loc_gravity_flux = 0.0;
+		    for (int k = 0; k < dimension; ++k) {
+			for (int q = 0; q < dimension; ++q) {
+			    loc_gravity_flux += loc_halfface_normal[q]*(loc_perm(q,k)*gravity[k]*resprop.densityDifference());
+			}
+		    }
+		    loc_gravity_flux *= f->area();
+		    if (loc_gravity_flux > 0) {
+			flux += loc_gravity_flux;
+		    }
+		}
+		if (flux > 0.0) {
+		    const double loc_dt = (resprop.cflFactorGravity()*c->volume()*resprop.porosity(c->index()))/flux;
+		    dt[c->index()] = std::min(dt[c->index()], loc_dt);
+		}
+	    }
+	}
+
+
+
+	/// @brief Per-cell version of findCFLtimeCapillary().
+	/// On return, dt[c] holds the capillary cfl time of cell c.
+	template <class Grid, class ReservoirProperties>
+	void findCFLtimeCapillaryPerCell(const Grid& grid,
+					 const ReservoirProperties& resprop,
+					 std::vector<double>& dt)
+	{
+	    typedef typename ReservoirProperties::PermTensor PermTensor;
+	    typedef typename ReservoirProperties::MutablePermTensor MutablePermTensor;
+	    const int dimension = Grid::Vector::dimension;
+	    dt.assign(grid.numberOfCells(), 1e100);
+	    typename Grid::CellIterator c = grid.cellbegin();
+	    for (; c != grid.cellend(); ++c) {
+		typename Grid::CellIterator::FaceIterator f = c->facebegin();
+		for (; f != c->faceend(); ++f) {
+		    MutablePermTensor loc_perm_aver;
+		    const double* permdata = 0;
+		    if (!f->boundary()) {
+			PermTensor K0 = resprop.permeability(f->cellIndex());
+			PermTensor K1 = resprop.permeability(f->neighbourCellIndex());
+			loc_perm_aver = Opm::utils::arithmeticAverage<PermTensor, MutablePermTensor>(K0, K1);
+			permdata = loc_perm_aver.data();
+		    } else {
+			loc_perm_aver = MutablePermTensor(resprop.permeability(f->cellIndex()));
+			permdata = loc_perm_aver.data();
+		    }
+                    MutablePermTensor loc_perm(dimension, dimension, permdata);
+                    MutablePermTensor loc_perm_inv = inverse3x3(loc_perm);
+		    typename Grid::Vector loc_centroid = f->centroid();
+                    loc_centroid -= c->centroid();
+                    double spatial_contrib = loc_centroid*prod(loc_perm_inv, loc_centroid);
+                    double loc_dt = spatial_contrib/resprop.cflFactorCapillary();
+                    dt[c->index()] = std::min(dt[c->index()], loc_dt);
+		}
+	    }
+	}
+
     } // namespace cfl_calculator
 } // namespace Opm
 
@@ -92,6 +92,9 @@ namespace Opm {
 	/// for \param time seconds.
 	/// Cfl type conditions may force many explicit timesteps to
 	/// be taken, before the function returns.
+	/// If the parameter local_time_stepping is true, cells are grouped
+	/// in levels by their local cfl time, and each level l is advanced
+	/// with time step dt_coarse/2^l, see transportSolveLocal().
 	/// @tparam
 	/// @param
 	template <class PressureSolution>
@@ -122,6 +125,31 @@ namespace Opm {
 
 	void checkAndPossiblyClampSat(std::vector<double>& s) const;
 
+	// Local time stepping (multirate) versions of the above.
+	template <class PressureSolution>
+	void transportSolveLocal(std::vector<double>& saturation,
+				 const double time,
+				 const typename GridInterface::Vector& gravity,
+				 const PressureSolution& pressure_sol,
+				 const Opm::SparseVector<double>& injection_rates) const;
+
+	template <class PressureSolution>
+	void computeCflTimePerCell(const typename GridInterface::Vector& gravity,
+				   const PressureSolution& pressure_sol,
+				   std::vector<double>& cell_dt) const;
+
+	int assignTimeLevels(const std::vector<double>& cell_dt,
+			     const double coarse_dt) const;
+
+	template <class PressureSolution>
+	void localTimeStep(std::vector<double>& saturation,
+			   const int min_level,
+			   const typename GridInterface::Vector& gravity,
+			   const PressureSolution& pressure_sol,
+			   const Opm::SparseVector<double>& injection_rates) const;
+
+	void checkAndPossiblyClampSat(double& s, const int cell) const;
+
 
         EulerUpstreamResidual<GridInterface,
                               ReservoirProperties,
@@ -139,8 +167,19 @@ namespace Opm {
 	int maximum_small_steps_;
 	bool check_sat_;
 	bool clamp_sat_;
+	bool local_time_stepping_;
+	// Number of time step levels allowed in local time stepping mode.
+	int max_time_levels_;
         std::vector<double> porevol_;
 
+	// Local time stepping state, recomputed on every transportSolve() call.
+	// lts_cells_ is sorted so that its first level_count_[l] entries are
+	// the cells touched by faces of level l or finer.
+	mutable std::vector<int> cell_level_;
+	mutable std::vector<double> level_dt_;
+	mutable std::vector<CIt> lts_cells_;
+	mutable std::vector<int> level_count_;
+
 	// Storing residual so that we won't have to reallocate it for every step.
 	mutable std::vector<double> residual_;
     };
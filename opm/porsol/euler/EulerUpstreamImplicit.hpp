@@ -46,6 +46,8 @@ along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <dune/grid/common/GridAdapter.hpp>
 
+#include <memory>
+
 #include <opm/core/transport/implicit/ImplicitAssembly.hpp>
 #include <opm/core/transport/implicit/ImplicitTransport.hpp>
 #include <opm/core/transport/implicit/JacobianSystem.hpp>
@@ -155,6 +157,17 @@ namespace Opm {
 	//Opm::SimpleFluid2pWrapper< ReservoirProperties > myfluid_;
 	//TwophaseFluid myfluid_;
 
+	// The fluid, transport model and solvers are built once in initObj(),
+	// and kept with their work arrays between transportSolve() calls.
+	// Declaration order matters: the model refers to the fluid, and the
+	// solver to the model.
+	std::unique_ptr<TwophaseFluid> fluid_;
+	std::unique_ptr<TransportModel> model_;
+	mutable std::unique_ptr<TransportSolver> tsolver_;
+	mutable LinearSolver linsolve_;
+	mutable std::unique_ptr<Opm::ReservoirState<2> > state_;
+	mutable Opm::TransportSource tsrc_;
+
 	bool check_sat_;
 	bool clamp_sat_;
 	int max_repeats_;
@@ -83,6 +83,7 @@ namespace Opm
         ctrl_.max_it_ls = param.getDefault("transport_max_it_ls", 20);
         ctrl_.dxtol = param.getDefault("transport_dxtol", 1e-6);
         ctrl_.verbosity = param.getDefault("transport_verbosity", 0);
+        linsolve_.setPreconditionerReuse(param.getDefault("transport_precond_reuse", 1));
     }
 
     template <class GI, class RP, class BC>
@@ -109,8 +110,9 @@ namespace Opm
         int ngconn  = mygrid_.c_grid()->cell_facepos[num_cells];
         //std::vector<double> htrans_(ngconn);
         htrans_.resize(ngconn);
-        const double* perm = &(r.permeability(0)(0,0));
-        tpfa_htrans_compute(mygrid_.c_grid(), perm, &htrans_[0]);
+        std::vector<double> perm;
+        r.permeabilityField(perm);
+        tpfa_htrans_compute(mygrid_.c_grid(), &perm[0], &htrans_[0]);
         // int count = 0;
 
         myrp_= r;
@@ -213,6 +215,25 @@ namespace Opm
             direclet_sat_[2*i] = fl;
             direclet_sat_[2*i+1] = 1-fl;
         }
+
+        // Set up the transport machinery, torn down in reverse order.
+        tsolver_.reset();
+        model_.reset();
+        fluid_.reset(new TwophaseFluid(myrp_));
+        double* tmp_grav = 0;
+        model_.reset(new TransportModel(*fluid_, *mygrid_.c_grid(), porevol_, tmp_grav));
+        model_->makefhfQPeriodic(periodic_faces_, periodic_hfaces_, periodic_nbfaces_);
+        model_->initGravityTrans(*mygrid_.c_grid(), htrans_);
+        tsolver_.reset(new TransportSolver(*model_));
+        state_.reset(new Opm::ReservoirState<2>(mygrid_.c_grid()));
+
+        // The input flux is assumed to be the saturation times the flux in the transport solver.
+        // Only the fluxes change between calls.
+        tsrc_ = Opm::TransportSource();
+        tsrc_.nsrc = direclet_cells_.size();
+        tsrc_.saturation = direclet_sat_;
+        tsrc_.cell = direclet_cells_;
+        tsrc_.flux.resize(direclet_hfaces_.size());
     }
 
     template <class GI, class RP, class BC>
@@ -232,8 +253,10 @@ namespace Opm
                                                            const PressureSolution& pressure_sol,
                                                            const Opm::SparseVector<double>& /* injection_rates */) const
     {
-
-        Opm::ReservoirState<2> state(mygrid_.c_grid());
+        if (!tsolver_) {
+            OPM_THROW(std::logic_error, "EulerUpstreamImplicit::transportSolve() called before initObj().");
+        }
+        Opm::ReservoirState<2>& state = *state_;
         {
             std::vector<double>& sat = state.saturation();
             for (int i=0; i < mygrid_.numCells(); ++i){
@@ -246,7 +269,10 @@ namespace Opm
         const UnstructuredGrid* cgrid = mygrid_.c_grid();
         int numhf = cgrid->cell_facepos[cgrid->number_of_cells];
 
-        std::vector<double>     faceflux(numhf);
+        // Written directly into the persistent state, sized by the
+        // number of half faces as before.
+        std::vector<double>& faceflux = state.faceflux();
+        faceflux.resize(numhf);
 
         for (int c = 0, i = 0; c < cgrid->number_of_cells; ++c){
             for (; i < cgrid->cell_facepos[c + 1]; ++i) {
@@ -257,11 +283,9 @@ namespace Opm
             }
         }
         int num_db=direclet_hfaces_.size();
-        std::vector<double> sflux(num_db);
         for (int i=0; i < num_db;++i){
-            sflux[i]=-pressure_sol.outflux(direclet_hfaces_[i]);
+            tsrc_.flux[i]=-pressure_sol.outflux(direclet_hfaces_[i]);
         }
-        state.faceflux()=faceflux;
 
         double dt_transport = time;
         int nr_transport_steps = 1;
@@ -270,27 +294,11 @@ namespace Opm
         bool finished = false;
         clock.start();
 
-        TwophaseFluid myfluid(myrp_);
-        double* tmp_grav=0;
-        const UnstructuredGrid& c_grid=*mygrid_.c_grid();
-        TransportModel model(myfluid,c_grid,porevol_,tmp_grav);
-        model.makefhfQPeriodic(periodic_faces_,periodic_hfaces_, periodic_nbfaces_);
-        model.initGravityTrans(*mygrid_.c_grid(),htrans_);
-        TransportSolver tsolver(model);
-        LinearSolver linsolve_;
         Opm::ImplicitTransportDetails::NRReport  rpt_;
 
-        Opm::TransportSource tsrc;//create_transport_source(0, 2);
-        // the input flux is assumed to be the saturation times the flux in the transport solver
-
-        tsrc.nsrc =direclet_cells_.size();
-        tsrc.saturation = direclet_sat_;
-        tsrc.cell = direclet_cells_;
-        tsrc.flux = sflux;
-
         while (!finished) {
             for (int q = 0; q < nr_transport_steps; ++q) {
-                tsolver.solve(*mygrid_.c_grid(), &tsrc, dt_transport, ctrl_, state, linsolve_, rpt_);
+                tsolver_->solve(*mygrid_.c_grid(), &tsrc_, dt_transport, ctrl_, state, linsolve_, rpt_);
                 if(rpt_.flag<0){
                     break;
                 }
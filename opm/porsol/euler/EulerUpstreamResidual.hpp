@@ -93,6 +93,42 @@ namespace Opm {
 
 	void computeCapPressures(const std::vector<double>& saturation) const;
 
+        /// @brief Residual restricted to the faces of a subset of levels,
+        /// used for local time stepping.
+        /// Every cell has a level l, and every face the finest level of its
+        /// two cells. Only faces (and sources) with level >= min_level contribute,
+        /// and each contribution is multiplied by level_dt[level], so that the
+        /// result is a saturation volume change, not a rate.
+        /// Mass is conserved since each face flux is added to both its cells.
+        /// @param cells must be sorted such that its first num_cells entries
+        ///        are exactly the cells touching a face of level >= min_level.
+        ///        Only those entries of residual are reset and modified.
+	template <class FlowSolution>
+	void computeResidualLocal(const std::vector<double>& saturation,
+                                  const typename GridInterface::Vector& gravity,
+                                  const FlowSolution& flow_sol,
+                                  const Opm::SparseVector<double>& injection_rates,
+                                  const bool method_viscous,
+                                  const bool method_gravity,
+                                  const bool method_capillary,
+                                  const std::vector<int>& cell_level,
+                                  const std::vector<double>& level_dt,
+                                  const int min_level,
+                                  const std::vector<CIt>& cells,
+                                  const int num_cells,
+                                  std::vector<double>& sat_delta) const;
+
+        /// @brief Capillary pressures for the first num_cells cells of cells only.
+	void computeCapPressures(const std::vector<double>& saturation,
+                                 const std::vector<CIt>& cells,
+                                 const int num_cells) const;
+
+        /// @brief For every cell, the finest level among itself and its
+        /// neighbours (including periodic partners). A cell is touched by
+        /// the faces of level l if and only if its reach level is >= l.
+        void computeReachLevels(const std::vector<int>& cell_level,
+                                std::vector<int>& reach_level) const;
+
         const GridInterface& grid() const;
         const ReservoirProperties& reservoirProperties() const;
         const BoundaryConditions& boundaryConditions() const;
@@ -116,6 +152,8 @@ namespace Opm {
 
 	// Precomputing the capillary pressures of cells saves a little time.
 	mutable std::vector<double> cap_pressures_;
+        // Phase mobilities at the cell saturations, used for upstream weighting.
+        mutable std::vector<typename ReservoirProperties::Mobility> cell_mob_[2];
         mutable const Opm::SparseVector<double>* pinjection_rates_;
         mutable bool method_viscous_;
         mutable bool method_gravity_;
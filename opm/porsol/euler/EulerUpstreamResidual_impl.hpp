@@ -54,6 +54,7 @@
 #include <tbb/parallel_for.h>
 #endif
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -81,20 +82,59 @@ namespace Opm
             typedef typename UpstreamSolver::FIt FIt;
             typedef typename UpstreamSolver::RP::PermTensor PermTensor;
             typedef typename UpstreamSolver::RP::MutablePermTensor MutablePermTensor;
+            typedef typename UpstreamSolver::RP::Mobility Mob;
 
             const UpstreamSolver& s;
             const std::vector<double>& saturation;
             const Vector& gravity;
             const PressureSolution& pressure_sol;
             std::vector<double>& residual;
+            // Local time stepping data, unused if cell_level is null.
+            // A face belongs to the finest level of its two cells, and
+            // contributes (with the step length of that level) only if
+            // its level is at least min_level.
+            const int* cell_level;
+            const double* level_dt;
+            int min_level;
+            // Phase mobilities at the cell saturations, or null if
+            // they must be evaluated face by face.
+            const Mob* cell_mob[2];
 
             UpdateForCell(const UpstreamSolver& solver,
                           const std::vector<double>& sat,
                           const Vector& grav,
                           const PressureSolution& psol,
                           std::vector<double>& res)
-                : s(solver), saturation(sat), gravity(grav), pressure_sol(psol), residual(res)
+                : s(solver), saturation(sat), gravity(grav), pressure_sol(psol), residual(res),
+                  cell_level(0), level_dt(0), min_level(0)
             {
+                cell_mob[0] = cell_mob[1] = 0;
+            }
+
+            UpdateForCell(const UpstreamSolver& solver,
+                          const std::vector<double>& sat,
+                          const Vector& grav,
+                          const PressureSolution& psol,
+                          std::vector<double>& res,
+                          const int* levels,
+                          const double* dts,
+                          const int minlev)
+                : s(solver), saturation(sat), gravity(grav), pressure_sol(psol), residual(res),
+                  cell_level(levels), level_dt(dts), min_level(minlev)
+            {
+                cell_mob[0] = cell_mob[1] = 0;
+            }
+
+            // Mobility of a phase in a cell, from cell_mob unless the
+            // saturation is a boundary value.
+            void phaseMobility(const int phase, const int cell, const double sat,
+                               const bool boundary_value, Mob& m) const
+            {
+                if (cell_mob[phase] && !boundary_value) {
+                    m.setTo(cell_mob[phase][cell]);
+                } else {
+                    s.preservoir_properties_->phaseMobility(phase, cell, sat, m.mob);
+                }
             }
 
             template <class CIt>
@@ -142,6 +182,16 @@ namespace Opm
                         cell_sat[1] = saturation[cell[1]];
                     }
 
+                    // Skip faces that are not due for an update in this substep.
+                    double face_dt = 1.0;
+                    if (cell_level) {
+                        const int face_level = std::max(cell_level[cell[0]], cell_level[cell[1]]);
+                        if (face_level < min_level) {
+                            continue;
+                        }
+                        face_dt = level_dt[face_level];
+                    }
+
                     // Get some local properties.
                     const double loc_area = f->area();
                     const double loc_flux = pressure_sol.outflux(f);
@@ -189,7 +239,6 @@ namespace Opm
                     // 1) we do not have v, just loc_area*loc_normal*v,
                     // 2) we cannot define G, since the lambdas do not commute with the dot product.
 
-                    typedef typename UpstreamSolver::RP::Mobility Mob;
                     using Opm::utils::arithmeticAverage;
                     // Doing arithmetic averages. Should we consider harmonic or geometric instead?
                     const MutablePermTensor aver_perm
@@ -206,9 +255,11 @@ namespace Opm
                     const int triv_phase = G >= 0.0 ? 0 : 1;
                     const int ups_cell = loc_flux >= 0.0 ? 0 : 1;
                     // Compute mobility of the trivial phase.
+                    // On Dirichlet boundaries cell[1] == cell[0], and cell_sat[1] is the boundary value.
+                    const bool dirichlet = (cell[0] == cell[1]);
                     Mob m_ups[2];
-                    s.preservoir_properties_->phaseMobility(triv_phase, cell[ups_cell],
-                                                          cell_sat[ups_cell], m_ups[triv_phase].mob);
+                    phaseMobility(triv_phase, cell[ups_cell], cell_sat[ups_cell],
+                                  dirichlet && ups_cell == 1, m_ups[triv_phase]);
                     // Compute gravity flow of the nontrivial phase.
                     double sign_G[2] = { -1.0, 1.0 };
                     double grav_flux_nontriv = sign_G[triv_phase]*loc_area
@@ -216,8 +267,8 @@ namespace Opm
                     // Find flow direction of nontrivial phase.
                     const int ups_cell_nontriv = (loc_flux + grav_flux_nontriv >= 0.0) ? 0 : 1;
                     const int nontriv_phase = (triv_phase + 1) % 2;
-                    s.preservoir_properties_->phaseMobility(nontriv_phase, cell[ups_cell_nontriv],
-                                                          cell_sat[ups_cell_nontriv], m_ups[nontriv_phase].mob);
+                    phaseMobility(nontriv_phase, cell[ups_cell_nontriv], cell_sat[ups_cell_nontriv],
+                                  dirichlet && ups_cell_nontriv == 1, m_ups[nontriv_phase]);
                     // Now we have the upstream phase mobilities in m_ups[].
                     Mob m_tot;
                     m_tot.setToSum(m_ups[0], m_ups[1]);
@@ -274,6 +325,8 @@ namespace Opm
                         dS += cap_change;
                     }
 
+                    dS *= face_dt;
+
                     // Modify saturation.
                     if (cell[0] != cell[1]){
                         residual[cell[0]] -= dS;
@@ -285,6 +338,12 @@ namespace Opm
                 }
                 // Source term.
                 double rate = s.pinjection_rates_->element(cell[0]);
+                if (cell_level) {
+                    if (cell_level[cell[0]] < min_level) {
+                        return;
+                    }
+                    rate *= level_dt[cell_level[cell[0]]];
+                }
                 if (rate < 0.0) {
                     // For anisotropic relperm, fractionalFlow does not really make sense
                     // as a scalar
@@ -455,13 +514,94 @@ namespace Opm
     {
 	int num_cells = saturation.size();
 	cap_pressures_.resize(num_cells);
-	for (int cell = 0; cell < num_cells; ++cell) {
+        if (num_cells > 0) {
+            typedef typename RP::Mobility Mob;
+            preservoir_properties_->saturationFunctions(0, num_cells, &saturation[0],
+                                                        static_cast<Mob*>(0), static_cast<Mob*>(0),
+                                                        0, &cap_pressures_[0]);
+        }
+    }
+
+
+
+
+    template <class GI, class RP, class BC>
+    inline void EulerUpstreamResidual<GI, RP, BC>::computeCapPressures(const std::vector<double>& saturation,
+                                                                     const std::vector<CIt>& cells,
+                                                                     const int num_cells) const
+    {
+	cap_pressures_.resize(saturation.size());
+	for (int i = 0; i < num_cells; ++i) {
+            const int cell = cells[i]->index();
 	    cap_pressures_[cell] = preservoir_properties_->capillaryPressure(cell, saturation[cell]);
 	}
     }
 
 
 
+    template <class GI, class RP, class BC>
+    inline void EulerUpstreamResidual<GI, RP, BC>::computeReachLevels(const std::vector<int>& cell_level,
+                                                                    std::vector<int>& reach_level) const
+    {
+        reach_level = cell_level;
+	for (CIt c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+            const int cell = c->index();
+	    for (FIt f = c->facebegin(); f != c->faceend(); ++f) {
+                int nbcell = cell;
+                if (f->boundary()) {
+                    if (pboundary_->satCond(*f).isPeriodic()) {
+                        nbcell = bid_to_face_[pboundary_->getPeriodicPartner(f->boundaryId())]->cellIndex();
+                    }
+                } else {
+                    nbcell = f->neighbourCellIndex();
+                }
+                reach_level[cell] = std::max(reach_level[cell], cell_level[nbcell]);
+            }
+        }
+    }
+
+
+
+
+    template <class GI, class RP, class BC>
+    template <class PressureSolution>
+    inline void EulerUpstreamResidual<GI, RP, BC>::
+    computeResidualLocal(const std::vector<double>& saturation,
+                         const typename GI::Vector& gravity,
+                         const PressureSolution& pressure_sol,
+                         const Opm::SparseVector<double>& injection_rates,
+                         const bool method_viscous,
+                         const bool method_gravity,
+                         const bool method_capillary,
+                         const std::vector<int>& cell_level,
+                         const std::vector<double>& level_dt,
+                         const int min_level,
+                         const std::vector<CIt>& cells,
+                         const int num_cells,
+                         std::vector<double>& residual) const
+    {
+        // Only the first num_cells entries of cells are touched by
+        // faces of level min_level or finer, so only those need resetting.
+        residual.resize(saturation.size(), 0.0);
+        for (int i = 0; i < num_cells; ++i) {
+            residual[cells[i]->index()] = 0.0;
+        }
+
+        pinjection_rates_ = &injection_rates;
+        method_viscous_ = method_viscous;
+        method_gravity_ = method_gravity;
+        method_capillary_ = method_capillary;
+
+        typedef EulerUpstreamResidualDetails::UpdateForCell<EulerUpstreamResidual<GI,RP,BC>, PressureSolution> CellUpdater;
+        CellUpdater update_cell(*this, saturation, gravity, pressure_sol, residual,
+                                &cell_level[0], &level_dt[0], min_level);
+        for (int i = 0; i < num_cells; ++i) {
+            update_cell(cells[i]);
+        }
+    }
+
+
+
 
     template <class GI, class RP, class BC>
     template <class PressureSolution>
@@ -489,6 +629,18 @@ namespace Opm
 	// this cell has lower index than the neighbour, or we are on the boundary.
         typedef EulerUpstreamResidualDetails::UpdateForCell<EulerUpstreamResidual<GI,RP,BC>, PressureSolution> CellUpdater;
         CellUpdater update_cell(*this, saturation, gravity, pressure_sol, residual);
+
+        // Evaluate the upstream phase mobilities once per cell instead of once per face.
+        const int num_cells = saturation.size();
+        for (int phase = 0; phase < 2; ++phase) {
+            cell_mob_[phase].resize(num_cells);
+        }
+        if (num_cells > 0) {
+            preservoir_properties_->saturationFunctions(0, num_cells, &saturation[0],
+                                                        &cell_mob_[0][0], &cell_mob_[1][0], 0, 0);
+            update_cell.cell_mob[0] = &cell_mob_[0][0];
+            update_cell.cell_mob[1] = &cell_mob_[1][0];
+        }
         EulerUpstreamResidualDetails::UpdateLoopBody<CellUpdater> body(update_cell);
         EulerUpstreamResidualDetails::IndirectRange<CIt> r(cell_iters_);
 #ifdef USE_TBB
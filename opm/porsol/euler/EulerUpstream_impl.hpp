@@ -68,7 +68,9 @@ namespace Opm
 	  minimum_small_steps_(1),
           maximum_small_steps_(10000),
 	  check_sat_(true),
-	  clamp_sat_(false)
+	  clamp_sat_(false),
+	  local_time_stepping_(false),
+	  max_time_levels_(6)
     {
     }
 
@@ -84,7 +86,9 @@ namespace Opm
 	  minimum_small_steps_(1),
           maximum_small_steps_(10000),
 	  check_sat_(true),
-	  clamp_sat_(false)
+	  clamp_sat_(false),
+	  local_time_stepping_(false),
+	  max_time_levels_(6)
     {
         residual_computer_.initObj(g, r, b);
     }
@@ -105,6 +109,11 @@ namespace Opm
 	maximum_small_steps_ = param.getDefault("maximum_small_steps", maximum_small_steps_);
 	check_sat_ = param.getDefault("check_sat", check_sat_);
 	clamp_sat_ = param.getDefault("clamp_sat", clamp_sat_);
+	local_time_stepping_ = param.getDefault("local_time_stepping", local_time_stepping_);
+	max_time_levels_ = param.getDefault("max_time_levels", max_time_levels_);
+	if (max_time_levels_ < 1 || max_time_levels_ > 20) {
+	    OPM_THROW(std::runtime_error, "max_time_levels must be in [1, 20], got " << max_time_levels_);
+	}
     }
 
     template <class GI, class RP, class BC>
@@ -156,6 +165,11 @@ namespace Opm
 						   const PressureSolution& pressure_sol,
 						   const Opm::SparseVector<double>& injection_rates) const
     {
+	if (local_time_stepping_) {
+	    transportSolveLocal(saturation, time, gravity, pressure_sol, injection_rates);
+	    return;
+	}
+
 	// Compute the cfl time-step.
 	double cfl_dt = computeCflTime(saturation, time, gravity, pressure_sol);
 
@@ -221,6 +235,155 @@ namespace Opm
 
 
 
+    template <class GI, class RP, class BC>
+    template <class PressureSolution>
+    void EulerUpstream<GI, RP, BC>::transportSolveLocal(std::vector<double>& saturation,
+							const double time,
+							const typename GI::Vector& gravity,
+							const PressureSolution& pressure_sol,
+							const Opm::SparseVector<double>& injection_rates) const
+    {
+	std::vector<double> cell_dt;
+	computeCflTimePerCell(gravity, pressure_sol, cell_dt);
+	const double min_dt = cell_dt.empty() ? 1e99
+	    : *std::min_element(cell_dt.begin(), cell_dt.end());
+
+	// Choose the coarse step as large as possible, while still
+	// letting the finest level satisfy the global cfl condition.
+	const double max_coarse_dt = min_dt*double(1 << (max_time_levels_ - 1));
+	int nr_coarse_steps = minimum_small_steps_;
+	if (max_coarse_dt < time) {
+	    double steps = std::min<double>(std::ceil(time/max_coarse_dt), std::numeric_limits<int>::max());
+	    nr_coarse_steps = std::max(int(steps), minimum_small_steps_);
+	}
+	nr_coarse_steps = std::min(nr_coarse_steps, maximum_small_steps_);
+
+	// Same retry strategy as in transportSolve(), halving the coarse step.
+	std::vector<double> saturation_initial(saturation);
+	bool finished = false;
+	int repeats = 0;
+	const int max_repeats = 10;
+	while (!finished) {
+	    try {
+		const int finest_level = assignTimeLevels(cell_dt, time/nr_coarse_steps);
+		const int nr_substeps = 1 << finest_level;
+#ifdef VERBOSE
+		std::cout << "Doing " << nr_coarse_steps
+			  << " coarse steps for saturation equation with stepsize "
+			  << time/nr_coarse_steps << " in seconds, using "
+			  << finest_level + 1 << " time levels." << std::endl;
+		for (int l = 0; l <= finest_level; ++l) {
+		    std::cout << "    Cells touched by level " << l << ": " << level_count_[l] << std::endl;
+		}
+#endif // VERBOSE
+		for (int q = 0; q < nr_coarse_steps; ++q) {
+		    for (int k = 0; k < nr_substeps; ++k) {
+			// Level l takes a step at substep k if 2^(finest_level - l) divides k.
+			int min_level = 0;
+			if (k > 0) {
+			    min_level = finest_level;
+			    for (int kk = k; kk % 2 == 0; kk /= 2) {
+				--min_level;
+			    }
+			}
+			localTimeStep(saturation, min_level, gravity, pressure_sol, injection_rates);
+		    }
+		}
+		finished = true;
+	    }
+	    catch (...) {
+		++repeats;
+		if (repeats > max_repeats) {
+		    throw;
+		}
+		OPM_MESSAGE("Warning: Transport failed, retrying with more steps.");
+		nr_coarse_steps *= 2;
+		saturation = saturation_initial;
+	    }
+	}
+    }
+
+
+
+    template <class GI, class RP, class BC>
+    template <class PressureSolution>
+    inline void EulerUpstream<GI, RP, BC>::computeCflTimePerCell(const typename GI::Vector& gravity,
+								 const PressureSolution& pressure_sol,
+								 std::vector<double>& cell_dt) const
+    {
+	const GI& grid = residual_computer_.grid();
+	const RP& resprop = residual_computer_.reservoirProperties();
+	cell_dt.assign(grid.numberOfCells(), 1e99);
+	std::vector<double> dt;
+	if (method_viscous_ && use_cfl_viscous_) {
+	    cfl_calculator::findCFLtimeVelocityPerCell(grid, resprop, pressure_sol, dt);
+	    for (int i = 0; i < int(dt.size()); ++i) {
+		cell_dt[i] = std::min(cell_dt[i], dt[i]);
+	    }
+	}
+	if (method_gravity_ && use_cfl_gravity_) {
+	    cfl_calculator::findCFLtimeGravityPerCell(grid, resprop, gravity, dt);
+	    for (int i = 0; i < int(dt.size()); ++i) {
+		cell_dt[i] = std::min(cell_dt[i], dt[i]);
+	    }
+	}
+	if (method_capillary_ && use_cfl_capillary_) {
+	    cfl_calculator::findCFLtimeCapillaryPerCell(grid, resprop, dt);
+	    for (int i = 0; i < int(dt.size()); ++i) {
+		cell_dt[i] = std::min(cell_dt[i], dt[i]);
+	    }
+	}
+	for (int i = 0; i < int(cell_dt.size()); ++i) {
+	    cell_dt[i] *= courant_number_;
+	}
+    }
+
+
+
+    template <class GI, class RP, class BC>
+    inline int EulerUpstream<GI, RP, BC>::assignTimeLevels(const std::vector<double>& cell_dt,
+							   const double coarse_dt) const
+    {
+	// A cell gets the coarsest level l with coarse_dt/2^l <= cell_dt.
+	const int num_cells = cell_dt.size();
+	cell_level_.resize(num_cells);
+	int finest_level = 0;
+	for (int i = 0; i < num_cells; ++i) {
+	    double dt = coarse_dt;
+	    int level = 0;
+	    while (dt > cell_dt[i] && level < max_time_levels_ - 1) {
+		dt *= 0.5;
+		++level;
+	    }
+	    cell_level_[i] = level;
+	    finest_level = std::max(finest_level, level);
+	}
+	level_dt_.resize(finest_level + 1);
+	for (int l = 0; l <= finest_level; ++l) {
+	    level_dt_[l] = coarse_dt/double(1 << l);
+	}
+
+	// Sort the cells by decreasing reach level (bucket sort).
+	std::vector<int> reach_level;
+	residual_computer_.computeReachLevels(cell_level_, reach_level);
+	level_count_.assign(finest_level + 2, 0);
+	for (int i = 0; i < num_cells; ++i) {
+	    ++level_count_[reach_level[i]];
+	}
+	for (int l = finest_level - 1; l >= 0; --l) {
+	    level_count_[l] += level_count_[l + 1];
+	}
+	std::vector<int> pos(level_count_.begin() + 1, level_count_.end());
+	const GI& grid = residual_computer_.grid();
+	lts_cells_.assign(num_cells, grid.cellbegin());
+	for (CIt c = grid.cellbegin(); c != grid.cellend(); ++c) {
+	    lts_cells_[pos[reach_level[c->index()]]++] = c;
+	}
+	return finest_level;
+    }
+
+
+
     /*
 
 
@@ -338,12 +501,20 @@ namespace Opm
     {
 	int num_cells = s.size();
 	for (int cell = 0; cell < num_cells; ++cell) {
-	    if (s[cell] > 1.0 || s[cell] < 0.0) {
-		if (clamp_sat_) {
-		    s[cell] = std::max(std::min(s[cell], 1.0), 0.0);
-		} else if (s[cell] > 1.001 || s[cell] < -0.001) {
-		    OPM_THROW(std::runtime_error, "Saturation out of range in EulerUpstream: Cell " << cell << "   sat " << s[cell]);
-		}
+	    checkAndPossiblyClampSat(s[cell], cell);
+	}
+    }
+
+
+
+    template <class GI, class RP, class BC>
+    inline void EulerUpstream<GI, RP, BC>::checkAndPossiblyClampSat(double& s, const int cell) const
+    {
+	if (s > 1.0 || s < 0.0) {
+	    if (clamp_sat_) {
+		s = std::max(std::min(s, 1.0), 0.0);
+	    } else if (s > 1.001 || s < -0.001) {
+		OPM_THROW(std::runtime_error, "Saturation out of range in EulerUpstream: Cell " << cell << "   sat " << s);
 	    }
 	}
     }
@@ -385,6 +556,36 @@ namespace Opm
     }
 
 
+
+
+
+    template <class GI, class RP, class BC>
+    template <class PressureSolution>
+    inline void EulerUpstream<GI, RP, BC>::localTimeStep(std::vector<double>& saturation,
+							 const int min_level,
+							 const typename GI::Vector& gravity,
+							 const PressureSolution& pressure_sol,
+							 const Opm::SparseVector<double>& injection_rates) const
+    {
+	const int num_active = level_count_[min_level];
+        if (method_capillary_) {
+            residual_computer_.computeCapPressures(saturation, lts_cells_, num_active);
+        }
+	// The local residual is already multiplied by the level time steps.
+	residual_computer_.computeResidualLocal(saturation, gravity, pressure_sol, injection_rates,
+						method_viscous_, method_gravity_, method_capillary_,
+						cell_level_, level_dt_, min_level,
+						lts_cells_, num_active, residual_);
+	for (int i = 0; i < num_active; ++i) {
+	    const int cell = lts_cells_[i]->index();
+	    saturation[cell] += residual_[cell]/porevol_[cell];
+	    if (check_sat_ || clamp_sat_) {
+		checkAndPossiblyClampSat(saturation[cell], cell);
+	    }
+	}
+    }
+
+
 } // end namespace Opm
 
 
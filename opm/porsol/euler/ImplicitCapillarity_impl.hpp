@@ -40,6 +40,7 @@
 #include <opm/core/utility/Average.hpp>
 #include <opm/parser/eclipse/Units/Units.hpp>
 #include <opm/core/utility/RootFinders.hpp>
+#include <opm/porsol/common/BrentRootFinder.hpp>
 #include <opm/core/utility/StopWatch.hpp>
 #include <dune/grid/common/Volumes.hpp>
 #include <opm/porsol/common/ReservoirPropertyFixedMobility.hpp>
@@ -206,8 +207,7 @@ namespace Opm
         const int max_iter = 40;
         const double nonlinear_tolerance = 1e-12;
         int iterations_used = -1;
-        typedef Opm::RegulaFalsi<Opm::ThrowOnError> RootFinder;
-        double mod_correct = RootFinder::solve(functor, mod_low, mod_high, max_iter, nonlinear_tolerance, iterations_used);
+        double mod_correct = BrentRootFinder::solve(functor, mod_low, mod_high, max_iter, nonlinear_tolerance, iterations_used);
         std::cout << "Moved capillary pressure solution by " << mod_correct << " after "
                   << iterations_used << " iterations." << std::endl;
         // saturation = functor.lastSaturations();
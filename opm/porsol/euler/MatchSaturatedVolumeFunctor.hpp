@@ -37,7 +37,6 @@
 #define OPENRS_MATCHSATURATEDVOLUMEFUNCTOR_HEADER
 
 
-#include <boost/bind.hpp>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -64,6 +63,10 @@ namespace Opm
     }
 
 
+    /// Functor whose zero is the capillary pressure shift dp for which the
+    /// capillary limit saturations of cap_press + dp have the same saturated
+    /// volume as orig_sat. Cell pore volumes are computed once, and each
+    /// evaluation is a single (OpenMP parallel) pass over the cells.
     template <class GridInterface, class ReservoirProperties>
     struct MatchSaturatedVolumeFunctor
     {
@@ -72,26 +75,37 @@ namespace Opm
                                     const ReservoirProperties& rp,
                                     const std::vector<double>& orig_sat,
                                     const std::vector<double>& cap_press)
-            : grid_(grid),
-              rp_(rp),
+            : rp_(rp),
               cap_press_(cap_press),
-              orig_satvol_(0.0)
+              orig_satvol_(0.0),
+              tot_pore_vol_(0.0),
+              num_evals_(0)
         {
-            std::pair<double, double> vols = poreSatVolumes(grid, rp, orig_sat);
-            orig_satvol_ = vols.second;
-            int num_cells = orig_sat.size();
-            cp_new_.resize(num_cells);
-            sat_.resize(num_cells);
+            typedef typename GridInterface::CellIterator CellIter;
+            pore_vol_.resize(grid.numberOfCells());
+            for (CellIter c = grid.cellbegin(); c != grid.cellend(); ++c) {
+                const int ci = c->index();
+                pore_vol_[ci] = c->volume()*rp.porosity(ci);
+                tot_pore_vol_ += pore_vol_[ci];
+                orig_satvol_ += pore_vol_[ci]*orig_sat[ci];
+            }
+            sat_.resize(pore_vol_.size());
         }
 
 
         double operator()(double dp) const
         {
-            std::transform(cap_press_.begin(), cap_press_.end(), cp_new_.begin(),
-                           boost::bind(std::plus<double>(), dp, _1));
-            computeSaturations();
-            std::pair<double, double> vols = poreSatVolumes(grid_, rp_, sat_);
-            return (vols.second - orig_satvol_)/vols.first;
+            const int num_cells = pore_vol_.size();
+            double sat_vol = 0.0;
+#ifdef HAVE_OPENMP
+#pragma omp parallel for reduction(+:sat_vol) schedule(static)
+#endif
+            for (int c = 0; c < num_cells; ++c) {
+                sat_[c] = rp_.saturationFromCapillaryPressure(c, cap_press_[c] + dp);
+                sat_vol += pore_vol_[c]*sat_[c];
+            }
+            ++num_evals_;
+            return (sat_vol - orig_satvol_)/tot_pore_vol_;
         }
 
         const std::vector<double>& lastSaturations() const
@@ -99,21 +113,20 @@ namespace Opm
             return sat_;
         }
 
-    private:
-        void computeSaturations() const
+        /// Number of function evaluations so far.
+        int numEvaluations() const
         {
-            int num_cells = grid_.numberOfCells();
-            for (int c = 0; c < num_cells; ++c) {
-                sat_[c] = rp_.saturationFromCapillaryPressure(c, cp_new_[c]);
-            }
+            return num_evals_;
         }
 
-        const GridInterface& grid_;
+    private:
         const ReservoirProperties& rp_;
         const std::vector<double>& cap_press_;
+        std::vector<double> pore_vol_;
         double orig_satvol_;
-        mutable std::vector<double> cp_new_;
+        double tot_pore_vol_;
         mutable std::vector<double> sat_;
+        mutable int num_evals_;
     };
 
 } // namespace Opm
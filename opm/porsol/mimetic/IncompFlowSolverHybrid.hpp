@@ -42,6 +42,8 @@
 #include <opm/core/utility/SparseTable.hpp>
 #include <opm/porsol/common/BoundaryConditions.hpp>
 #include <opm/porsol/common/Matrix.hpp>
+#include <opm/porsol/common/MixedPrecisionPreconditioner.hpp>
+#include <opm/porsol/common/PerformanceLog.hpp>
 
 #include <opm/common/utility/platform_dependent/disable_warnings.h>
 
@@ -69,12 +71,19 @@
 #endif
 #include <dune/istl/paamg/kamg.hh>
 #include <dune/istl/paamg/pinfo.hh>
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#if defined(HAVE_MPI) && HAVE_MPI
+#include <mpi.h>
+#endif
+
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <map>
 #include <numeric>
 #include <ostream>
@@ -506,8 +515,10 @@ namespace Opm {
             total_num_faces_        =  0;
             matrix_structure_valid_ = false;
             do_regularization_      = true; // Assume pure Neumann by default.
+            single_precision_failed_ = false;
 
             bdry_id_map_.clear();
+            clearDistribution();
 
             std::vector<Scalar>().swap(L_);
             std::vector<Scalar>().swap(g_);
@@ -670,10 +681,21 @@ namespace Opm {
                    double prolongate_factor = 1.6,
                    int smooth_steps = 1)
         {
+            if (distributed_ && !distribution_set_up_) {
+                setupDistribution();
+            }
+            double start = wallClockTime();
             assembleDynamic(r, sat, bc, src);
+            PerformanceLog::global().addTime("flow_solver/assembly", wallClockTime() - start);
 //             static int count = 0;
 //             ++count;
 //             printSystem(std::string("linsys_mimetic-") + boost::lexical_cast<std::string>(count));
+#if defined(HAVE_MPI) && HAVE_MPI
+            if (!cell_is_interior_.empty()) {
+                solveLinearSystemDistributed(residual_tolerance, linsolver_verbosity,
+                                             linsolver_maxit, prolongate_factor, same_matrix, smooth_steps);
+            } else
+#endif
             switch (linsolver_type) {
             case 0: // ILU0 preconditioned CG
               solveLinearSystem(residual_tolerance, linsolver_verbosity, linsolver_maxit);
@@ -705,6 +727,84 @@ namespace Opm {
             computePressureAndFluxes(r, sat);
         }
 
+        /// @brief
+        ///    Build the AMG hierarchy of linsolver_type 1, 2 and 3 on
+        ///    a single precision copy of the system matrix, and smooth
+        ///    in single precision, while CG still runs in double
+        ///    precision.  This halves the memory traffic of the
+        ///    preconditioner, which dominates the pressure solves on
+        ///    large models.
+        ///
+        /// @details
+        ///    If CG does not converge with the single precision
+        ///    preconditioner within linsolver_maxit iterations, or
+        ///    max_iterations if linsolver_maxit is zero, the system is
+        ///    solved again with a double precision preconditioner.
+        ///    The double precision preconditioner is then used until
+        ///    the next call to clear().  Such fallbacks are counted in
+        ///    the "flow_solver/single_precision_fallbacks" entry of
+        ///    PerformanceLog::global().
+        ///
+        /// @param [in] on Whether to use single precision.
+        ///
+        /// @param [in] max_iterations Iteration limit of the single
+        ///    precision attempt when solve() is given no limit.
+        void setSinglePrecisionPreconditioner(bool on, int max_iterations = 200)
+        {
+            single_precision_precond_ = on;
+            single_precision_maxit_ = max_iterations;
+        }
+
+        /// @brief
+        ///    Distribute the pressure solves over the processes of
+        ///    MPI_COMM_WORLD.  All processes must call solve()
+        ///    together, with the same boundary conditions.
+        ///
+        /// @details
+        ///    The grid must have been partitioned over the processes
+        ///    with Dune::CpGrid::loadBalance(), with at least one
+        ///    layer of overlap cells, before the grid interface given
+        ///    to init() was built.  Each process then only enumerates,
+        ///    assembles and stores the faces, matrix rows and vectors
+        ///    of its own part of the grid.  A face is owned by the
+        ///    process on which the face's cell with the smallest
+        ///    global id is interior, and the system is solved by CG
+        ///    with Dune's parallel AMG, on
+        ///    OwnerOverlapCopyCommunication.  The linsolver_type given
+        ///    to solve() and the single precision option are then not
+        ///    used.
+        ///
+        ///    After solve(), the pressures and fluxes are valid in the
+        ///    interior cells of this process (isOwnedCell()), so sums
+        ///    over the solution must be taken over those cells and
+        ///    then over the processes.  The boundary conditions must
+        ///    prescribe the pressure somewhere, and periodic boundary
+        ///    conditions are not supported.
+        ///
+        ///    With a single process, or without MPI support, the
+        ///    sequential solvers are used.
+        ///
+        /// @param [in] on Whether to distribute the solves.
+        void setDistributed(bool on)
+        {
+            if (on != distributed_) {
+                distributed_ = on;
+                clearDistribution();
+            }
+        }
+
+        /// @brief
+        ///    Whether the solution in a cell is computed by this
+        ///    process, that is, whether the cell is interior to its
+        ///    partition.  Always true unless the solves are
+        ///    distributed, see setDistributed().
+        ///
+        /// @param [in] cell_index The grid's index of the cell.
+        bool isOwnedCell(int cell_index) const
+        {
+            return cell_is_interior_.empty() || cell_is_interior_[cell_index];
+        }
+
     private:
         /// A helper class for postProcessFluxes.
         class FaceFluxes
@@ -751,9 +851,12 @@ namespace Opm {
         ///    This method modifies the solution object so that
         ///    out-fluxes of twin faces (that is, the two faces on a
         ///    cell-cell intersection) will be made antisymmetric.
+        ///    With distributed solves, all processes must call this
+        ///    method together.
         ///
         /// @return
-        ///    The maximum modification made to the fluxes.
+        ///    The maximum modification made to the fluxes, over all
+        ///    processes.
         double postProcessFluxes()
         {
             typedef typename GridInterface::CellIterator CI;
@@ -806,7 +909,13 @@ namespace Opm {
                     }
                 }
             }
-            return face_fluxes.maxMod();
+            double max_mod = face_fluxes.maxMod();
+#if defined(HAVE_MPI) && HAVE_MPI
+            if (!cell_is_interior_.empty()) {
+                MPI_Allreduce(MPI_IN_PLACE, &max_mod, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            }
+#endif
+            return max_mod;
         }
 
 
@@ -1403,11 +1512,17 @@ namespace Opm {
             }
             Adapter opS(S_);
 
-            // Construct preconditioner.
-            Dune::SeqILU0<Matrix,Vector,Vector> precond(S_, 1.0);
+            // Construct preconditioner.  The factorization is done in
+            // the constructor, so it is timed as the setup.
+            typedef Dune::SeqILU0<Matrix,Vector,Vector> Precond;
+            boost::scoped_ptr<Precond> precond;
+            {
+                ScopedTimer timer("flow_solver/preconditioner_setup");
+                precond.reset(new Precond(S_, 1.0));
+            }
 
             // Construct solver for system of linear equations.
-            Dune::CGSolver<Vector> linsolve(opS, precond, residTol,
+            Dune::CGSolver<Vector> linsolve(opS, *precond, residTol,
                                             (maxit>0)?maxit:S_.N(), verbosity_level);
 
             Dune::InverseOperatorResult result;
@@ -1415,7 +1530,11 @@ namespace Opm {
 
             // Solve system of linear equations to recover
             // face/contact pressure values (soln_).
-            linsolve.apply(soln_, rhs_, result);
+            {
+                ScopedTimer timer("flow_solver/linear_solve");
+                linsolve.apply(soln_, rhs_, result);
+            }
+            PerformanceLog::global().addCount("flow_solver/linear_iterations", result.iterations);
             if (!result.converged) {
                 OPM_THROW(std::runtime_error, "Linear solver failed to converge in " << result.iterations << " iterations.\n"
                       << "Residual reduction achieved is " << result.reduction << '\n');
@@ -1431,6 +1550,12 @@ namespace Opm {
         typedef Dune::BlockVector<VectorBlockType>        Vector;
         typedef Dune::MatrixAdapter<Matrix,Vector,Vector> Operator;
 
+        // Single precision copy of the system, for the AMG hierarchy
+        // when a single precision preconditioner is requested.
+        typedef Dune::BCRSMatrix <Dune::FieldMatrix<float, 1, 1> >       FloatMatrix;
+        typedef Dune::BlockVector<Dune::FieldVector<float, 1> >          FloatVector;
+        typedef Dune::MatrixAdapter<FloatMatrix,FloatVector,FloatVector> FloatOperator;
+
         // AMG specific types.
         // Old:   FIRST_DIAGONAL 1, SYMMETRIC 1, SMOOTHER_ILU 1, ANISOTROPIC_3D 0
         // SPE10: FIRST_DIAGONAL 0, SYMMETRIC 1, SMOOTHER_ILU 0, ANISOTROPIC_3D 1
@@ -1456,22 +1581,38 @@ namespace Opm {
         typedef Dune::Amg::RowSum        CouplingMetric;
 #endif
 
+        // The AMG types for a given matrix and vector type, so that the
+        // hierarchy can be built in double or single precision.
+        template <class M, class V>
+        struct AMGTypes
+        {
+            typedef Dune::MatrixAdapter<M,V,V> Operator;
 #if SYMMETRIC
-        typedef Dune::Amg::SymmetricCriterion<Matrix,CouplingMetric>   CriterionBase;
+            typedef Dune::Amg::SymmetricCriterion<M,CouplingMetric>   CriterionBase;
 #else
-        typedef Dune::Amg::UnSymmetricCriterion<Matrix,CouplingMetric> CriterionBase;
+            typedef Dune::Amg::UnSymmetricCriterion<M,CouplingMetric> CriterionBase;
 #endif
 
 #if SMOOTHER_BGS
-      typedef Dune::SeqOverlappingSchwarz<Matrix,Vector,Dune::MultiplicativeSchwarzMode> Smoother;
+            typedef Dune::SeqOverlappingSchwarz<M,V,Dune::MultiplicativeSchwarzMode> Smoother;
 #else
 #if SMOOTHER_ILU
-        typedef Dune::SeqILU0<Matrix,Vector,Vector>        Smoother;
+            typedef Dune::SeqILU0<M,V,V>        Smoother;
 #else
-        typedef Dune::SeqSSOR<Matrix,Vector,Vector>        Smoother;
+            typedef Dune::SeqSSOR<M,V,V>        Smoother;
 #endif
 #endif
-        typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
+            typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
+
+            typedef Dune::Amg::AMG<Operator,V,Smoother,Dune::Amg::SequentialInformation> AMG;
+            typedef Dune::Amg::KAMG<Operator,V,Smoother,Dune::Amg::SequentialInformation,
+                                    Dune::CGSolver<V> > KAMG;
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+            typedef Dune::Amg::FastAMG<Operator,V> FastAMG;
+            typedef Dune::Amg::CoarsenCriterion<Dune::Amg::AggregationCriterion<
+                Dune::Amg::SymmetricMatrixDependency<M,CouplingMetric> > > FastCriterion;
+#endif
+        };
 
 
         // --------- storing the AMG operator and preconditioner --------
@@ -1479,26 +1620,280 @@ namespace Opm {
         typedef Dune::Preconditioner<Vector,Vector>   PrecondBase;
         boost::scoped_ptr<PrecondBase> precond_;
 
+        // With a single precision preconditioner, precond_ converts
+        // between the precisions and applies float_precond_, which is
+        // built on Sf_.
+        typedef Dune::Preconditioner<FloatVector,FloatVector> FloatPrecondBase;
+        FloatMatrix                         Sf_;
+        boost::scoped_ptr<FloatOperator>    opSf_;
+        boost::scoped_ptr<FloatPrecondBase> float_precond_;
+        bool single_precision_precond_ = false;
+        int  single_precision_maxit_   = 200;
+        bool precond_is_single_        = false;
+        bool single_precision_failed_  = false;
+
+        // ------------- distributed solves, see setDistributed() -------------
+        // Whether each cell is interior to the partition of this
+        // process, and whether each face is owned by it or is a face
+        // of an overlap cell whose other cell is not on this process.
+        // All empty unless the solves are distributed over several
+        // processes.
+        bool                 distributed_         = false;
+        bool                 distribution_set_up_ = false;
+        int                  rank_                = 0;
+        std::vector<char>    cell_is_interior_;
+        std::vector<char>    dof_is_owned_;
+        std::vector<char>    dof_is_cut_;
+
+#if defined(HAVE_MPI) && HAVE_MPI
+        // Global face ids are built from global cell ids and local face
+        // numbers, which need not fit in an int on large grids.
+        typedef Dune::OwnerOverlapCopyCommunication<long int,int>              ParallelInformation;
+        typedef Dune::OverlappingSchwarzOperator<Matrix,Vector,Vector,ParallelInformation> ParallelOperator;
+        typedef Dune::OverlappingSchwarzScalarProduct<Vector,ParallelInformation> ParallelScalarProduct;
+#if SMOOTHER_ILU
+        typedef Dune::SeqILU0<Matrix,Vector,Vector>                             ParallelSmootherBase;
+#else
+        typedef Dune::SeqSSOR<Matrix,Vector,Vector>                             ParallelSmootherBase;
+#endif
+        typedef Dune::BlockPreconditioner<Vector,Vector,ParallelInformation,ParallelSmootherBase> ParallelSmoother;
+        typedef Dune::Amg::AMG<ParallelOperator,Vector,ParallelSmoother,ParallelInformation> ParallelAMG;
+
+        boost::scoped_ptr<ParallelInformation>    par_info_;
+        boost::scoped_ptr<ParallelOperator>       par_op_;
+        boost::scoped_ptr<ParallelScalarProduct>  par_sp_;
+        boost::scoped_ptr<ParallelAMG>            par_precond_;
+
+        // Sends the global ids of the faces of the interior cells, and
+        // whether they are on the boundary of the whole grid, to the
+        // processes holding the cells as overlap cells.  There, a
+        // boundary face that is not on the boundary of the whole grid
+        // is a cut face, and takes the id of its owner.  Faces that
+        // exist on both sides are checked to have the same id, which
+        // holds as long as the grid keeps the face order of each cell.
+        class FaceIdHandle
+            : public Dune::CommDataHandleIF<FaceIdHandle, long int>
+        {
+        public:
+            FaceIdHandle(IncompFlowSolverHybrid& solver, std::vector<long int>& face_id, int max_ncf)
+                : solver_(solver), face_id_(face_id), max_ncf_(max_ncf), mismatch_(false)
+            {
+            }
+            bool contains(int /* dim */, int codim) const
+            {
+                return codim == 0;
+            }
+            bool fixedsize(int /* dim */, int /* codim */) const
+            {
+                return true;
+            }
+            bool fixedSize(int /* dim */, int /* codim */) const
+            {
+                return true;
+            }
+            template <class Entity>
+            std::size_t size(const Entity& /* e */) const
+            {
+                return 2*max_ncf_;
+            }
+            template <class Buffer, class Entity>
+            void gather(Buffer& buf, const Entity& e) const
+            {
+                const Opm::SparseTable<int>& cf = solver_.flowSolution_.cellFaces_;
+                const int c0 = solver_.flowSolution_.cellno_[solver_.pgrid_->mapper().map(e)];
+                const int nf = cf.rowSize(c0);
+                for (int i = 0; i < max_ncf_; ++i) {
+                    buf.write(i < nf ? face_id_[cf[c0][i]] : -1L);
+                }
+                for (int i = 0; i < max_ncf_; ++i) {
+                    buf.write(i < nf && cf[c0][i] >= solver_.num_internal_faces_ ? 1L : 0L);
+                }
+            }
+            template <class Buffer, class Entity>
+            void scatter(Buffer& buf, const Entity& e, std::size_t /* n */)
+            {
+                std::vector<long int> id(max_ncf_), is_bdry(max_ncf_);
+                for (int i = 0; i < max_ncf_; ++i) {
+                    buf.read(id[i]);
+                }
+                for (int i = 0; i < max_ncf_; ++i) {
+                    buf.read(is_bdry[i]);
+                }
+                const Opm::SparseTable<int>& cf = solver_.flowSolution_.cellFaces_;
+                const int c0 = solver_.flowSolution_.cellno_[solver_.pgrid_->mapper().map(e)];
+                const int nf = cf.rowSize(c0);
+                if (id[nf - 1] < 0 || (nf < max_ncf_ && id[nf] >= 0)) {
+                    mismatch_ = true;
+                    return;
+                }
+                for (int i = 0; i < nf; ++i) {
+                    const int dof = cf[c0][i];
+                    const bool local_bdry = dof >= solver_.num_internal_faces_;
+                    if (local_bdry && !is_bdry[i]) {
+                        solver_.dof_is_cut_[dof] = 1;
+                        face_id_[dof] = id[i];
+                    } else if (!local_bdry && is_bdry[i]) {
+                        mismatch_ = true;
+                    } else if (face_id_[dof] != id[i]) {
+                        mismatch_ = true;
+                    }
+                }
+            }
+            bool mismatch() const
+            {
+                return mismatch_;
+            }
+        private:
+            IncompFlowSolverHybrid& solver_;
+            std::vector<long int>&  face_id_;
+            int                     max_ncf_;
+            bool                    mismatch_;
+        };
+#endif
+
 
         // ----------------------------------------------------------------
-        void solveLinearSystemAMG(double residual_tolerance, int verbosity_level,
-                                  int maxit, double prolong_factor, bool same_matrix, int smooth_steps)
+        void clearDistribution()
         // ----------------------------------------------------------------
         {
-            typedef Dune::Amg::AMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation>
-                Precond;
+            distribution_set_up_ = false;
+            rank_ = 0;
+            std::vector<char>().swap(cell_is_interior_);
+            std::vector<char>().swap(dof_is_owned_);
+            std::vector<char>().swap(dof_is_cut_);
+#if defined(HAVE_MPI) && HAVE_MPI
+            par_precond_.reset();
+            par_sp_.reset();
+            par_op_.reset();
+            par_info_.reset();
+#endif
+        }
 
-            // Adapted from upscaling.cc by Arne Rekdal, 2009
-            Scalar residTol = residual_tolerance;
 
-            if (!same_matrix) {
-                // Regularize the matrix (only for pure Neumann problems...)
-                if (do_regularization_) {
-                    S_[0][0] *= 2;
+        // ----------------------------------------------------------------
+        bool isCutFace(int dof) const
+        // ----------------------------------------------------------------
+        {
+            return !dof_is_cut_.empty() && dof_is_cut_[dof];
+        }
+
+
+        // ----------------------------------------------------------------
+        // Find the interior cells, the owned and the cut faces of the
+        // partition of this process, number the faces globally and set
+        // up the communication of the distributed solves.  Leaves the
+        // solver sequential when there is only one process.
+        void setupDistribution()
+        // ----------------------------------------------------------------
+        {
+            distribution_set_up_ = true;
+#if defined(HAVE_MPI) && HAVE_MPI
+            int size = 1;
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+            MPI_Comm_size(MPI_COMM_WORLD, &size);
+            if (size == 1) {
+                rank_ = 0;
+                return;
+            }
+            if (!ppartner_dof_.empty()) {
+                OPM_THROW(std::runtime_error, "Periodic boundary conditions are not supported "
+                          "by the distributed pressure solver.");
+            }
+
+            typedef typename GridInterface::CellIterator CI;
+            const std::vector<int>& cell = flowSolution_.cellno_;
+            const Opm::SparseTable<int>& cf = flowSolution_.cellFaces_;
+            const int nc = pgrid_->numberOfCells();
+
+            std::vector<long int> cell_gid(nc);
+            cell_is_interior_.assign(nc, 0);
+            int num_interior = 0;
+            for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+                cell_gid[c->index()] = c->globalId();
+                if (c->partitionType() == Dune::InteriorEntity) {
+                    cell_is_interior_[c->index()] = 1;
+                    ++num_interior;
                 }
-                opS_.reset(new Operator(S_));
-		
-                // Construct preconditioner.
+            }
+            // A grid that was not load balanced has no overlap cells.
+            int unpartitioned = (num_interior == nc);
+            MPI_Allreduce(MPI_IN_PLACE, &unpartitioned, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+            if (unpartitioned) {
+                clearDistribution();
+                OPM_THROW(std::runtime_error, "Distributed pressure solves need a grid partitioned "
+                          "with Dune::CpGrid::loadBalance().");
+            }
+
+            // A face is numbered by the side of its cell with the
+            // smallest global id, as id*max_ncf + local face number.
+            // Only the cut faces miss that cell, and get their
+            // numbers from the processes where their cell is interior.
+            int max_ncf = max_ncf_;
+            MPI_Allreduce(MPI_IN_PLACE, &max_ncf, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+            std::vector<long int> face_id(total_num_faces_, std::numeric_limits<long int>::max());
+            for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+                const int c0 = cell[c->index()];
+                for (int i = 0; i < cf.rowSize(c0); ++i) {
+                    const long int id = cell_gid[c->index()]*max_ncf + i;
+                    face_id[cf[c0][i]] = std::min(face_id[cf[c0][i]], id);
+                }
+            }
+            dof_is_cut_.assign(total_num_faces_, 0);
+            FaceIdHandle handle(*this, face_id, max_ncf);
+            pgrid_->grid().communicate(handle, Dune::InteriorBorder_All_Interface,
+                                       Dune::ForwardCommunication);
+            int mismatch = handle.mismatch();
+            MPI_Allreduce(MPI_IN_PLACE, &mismatch, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+            if (mismatch) {
+                clearDistribution();
+                OPM_THROW(std::runtime_error, "The faces of the overlap cells do not match "
+                          "the faces of their interior copies.");
+            }
+
+            // The owned faces are those numbered by an interior cell.
+            dof_is_owned_.assign(total_num_faces_, 0);
+            for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+                if (!cell_is_interior_[c->index()]) {
+                    continue;
+                }
+                const int c0 = cell[c->index()];
+                for (int i = 0; i < cf.rowSize(c0); ++i) {
+                    if (face_id[cf[c0][i]] == cell_gid[c->index()]*max_ncf + i) {
+                        dof_is_owned_[cf[c0][i]] = 1;
+                    }
+                }
+            }
+
+            par_info_.reset(new ParallelInformation(MPI_COMM_WORLD));
+            typedef Dune::ParallelLocalIndex<Dune::OwnerOverlapCopyAttributeSet::AttributeSet> LocalIndex;
+            auto& indices = par_info_->indexSet();
+            indices.beginResize();
+            for (int dof = 0; dof < total_num_faces_; ++dof) {
+                indices.add(face_id[dof],
+                            LocalIndex(dof, dof_is_owned_[dof] ? Dune::OwnerOverlapCopyAttributeSet::owner
+                                                               : Dune::OwnerOverlapCopyAttributeSet::copy,
+                                       true));
+            }
+            indices.endResize();
+            par_info_->remoteIndices().template rebuild<false>();
+#endif
+        }
+
+
+        // ----------------------------------------------------------------
+        // Builds the multigrid preconditioner of the given linsolver_type
+        // (1: AMG, 2: KAMG, 3: fast AMG) on op. The caller owns the result.
+        template <class M, class V>
+        static Dune::Preconditioner<V,V>*
+        createMultigrid(typename AMGTypes<M,V>::Operator& op, int linsolver_type,
+                        int verbosity_level, double prolong_factor, int smooth_steps)
+        // ----------------------------------------------------------------
+        {
+            typedef AMGTypes<M,V> Types;
+            switch (linsolver_type) {
+            case 1:
+            case 2: {
+                typedef typename Types::AMG Precond;
                 double relax = 1;
                 typename Precond::SmootherArgs smootherArgs;
                 smootherArgs.relaxationFactor = relax;
@@ -1506,22 +1901,78 @@ namespace Opm {
                 smootherArgs.overlap =  Precond::SmootherArgs::none;
                 smootherArgs.onthefly = false;
 #endif
-                Criterion criterion;
+                typename Types::Criterion criterion;
                 criterion.setDebugLevel(verbosity_level);
 #if ANISOTROPIC_3D
                 criterion.setDefaultValuesAnisotropic(3, 2);
 #endif
                 criterion.setProlongationDampingFactor(prolong_factor);
                 criterion.setBeta(1e-10);
+                if (linsolver_type == 2) {
+                    return new typename Types::KAMG(op, criterion, smootherArgs, 2, smooth_steps, smooth_steps);
+                }
                 criterion.setNoPreSmoothSteps(smooth_steps);
                 criterion.setNoPostSmoothSteps(smooth_steps);
                 criterion.setGamma(1); // V-cycle; this is the default
-                precond_.reset(new Precond(*opS_, criterion, smootherArgs));
+                return new Precond(op, criterion, smootherArgs);
             }
-            // Construct solver for system of linear equations.
-            Dune::CGSolver<Vector> linsolve(*opS_, dynamic_cast<Precond&>(*precond_), residTol, (maxit>0)?maxit:S_.N(), verbosity_level);
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+            case 3: {
+                typename Types::FastCriterion criterion;
+                criterion.setDebugLevel(verbosity_level);
+#if ANISOTROPIC_3D
+                criterion.setDefaultValuesAnisotropic(3, 2);
+#endif
+                criterion.setProlongationDampingFactor(prolong_factor);
+                criterion.setBeta(1e-10);
+                Dune::Amg::Parameters parms;
+                parms.setDebugLevel(verbosity_level);
+                parms.setNoPreSmoothSteps(smooth_steps);
+                parms.setNoPostSmoothSteps(smooth_steps);
+                return new typename Types::FastAMG(op, criterion, parms);
+            }
+#endif
+            default:
+                OPM_THROW(std::runtime_error, "No multigrid preconditioner for linsolver_type " << linsolver_type);
+            }
+        }
+
+
+        // ----------------------------------------------------------------
+        void setupMultigrid(int linsolver_type, int verbosity_level,
+                            double prolong_factor, int smooth_steps, bool single)
+        // ----------------------------------------------------------------
+        {
+            ScopedTimer timer("flow_solver/preconditioner_setup");
+            precond_.reset();
+            float_precond_.reset();
+            opSf_.reset();
+            opS_.reset(new Operator(S_));
+            if (single) {
+                convertMatrix(S_, Sf_);
+                opSf_.reset(new FloatOperator(Sf_));
+                float_precond_.reset(createMultigrid<FloatMatrix,FloatVector>(*opSf_, linsolver_type, verbosity_level,
+                                                                              prolong_factor, smooth_steps));
+                precond_.reset(new MixedPrecisionPreconditioner<Vector,FloatVector>(*float_precond_));
+            } else {
+                if (Sf_.N() > 0) {
+                    Sf_ = FloatMatrix();
+                }
+                precond_.reset(createMultigrid<Matrix,Vector>(*opS_, linsolver_type, verbosity_level,
+                                                              prolong_factor, smooth_steps));
+            }
+            precond_is_single_ = single;
+        }
+
+
+        // ----------------------------------------------------------------
+        template <template <class> class KrylovSolver>
+        void applyMultigridSolver(double residual_tolerance, int verbosity_level,
+                                  int maxit, Dune::InverseOperatorResult& result)
+        // ----------------------------------------------------------------
+        {
+            KrylovSolver<Vector> linsolve(*opS_, *precond_, residual_tolerance, maxit, verbosity_level);
 
-            Dune::InverseOperatorResult result;
             soln_ = 0.0;
             // Adapt initial guess such Dirichlet boundary conditions are 
             // represented, i.e. soln_i=A_{ii}^-1 rhs_i
@@ -1537,76 +1988,81 @@ namespace Opm {
             }
             // Solve system of linear equations to recover
             // face/contact pressure values (soln_).
-            linsolve.apply(soln_, rhs_, result);
-            if (!result.converged) {
-                OPM_THROW(std::runtime_error, "Linear solver failed to converge in " << result.iterations << " iterations.\n"
-                      << "Residual reduction achieved is " << result.reduction << '\n');
+            {
+                ScopedTimer timer("flow_solver/linear_solve");
+                linsolve.apply(soln_, rhs_, result);
             }
-
+            PerformanceLog::global().addCount("flow_solver/linear_iterations", result.iterations);
         }
 
-#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
 
         // ----------------------------------------------------------------
-        void solveLinearSystemFastAMG(double residual_tolerance, int verbosity_level,
-                                  int maxit, double prolong_factor, bool same_matrix, int smooth_steps)
+        template <template <class> class KrylovSolver>
+        void solveLinearSystemMultigrid(int linsolver_type, double residual_tolerance, int verbosity_level,
+                                        int maxit, double prolong_factor, bool same_matrix, int smooth_steps)
         // ----------------------------------------------------------------
         {
-            typedef Dune::Amg::FastAMG<Operator,Vector> Precond;
-
             // Adapted from upscaling.cc by Arne Rekdal, 2009
             Scalar residTol = residual_tolerance;
 
-            if (!same_matrix) {
-                // Regularize the matrix (only for pure Neumann problems...)
-                if (do_regularization_) {
-                    S_[0][0] *= 2;
-                }
-                opS_.reset(new Operator(S_));
-		
-                // Construct preconditioner.
-                typedef Dune::Amg::AggregationCriterion<Dune::Amg::SymmetricMatrixDependency<Matrix,CouplingMetric> > CriterionBase;
-
-                typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
-                Criterion criterion;
-                criterion.setDebugLevel(verbosity_level);
-#if ANISOTROPIC_3D
-                criterion.setDefaultValuesAnisotropic(3, 2);
-#endif
-                criterion.setProlongationDampingFactor(prolong_factor);
-                criterion.setBeta(1e-10);
-                Dune::Amg::Parameters parms;
-                parms.setDebugLevel(verbosity_level);
-                parms.setNoPreSmoothSteps(smooth_steps);
-                parms.setNoPostSmoothSteps(smooth_steps);
-                precond_.reset(new Precond(*opS_, criterion, parms));
+            // Regularize the matrix (only for pure Neumann problems...)
+            // This must be done also when reusing the preconditioner,
+            // since S_ is reassembled for every solve.
+            if (do_regularization_) {
+                S_[0][0] *= 2;
+            }
+            const bool single = single_precision_precond_ && !single_precision_failed_;
+            if (!same_matrix || !precond_ || precond_is_single_ != single) {
+                setupMultigrid(linsolver_type, verbosity_level, prolong_factor, smooth_steps, single);
             }
-            // Construct solver for system of linear equations.
-            Dune::GeneralizedPCGSolver<Vector> linsolve(*opS_, dynamic_cast<Precond&>(*precond_), residTol, (maxit>0)?maxit:S_.N(), verbosity_level);
 
+            const int max_iterations = (maxit>0)?maxit:S_.N();
             Dune::InverseOperatorResult result;
-            soln_ = 0.0;
-
-            // Adapt initial guess such Dirichlet boundary conditions are 
-            // represented, i.e. soln_i=A_{ii}^-1 rhs_i
-            typedef typename Dune::BCRSMatrix <MatrixBlockType>::ConstRowIterator RowIter;
-            typedef typename Dune::BCRSMatrix <MatrixBlockType>::ConstColIterator ColIter;
-            for(RowIter ri=S_.begin(); ri!=S_.end(); ++ri){
-                bool isDirichlet=true;
-                for(ColIter ci=ri->begin(); ci!=ri->end(); ++ci)
-                    if(ci.index()!=ri.index() && *ci!=0.0)
-                        isDirichlet=false;
-                if(isDirichlet)
-                    soln_[ri.index()]=rhs_[ri.index()]/S_[ri.index()][ri.index()];
+            if (precond_is_single_) {
+                applyMultigridSolver<KrylovSolver>(residTol, verbosity_level,
+                                                   (maxit>0)?maxit:std::min(max_iterations, single_precision_maxit_),
+                                                   result);
+                if (!result.converged) {
+                    // The single precision hierarchy is not accurate
+                    // enough for this system. Solve again, and from now
+                    // on, in double precision.
+                    if (verbosity_level > 0) {
+                        std::cout << "Single precision preconditioner failed after " << result.iterations
+                                  << " iterations, using double precision." << std::endl;
+                    }
+                    PerformanceLog::global().addCount("flow_solver/single_precision_fallbacks", 1);
+                    single_precision_failed_ = true;
+                    setupMultigrid(linsolver_type, verbosity_level, prolong_factor, smooth_steps, false);
+                }
+            }
+            if (!precond_is_single_) {
+                applyMultigridSolver<KrylovSolver>(residTol, verbosity_level, max_iterations, result);
             }
-            // Solve system of linear equations to recover
-            // face/contact pressure values (soln_).
-            linsolve.apply(soln_, rhs_, result);
             if (!result.converged) {
                 OPM_THROW(std::runtime_error, "Linear solver failed to converge in " << result.iterations << " iterations.\n"
                       << "Residual reduction achieved is " << result.reduction << '\n');
             }
+        }
 
+
+        // ----------------------------------------------------------------
+        void solveLinearSystemAMG(double residual_tolerance, int verbosity_level,
+                                  int maxit, double prolong_factor, bool same_matrix, int smooth_steps)
+        // ----------------------------------------------------------------
+        {
+            solveLinearSystemMultigrid<Dune::CGSolver>(1, residual_tolerance, verbosity_level,
+                                                       maxit, prolong_factor, same_matrix, smooth_steps);
+        }
+
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+
+        // ----------------------------------------------------------------
+        void solveLinearSystemFastAMG(double residual_tolerance, int verbosity_level,
+                                  int maxit, double prolong_factor, bool same_matrix, int smooth_steps)
+        // ----------------------------------------------------------------
+        {
+            solveLinearSystemMultigrid<Dune::GeneralizedPCGSolver>(3, residual_tolerance, verbosity_level,
+                                                                   maxit, prolong_factor, same_matrix, smooth_steps);
         }
 #endif
 
@@ -1614,62 +2070,91 @@ namespace Opm {
         void solveLinearSystemKAMG(double residual_tolerance, int verbosity_level,
                                    int maxit, double prolong_factor, bool same_matrix, int smooth_steps)
         // ----------------------------------------------------------------
-        {        
-            
-            typedef Dune::Amg::KAMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation,
-                              Dune::CGSolver<Vector> >   Precond;
-            // Adapted from upscaling.cc by Arne Rekdal, 2009
-            Scalar residTol = residual_tolerance;
-            if (!same_matrix) {
-                // Regularize the matrix (only for pure Neumann problems...)
-                if (do_regularization_) {
-                    S_[0][0] *= 2;
+        {
+            solveLinearSystemMultigrid<Dune::CGSolver>(2, residual_tolerance, verbosity_level,
+                                                       maxit, prolong_factor, same_matrix, smooth_steps);
+        }
+
+
+
+#if defined(HAVE_MPI) && HAVE_MPI
+        // ----------------------------------------------------------------
+        void solveLinearSystemDistributed(double residual_tolerance, int verbosity_level,
+                                          int maxit, double prolong_factor, bool same_matrix,
+                                          int smooth_steps)
+        // ----------------------------------------------------------------
+        {
+            // Only the processes assembling a Dirichlet face know that
+            // the system need not be regularized.
+            int regularize = do_regularization_;
+            MPI_Allreduce(MPI_IN_PLACE, &regularize, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+            if (regularize) {
+                OPM_THROW(std::runtime_error, "Distributed pressure solves need boundary "
+                          "conditions that prescribe the pressure.");
+            }
+
+            // The rows of faces owned elsewhere become identities, with
+            // zero right hand side, and are overwritten by the owner's
+            // values.
+            typedef typename Matrix::ColIterator ColIter;
+            Vector b(rhs_);
+            soln_ = 0.0;
+            for (int dof = 0; dof < total_num_faces_; ++dof) {
+                if (dof_is_owned_[dof]) {
+                    bool isDirichlet = true;
+                    for (ColIter ci = S_[dof].begin(); ci != S_[dof].end(); ++ci) {
+                        if (ci.index() != std::size_t(dof) && *ci != 0.0) {
+                            isDirichlet = false;
+                        }
+                    }
+                    if (isDirichlet) {
+                        // Initial guess, as in applyMultigridSolver().
+                        soln_[dof] = rhs_[dof]/S_[dof][dof];
+                    }
+                } else {
+                    for (ColIter ci = S_[dof].begin(); ci != S_[dof].end(); ++ci) {
+                        *ci = (ci.index() == std::size_t(dof)) ? 1.0 : 0.0;
+                    }
+                    b[dof] = 0.0;
                 }
-                opS_.reset(new Operator(S_));
-                
-                // Construct preconditioner.
-                double relax = 1;
-                typename Precond::SmootherArgs smootherArgs;
-                smootherArgs.relaxationFactor = relax;
-#if SMOOTHER_BGS
-                smootherArgs.overlap =  Precond::SmootherArgs::none;
-                smootherArgs.onthefly = false;
-#endif
-                Criterion criterion;
-                criterion.setDebugLevel(verbosity_level);
+            }
+            par_info_->copyOwnerToAll(soln_, soln_);
+
+            if (!same_matrix || !par_precond_) {
+                ScopedTimer timer("flow_solver/preconditioner_setup");
+                par_precond_.reset();
+                par_op_.reset(new ParallelOperator(S_, *par_info_));
+                par_sp_.reset(new ParallelScalarProduct(*par_info_));
+                typename ParallelAMG::SmootherArgs smootherArgs;
+                smootherArgs.relaxationFactor = 1.0;
+                typename AMGTypes<Matrix,Vector>::Criterion criterion;
+                criterion.setDebugLevel(rank_ == 0 ? verbosity_level : 0);
 #if ANISOTROPIC_3D
                 criterion.setDefaultValuesAnisotropic(3, 2);
 #endif
                 criterion.setProlongationDampingFactor(prolong_factor);
                 criterion.setBeta(1e-10);
-                precond_.reset(new Precond(*opS_, criterion, smootherArgs, 2, smooth_steps, smooth_steps));
+                criterion.setNoPreSmoothSteps(smooth_steps);
+                criterion.setNoPostSmoothSteps(smooth_steps);
+                criterion.setGamma(1);
+                par_precond_.reset(new ParallelAMG(*par_op_, criterion, smootherArgs, *par_info_));
             }
-            // Construct solver for system of linear equations.
-            Dune::CGSolver<Vector> linsolve(*opS_, dynamic_cast<Precond&>(*precond_), residTol, (maxit>0)?maxit:S_.N(), verbosity_level);
 
+            Dune::CGSolver<Vector> linsolve(*par_op_, *par_sp_, *par_precond_, residual_tolerance,
+                                            (maxit>0)?maxit:S_.N(), rank_ == 0 ? verbosity_level : 0);
             Dune::InverseOperatorResult result;
-            soln_ = 0.0;
-            // Adapt initial guess such Dirichlet boundary conditions are 
-            // represented, i.e. soln_i=A_{ii}^-1 rhs_i
-            typedef typename Dune::BCRSMatrix <MatrixBlockType>::ConstRowIterator RowIter;
-            typedef typename Dune::BCRSMatrix <MatrixBlockType>::ConstColIterator ColIter;
-            for(RowIter ri=S_.begin(); ri!=S_.end(); ++ri){
-                bool isDirichlet=true;
-                for(ColIter ci=ri->begin(); ci!=ri->end(); ++ci)
-                    if(ci.index()!=ri.index() && *ci!=0.0)
-                        isDirichlet=false;
-                if(isDirichlet)
-                    soln_[ri.index()]=rhs_[ri.index()]/S_[ri.index()][ri.index()];
+            {
+                ScopedTimer timer("flow_solver/linear_solve");
+                linsolve.apply(soln_, b, result);
             }
-            // Solve system of linear equations to recover
-            // face/contact pressure values (soln_).
-            linsolve.apply(soln_, rhs_, result);
+            PerformanceLog::global().addCount("flow_solver/linear_iterations", result.iterations);
             if (!result.converged) {
                 OPM_THROW(std::runtime_error, "Linear solver failed to converge in " << result.iterations << " iterations.\n"
                       << "Residual reduction achieved is " << result.reduction << '\n');
             }
-
+            par_info_->copyOwnerToAll(soln_, soln_);
         }
+#endif
 
 
 
@@ -1760,7 +2245,9 @@ namespace Opm {
 
             int k = 0;
             for (FI f = c->facebegin(); f != c->faceend(); ++f, ++k) {
-                if (f->boundary()) {
+                // The cut faces of a partitioned grid are internal to
+                // the whole grid.
+                if (f->boundary() && !isCutFace(cf[c0][k])) {
                     const FlowBC& bcond = bc.flowCond(*f);
                     if (bcond.isDirichlet()) {
                         facetype[k]        = Dirichlet;
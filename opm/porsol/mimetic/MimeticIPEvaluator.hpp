@@ -48,6 +48,7 @@
 #include <opm/porsol/common/fortran.hpp>
 #include <opm/porsol/common/blas_lapack.hpp>
 #include <opm/porsol/common/Matrix.hpp>
+#include <opm/porsol/common/ReservoirPropertyCommon.hpp>
 
 namespace Opm {
     /// @class MimeticIPEvaluator<GridInterface, RockInterface>
@@ -256,8 +257,9 @@ namespace Opm {
             // Binv <- diag(A) * Binv * diag(A)
             symmetricUpdate(fa, Binv);
 
-            // T2 <- N*K
-            matMulAdd_NN(Scalar(1.0), T1, K, Scalar(0.0), T2);
+            // T2 <- N*K.  The storage mode tells whether K is
+            // diagonal, so the tensor itself need not be inspected.
+            multiplyPermeability(T1, K, r.permeabilityStorage() == DiagonalPermStorage, T2);
 
             // Binv <- (T2*N' + Binv) / vol(c)
             //      == (N*K*N' + t*(diag(A) * (I - Q*Q') * diag(A))) / vol(c)
@@ -546,6 +548,30 @@ namespace Opm {
         }
 
     private:
+        /// @brief
+        ///    Compute @code T2 <- T1*K @endcode, as a column scaling
+        ///    of @code T1 @endcode if the permeability tensor is
+        ///    known to be diagonal (the common case for
+        ///    PERMX/PERMY/PERMZ input).
+        template<class PermTensor>
+        static void multiplyPermeability(const SharedFortranMatrix& T1,
+                                         const PermTensor&          K,
+                                         const bool                 diagonal,
+                                         SharedFortranMatrix&       T2)
+        {
+            if (!diagonal) {
+                matMulAdd_NN(Scalar(1.0), T1, K, Scalar(0.0), T2);
+                return;
+            }
+            const int nf = T1.numRows();
+            for (int j = 0; j < dim; ++j) {
+                const Scalar kjj = K(j,j);
+                for (int i = 0; i < nf; ++i) {
+                    T2(i,j) = T1(i,j) * kjj;
+                }
+            }
+        }
+
         int                 max_nf_      ;
         Scalar              totmob_      ;
         Scalar              mob_dens_    ;
@@ -25,6 +25,12 @@
 
 #include <opm/parser/eclipse/Units/Units.hpp>
 
+#include <opm/porsol/common/PerformanceLog.hpp>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -32,6 +38,7 @@
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -665,17 +672,17 @@ double RelPermUpscaleHelper::tesselateGrid(const Opm::Deck& deck)
 
     std::flush(std::cout);
 
-    const auto start = clock();
+    const auto start = wallClockTime();
 
     upscaler.init(deck, boundaryCondition,
                   unit::convert::from(minPerm, prefix::milli*unit::darcy),
                   linsolver_tolerance, linsolver_verbosity, linsolver_type,
                   twodim_hack, linsolver_maxit, linsolver_prolongate_factor,
                   smooth_steps, gravity);
+    upscaler.setLinsolverSinglePrecision(options["linsolver_single_precision"] == "true");
 
-    const auto finish = clock();
-    const auto timeused_tesselation =
-        (static_cast<double>(finish) - start) / CLOCKS_PER_SEC;
+    const auto timeused_tesselation = wallClockTime() - start;
+    PerformanceLog::global().addTime("relperm/tesselation", timeused_tesselation);
 
     if (isMaster) {
         std::cout << " (" << timeused_tesselation << " secs)" << std::endl;
@@ -1037,163 +1044,220 @@ RelPermUpscaleHelper::upscalePermeability(int mpi_rank)
 
     const auto& ecl_idx = upscaler.grid().globalCell();
 
-    const auto start_upscale_wallclock = clock();
-
-    double waterVolumeLF = 0.0;
-
-    // Now loop through the vector of capillary pressure points that this
-    // node should compute.
+    // The pressure points of this process, and the threads to compute
+    // them with.
+    std::vector<int> my_points;
     for (int pointidx = 0; pointidx < points; ++pointidx) {
-
-        // Should "I" (mpi-wise) compute this pressure point?
         if (node_vs_pressurepoint[pointidx] == mpi_rank) {
+            my_points.push_back(pointidx);
+        }
+    }
+    const int num_threads = std::max(1, std::atoi(options["threads"].c_str()));
+#ifndef HAVE_OPENMP
+    static_cast<void>(num_threads);
+#endif
 
-            const auto Ptestvalue = pressurePoints[pointidx];
-
-            std::array<double,2> maxPhasePerm{{0.0, 0.0}};
-            std::array<std::vector<double>,2> phasePermValues;
-            std::array<std::vector<std::vector<double>>,2> phasePermValuesDiag;
-            std::array<double,2> minPhasePerm;
-            std::array<SinglePhaseUpscaler::permtensor_t,2> phasePermTensor;
-
-            for (size_t p = 0; p < (upscaleBothPhases ? 2 : 1); ++p) {
-                waterVolumeLF = 0.0;
-                phasePermValues    [p].resize(satnums.size());
-                phasePermValuesDiag[p].resize(satnums.size());
+    const auto start_upscale_wallclock = wallClockTime();
 
-                for (decltype(ecl_idx.size())
-                         i = 0, n = ecl_idx.size(); i < n; ++i)
+    std::exception_ptr error;
+    bool worker_failed = false;
+#pragma omp parallel num_threads(num_threads)
+    {
+        // The first thread uses our upscaler. The other threads have
+        // workers that share its grid, and hold only their own rock
+        // properties and pressure solvers. The workers are set up
+        // before any thread changes the permeabilities.
+        std::unique_ptr<SinglePhaseUpscaler> worker;
+#ifdef HAVE_OPENMP
+        if (omp_get_thread_num() != 0) {
+            try {
+                worker.reset(new SinglePhaseUpscaler);
+                worker->initWorker(upscaler);
+            }
+            catch (...) {
+#pragma omp critical (relperm_error)
                 {
-                    const auto cell_idx = ecl_idx[i];
-                    double cellPhasePerm =
-                        unit::convert::from(minPerm, prefix::milli*unit::darcy);
-
-                    auto cellPhasePermDiag =
-                        std::vector<double>(3, cellPhasePerm);
-
-                    const auto ix = satnums[cell_idx] - 1;
-                    const auto kx = perms[0][cell_idx];
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    worker_failed = true;
+                }
+            }
+        }
+#pragma omp barrier
+#endif
+        SinglePhaseUpscaler& pointUpscaler = worker ? *worker : upscaler;
+
+        // Now loop through the vector of capillary pressure points that
+        // this node should compute.
+#pragma omp for schedule(dynamic)
+        for (int k = 0; k < int(my_points.size()); ++k) {
+            if (worker_failed) {
+                // The error is rethrown after the parallel region.
+                continue;
+            }
+            const int pointidx = my_points[k];
+            try {
+                ScopedTimer point_timer("relperm/pressure_point");
+                const auto Ptestvalue = pressurePoints[pointidx];
+
+                double waterVolumeLF = 0.0;
+                std::array<double,2> maxPhasePerm{{0.0, 0.0}};
+                std::array<std::vector<double>,2> phasePermValues;
+                std::array<std::vector<std::vector<double>>,2> phasePermValuesDiag;
+                std::array<double,2> minPhasePerm;
+                std::array<SinglePhaseUpscaler::permtensor_t,2> phasePermTensor;
 
-                    if (satnums[cell_idx] > 0) { // handle "no rock" cells with satnum zero
-                        auto PtestvalueCell = Ptestvalue;
-                        if (!dP.empty()) {
-                            PtestvalueCell -= dP[cell_idx];
+                for (size_t p = 0; p < (upscaleBothPhases ? 2 : 1); ++p) {
+                    phasePermValues    [p].resize(satnums.size());
+                    phasePermValuesDiag[p].resize(satnums.size());
+
+                    for (decltype(ecl_idx.size())
+                             i = 0, n = ecl_idx.size(); i < n; ++i)
+                    {
+                        const auto cell_idx = ecl_idx[i];
+                        double cellPhasePerm =
+                            unit::convert::from(minPerm, prefix::milli*unit::darcy);
+
+                        auto cellPhasePermDiag =
+                            std::vector<double>(3, cellPhasePerm);
+
+                        const auto ix = satnums[cell_idx] - 1;
+                        const auto kx = perms[0][cell_idx];
+
+                        if (satnums[cell_idx] > 0) { // handle "no rock" cells with satnum zero
+                            auto PtestvalueCell = Ptestvalue;
+                            if (!dP.empty()) {
+                                PtestvalueCell -= dP[cell_idx];
+                            }
+
+                            if (!anisotropic_input) {
+                                const auto Jvalue =
+                                    std::sqrt(kx / poros[cell_idx]) * PtestvalueCell;
+
+                                const auto WaterSaturationCell =
+                                    InvJfunctions[ix].evaluate(Jvalue);
+
+                                waterVolumeLF += WaterSaturationCell * cellPoreVolumes[cell_idx];
+
+                                // Compute cell relative permeability. We use a lower cutoff-value as we
+                                // easily divide by zero here.  When water saturation is
+                                // zero, we get 'inf', which is circumvented by the cutoff value.
+                                cellPhasePerm =
+                                    Krfunctions[0][p][ix].evaluate(WaterSaturationCell) * kx;
+                            }
+                            else {
+                                const auto WaterSaturationCell =
+                                    SwPcfunctions[ix].evaluate(PtestvalueCell);
+
+                                waterVolumeLF += WaterSaturationCell * cellPoreVolumes[cell_idx];
+
+                                cellPhasePermDiag[0] =
+                                    Krfunctions[0][p][ix].evaluate(WaterSaturationCell) * kx;
+
+                                cellPhasePermDiag[1] =
+                                    Krfunctions[1][p][ix].evaluate(WaterSaturationCell) * perms[1][cell_idx];
+
+                                cellPhasePermDiag[2] =
+                                    Krfunctions[2][p][ix].evaluate(WaterSaturationCell) * perms[2][cell_idx];
+                            }
+
+                            phasePermValues    [p][cell_idx] = cellPhasePerm;
+                            phasePermValuesDiag[p][cell_idx] = cellPhasePermDiag;
+
+                            maxPhasePerm[p] = std::max(maxPhasePerm[p], cellPhasePerm);
+                            maxPhasePerm[p] = std::max(maxPhasePerm[p],
+                                                       *std::max_element(cellPhasePermDiag.begin(),
+                                                                         cellPhasePermDiag.end()));
                         }
+                    }
 
-                        if (!anisotropic_input) {
-                            const auto Jvalue =
-                                std::sqrt(kx / poros[cell_idx]) * PtestvalueCell;
+                    // Now we can determine the smallest permitted permeability
+                    // we can calculate for We have both a fixed bottom limit,
+                    // as well as a possible higher limit determined by a
+                    // maximum allowable permeability.
+                    minPhasePerm[p] = std::max(maxPhasePerm[p] / maxPermContrast,
+                                               unit::convert::from(minPerm, prefix::milli*unit::darcy));
+
+                    // Now remodel the phase permeabilities obeying minPhasePerm
+                    SinglePhaseUpscaler::permtensor_t cellperm(3, 3, nullptr);
+                    for (decltype(ecl_idx.size())
+                             i = 0, n = ecl_idx.size(); i < n; ++i)
+                    {
+                        const auto cell_idx = ecl_idx[i];
+                        zero(cellperm);
 
-                            const auto WaterSaturationCell =
-                                InvJfunctions[ix].evaluate(Jvalue);
+                        if (!anisotropic_input) {
+                            const auto cellPhasePerm =
+                                std::max(minPhasePerm[p], phasePermValues[p][cell_idx]);
 
-                            waterVolumeLF += WaterSaturationCell * cellPoreVolumes[cell_idx];
+                            const auto kval = std::max(minPhasePerm[p], cellPhasePerm);
 
-                            // Compute cell relative permeability. We use a lower cutoff-value as we
-                            // easily divide by zero here.  When water saturation is
-                            // zero, we get 'inf', which is circumvented by the cutoff value.
-                            cellPhasePerm =
-                                Krfunctions[0][p][ix].evaluate(WaterSaturationCell) * kx;
+                            cellperm(0,0) = kval;
+                            cellperm(1,1) = kval;
+                            cellperm(2,2) = kval;
                         }
-                        else {
-                            const auto WaterSaturationCell =
-                                SwPcfunctions[ix].evaluate(PtestvalueCell);
-
-                            waterVolumeLF += WaterSaturationCell * cellPoreVolumes[cell_idx];
-
-                            cellPhasePermDiag[0] =
-                                Krfunctions[0][p][ix].evaluate(WaterSaturationCell) * kx;
+                        else { // anisotropic_input
+                            // Truncate values lower than minPhasePerm upwards.
+                            auto& k = phasePermValuesDiag[p][cell_idx];
 
-                            cellPhasePermDiag[1] =
-                                Krfunctions[1][p][ix].evaluate(WaterSaturationCell) * perms[1][cell_idx];
-
-                            cellPhasePermDiag[2] =
-                                Krfunctions[2][p][ix].evaluate(WaterSaturationCell) * perms[2][cell_idx];
+                            cellperm(0,0) = k[0] = std::max(minPhasePerm[p], k[0]);
+                            cellperm(1,1) = k[1] = std::max(minPhasePerm[p], k[1]);
+                            cellperm(2,2) = k[2] = std::max(minPhasePerm[p], k[2]);
                         }
 
-                        phasePermValues    [p][cell_idx] = cellPhasePerm;
-                        phasePermValuesDiag[p][cell_idx] = cellPhasePermDiag;
-
-                        maxPhasePerm[p] = std::max(maxPhasePerm[p], cellPhasePerm);
-                        maxPhasePerm[p] = std::max(maxPhasePerm[p],
-                                                   *std::max_element(cellPhasePermDiag.begin(),
-                                                                     cellPhasePermDiag.end()));
+                        pointUpscaler.setPermeability(i, cellperm);
                     }
-                }
 
-                // Now we can determine the smallest permitted permeability
-                // we can calculate for We have both a fixed bottom limit,
-                // as well as a possible higher limit determined by a
-                // maximum allowable permeability.
-                minPhasePerm[p] = std::max(maxPhasePerm[p] / maxPermContrast,
-                                           unit::convert::from(minPerm, prefix::milli*unit::darcy));
-
-                // Now remodel the phase permeabilities obeying minPhasePerm
-                SinglePhaseUpscaler::permtensor_t cellperm(3, 3, nullptr);
-                for (decltype(ecl_idx.size())
-                         i = 0, n = ecl_idx.size(); i < n; ++i)
-                {
-                    const auto cell_idx = ecl_idx[i];
-                    zero(cellperm);
-
-                    if (!anisotropic_input) {
-                        const auto cellPhasePerm =
-                            std::max(minPhasePerm[p], phasePermValues[p][cell_idx]);
-
-                        const auto kval = std::max(minPhasePerm[p], cellPhasePerm);
-
-                        cellperm(0,0) = kval;
-                        cellperm(1,1) = kval;
-                        cellperm(2,2) = kval;
-                    }
-                    else { // anisotropic_input
-                        // Truncate values lower than minPhasePerm upwards.
-                        auto& k = phasePermValuesDiag[p][cell_idx];
+                    //  Call single-phase upscaling code
+                    phasePermTensor[p] = pointUpscaler.upscaleSinglePhase();
+                }
 
-                        cellperm(0,0) = k[0] = std::max(minPhasePerm[p], k[0]);
-                        cellperm(1,1) = k[1] = std::max(minPhasePerm[p], k[1]);
-                        cellperm(2,2) = k[2] = std::max(minPhasePerm[p], k[2]);
+                // Here we recalculate the upscaled water saturation,
+                // although it is already known when we asked for the
+                // pressure point to compute for. Nonetheless, we
+                // recalculate here to avoid any minor roundoff-error and
+                // interpolation error (this means that the saturation
+                // points are not perfectly uniformly distributed)
+                WaterSaturation[pointidx] =  waterVolumeLF/poreVolume;
+
+                // Store and print phase-perm-result
+                for (int voigtIdx=0; voigtIdx < tensorElementCount; ++voigtIdx) {
+                    for (size_t p = 0; p < (upscaleBothPhases ? 2 : 1); ++p) {
+                        PhasePerm[p][pointidx][voigtIdx] =
+                            getVoigtValue(phasePermTensor[p], voigtIdx);
                     }
-
-                    upscaler.setPermeability(i, cellperm);
                 }
 
-                //  Call single-phase upscaling code
-                phasePermTensor[p] = upscaler.upscaleSinglePhase();
-            }
-
-            // Here we recalculate the upscaled water saturation,
-            // although it is already known when we asked for the
-            // pressure point to compute for. Nonetheless, we
-            // recalculate here to avoid any minor roundoff-error and
-            // interpolation error (this means that the saturation
-            // points are not perfectly uniformly distributed)
-            WaterSaturation[pointidx] =  waterVolumeLF/poreVolume;
-
+                std::ostringstream line;
 #if defined(HAVE_MPI) && HAVE_MPI
-            std::cout << "Rank " << mpi_rank << ": ";
+                line << "Rank " << mpi_rank << ": ";
 #endif  // HAVE_MPI
 
-            std::cout << Ptestvalue << "\t" << WaterSaturation[pointidx];
-
-            // Store and print phase-perm-result
-            for (int voigtIdx=0; voigtIdx < tensorElementCount; ++voigtIdx) {
-                for (size_t p = 0; p < (upscaleBothPhases ? 2 : 1); ++p) {
-                    PhasePerm[p][pointidx][voigtIdx] =
-                        getVoigtValue(phasePermTensor[p], voigtIdx);
-
-                    std::cout << "\t" << PhasePerm[p][pointidx][voigtIdx];
+                line << Ptestvalue << "\t" << WaterSaturation[pointidx];
+                for (int voigtIdx=0; voigtIdx < tensorElementCount; ++voigtIdx) {
+                    for (size_t p = 0; p < (upscaleBothPhases ? 2 : 1); ++p) {
+                        line << "\t" << PhasePerm[p][pointidx][voigtIdx];
+                    }
+                }
+                line << '\n';
+                std::cout << line.str();
+            }
+            catch (...) {
+#pragma omp critical (relperm_error)
+                if (!error) {
+                    error = std::current_exception();
                 }
             }
-
-            std::cout << '\n';
         }
     }
+    if (error) {
+        std::rethrow_exception(error);
+    }
 
-    clock_t finish_upscale_wallclock = clock();
     double timeused_upscale_wallclock =
-        (double(finish_upscale_wallclock) -
-         double(start_upscale_wallclock)) / CLOCKS_PER_SEC;
+        wallClockTime() - start_upscale_wallclock;
+    PerformanceLog::global().addTime("relperm/upscaling", timeused_upscale_wallclock);
 
     collectResults();
 
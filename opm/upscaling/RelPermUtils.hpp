@@ -128,8 +128,9 @@ namespace Opm {
       //! \param[in] options Option structure.
       //! \details Uses the following options: linsolver_tolerance,
       //!          linsolver_verbosity, linsolver_type, linsolver_max_iterations,
-      //!          linsolver_smooth_steps, linsolver_prolongate_factor, minPerm
-      //! \return Time used for tesselation.
+      //!          linsolver_smooth_steps, linsolver_prolongate_factor,
+      //!          linsolver_single_precision, minPerm
+      //! \return Wall-clock time used for tesselation.
       double tesselateGrid(const Opm::Deck& deck);
 
       //! \brief Find cell center pressure gradient for every cell.
@@ -147,8 +148,10 @@ namespace Opm {
 
       //! \brief Upscale permeabilities.
       //! \param[in] mpi_rank MPI rank of this process.
-      //! \details Uses the following options:  minPerm, maxPermContrast
-      //! \return Tuple with (total time, time per point).
+      //! \details Uses the following options:  minPerm, maxPermContrast, threads.
+      //!          The pressure points of this process are computed by
+      //!          'threads' OpenMP threads, which share the grid of upscaler.
+      //! \return Tuple with (total wall-clock time, time per point).
       std::tuple<double,double> upscalePermeability(int mpi_rank);
 
     private:
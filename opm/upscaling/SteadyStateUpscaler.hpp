@@ -102,6 +102,12 @@ namespace Opm
                                const std::vector<double>& saturations) const;
 	/// Override from superclass.
 	virtual void initImpl(const Opm::parameter::ParameterGroup& param);
+	/// Runs the pressure solver, reusing the previous preconditioner if
+	/// reuse_preconditioner is true. If the reused preconditioner fails to
+	/// converge, a fresh one is built. Returns true if it was rebuilt.
+	bool solvePressure(const std::vector<double>& saturation,
+			   const std::vector<double>& src,
+			   const bool reuse_preconditioner);
 
 
 	// ------- Data members -------
@@ -114,6 +120,11 @@ namespace Opm
         double relperm_threshold_;
         double maximum_mobility_contrast_;
         double sat_change_threshold_;
+        double sat_change_year_;
+        bool adaptive_stepsize_;
+        double max_stepsize_;
+        double dt_sat_tol_;
+        double amg_reuse_sat_tol_;
 	TransportSolver transport_solver_;
     };
 
@@ -95,6 +95,9 @@ namespace Opm
         /// Ensure saturations are not outside table
         void initSatLimits(std::vector<double>& s) const;
 
+        /// Set s to the capillary limit saturation with given average.
+        /// The pressure shift found is used as starting point for the next
+        /// call, since the upscaler visits neighbouring saturations in turn.
         void setToCapillaryLimit(double average_s, std::vector<double>& s) const;
 
 
@@ -127,6 +130,10 @@ namespace Opm
         double  max_stepsize_;
         double dt_sat_tol_;
         bool use_maxdiff_;
+        // Anderson acceleration of the outer (pseudo-time) iteration, 0 means off.
+        int anderson_depth_;
+        // Capillary pressure shift found by the last setToCapillaryLimit() call.
+        mutable double last_cap_limit_shift_;
         TransportSolver transport_solver_;
         GridAdapter grid_adapter_;
     };
@@ -38,6 +38,8 @@
 
 
 #include <boost/lexical_cast.hpp>
+#include <opm/porsol/common/AndersonAcceleration.hpp>
+#include <opm/porsol/common/BrentRootFinder.hpp>
 #include <opm/porsol/common/MatrixInverse.hpp>
 #include <opm/porsol/common/SimulatorUtilities.hpp>
 #include <opm/porsol/common/ReservoirPropertyFixedMobility.hpp>
@@ -46,6 +48,7 @@
 
 #include <opm/upscaling/writeECLData.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/RootFinders.hpp>
 #include <algorithm>
 #include <iostream>
 
@@ -69,7 +72,9 @@ namespace Opm
           max_it_(100),
           max_stepsize_(1e4),
           dt_sat_tol_(1e-2),
-          use_maxdiff_(true)
+          use_maxdiff_(true),
+          anderson_depth_(0),
+          last_cap_limit_shift_(0.0)
     {
     }
 
@@ -79,6 +84,13 @@ namespace Opm
     template <class Traits>
     inline void SteadyStateUpscalerImplicit<Traits>::initImpl(const Opm::parameter::ParameterGroup& param)
     {
+        // The transport solvers need the fluxes of all cells, which
+        // distributed solves only compute in the interior cells of
+        // each process.
+        if (param.getDefault("distributed_solve", false)) {
+            OPM_THROW(std::runtime_error, "Distributed solves are not supported "
+                      "by the steady-state upscalers.");
+        }
         Super::initImpl(param);
         use_gravity_ = param.getDefault("use_gravity", use_gravity_);
         output_vtk_ = param.getDefault("output_vtk", output_vtk_);
@@ -97,6 +109,7 @@ namespace Opm
         max_it_               = param.getDefault("max_it", max_it_);
         max_stepsize_        = Opm::unit::convert::from(param.getDefault("max_stepsize", max_stepsize_),Opm::unit::year);
         use_maxdiff_ = param.getDefault("use_maxdiff", use_maxdiff_);
+        anderson_depth_ = param.getDefault("anderson_depth", anderson_depth_);
         transport_solver_.init(param);
         // Set viscosities and densities if given.
         double v1_default = this->res_prop_.viscosityFirstPhase();
@@ -222,6 +235,12 @@ namespace Opm
         std::vector<double> ecl_sat;
         std::vector<double> ecl_press;
         std::vector<double> init_saturation(saturation);
+        // Each converged transport step of length stepsize is a fixed-point
+        // map s -> G(s) whose fixed point is the steady state. Anderson
+        // acceleration of this map converges much faster than plain pseudo-time
+        // marching when the stepsize is limited by transport convergence.
+        // The history is reset whenever the map changes (new stepsize).
+        AndersonAcceleration anderson(std::max(anderson_depth_, 1));
         while ((!stationary) && (it_count < max_it_)) { // && transport_cost < max_transport_cost_)
             // Run transport solver.
             std::cout << "Running transport step " << it_count << " with stepsize "
@@ -293,6 +312,7 @@ namespace Opm
                 }
                 euclidean_diff = std::sqrt(euclidean_diff / tot_pore_vol);
                 double ds_year;
+                const double old_stepsize = stepsize;
                 if (use_maxdiff_) {
                     ds_year = maxdiff*Opm::unit::year/stepsize;
                     std::cout << "Maximum saturation change/year: " << ds_year << std::endl;
@@ -310,10 +330,24 @@ namespace Opm
                 if (ds_year < sat_change_year_) {
                     stationary = true;
                 }
+                if (anderson_depth_ > 0 && !stationary) {
+                    if (stepsize != old_stepsize) {
+                        anderson.reset();
+                    } else {
+                        anderson.accelerate(saturation_old, saturation);
+                        // Keep the accelerated iterate inside the saturation tables.
+                        for (int c = 0; c < num_cells; ++c) {
+                            saturation[c] = std::max(saturation[c], this->res_prop_.s_min(c));
+                            saturation[c] = std::min(saturation[c], this->res_prop_.s_max(c));
+                        }
+                        init_saturation = saturation;
+                    }
+                }
             } else {
                 std::cerr << "Cutting time step\n";
                 init_saturation = saturation_old;
                 stepsize=stepsize/2.0;
+                anderson.reset();
             }
             ++it_count;
             // Copy to old.
@@ -324,14 +358,17 @@ namespace Opm
         // Compute phase mobilities.
         // First: compute maximal mobilities.
         typedef typename Super::ResProp::Mobility Mob;
-        Mob m;
+        std::vector<Mob> mob1(num_cells);
+        std::vector<Mob> mob2(num_cells);
+        if (num_cells > 0) {
+            this->res_prop_.saturationFunctions(0, num_cells, &saturation[0],
+                                                &mob1[0], &mob2[0], 0, 0);
+        }
         double m1max = 0;
         double m2max = 0;
         for (int c = 0; c < num_cells; ++c) {
-            this->res_prop_.phaseMobility(0, c, saturation[c], m.mob);
-            m1max = maxMobility(m1max, m.mob);
-            this->res_prop_.phaseMobility(1, c, saturation[c], m.mob);
-            m2max = maxMobility(m2max, m.mob);
+            m1max = maxMobility(m1max, mob1[c].mob);
+            m2max = maxMobility(m2max, mob2[c].mob);
         }
         // Second: set thresholds.
         const double mob1_abs_thres = relperm_threshold_ / this->res_prop_.viscosityFirstPhase();
@@ -340,13 +377,9 @@ namespace Opm
         const double mob2_abs_thres = relperm_threshold_ / this->res_prop_.viscositySecondPhase();
         const double mob2_rel_thres = m2max / maximum_mobility_contrast_;
         const double mob2_threshold = std::max(mob2_abs_thres, mob2_rel_thres);
-        // Third: extract and threshold.
-        std::vector<Mob> mob1(num_cells);
-        std::vector<Mob> mob2(num_cells);
+        // Third: threshold.
         for (int c = 0; c < num_cells; ++c) {
-            this->res_prop_.phaseMobility(0, c, saturation[c], mob1[c].mob);
             thresholdMobility(mob1[c].mob, mob1_threshold);
-            this->res_prop_.phaseMobility(1, c, saturation[c], mob2[c].mob);
             thresholdMobility(mob2[c].mob, mob2_threshold);
         }
 
@@ -427,14 +460,17 @@ namespace Opm
         double cap_press_range = 1e2;
         double mod_low = 1e100;
         double mod_high = -1e100;
-	Opm::bracketZero(func, 0.0, cap_press_range, mod_low, mod_high);
+        // Warm start from the previous shift, the bracket is then usually
+        // found in the first expansion step.
+	Opm::bracketZero(func, last_cap_limit_shift_, cap_press_range, mod_low, mod_high);
         const int max_iter = 40;
         const double nonlinear_tolerance = 1e-12;
         int iterations_used = -1;
-        typedef Opm::RegulaFalsi<Opm::ThrowOnError> RootFinder;
-        double mod_correct = RootFinder::solve(func, mod_low, mod_high, max_iter, nonlinear_tolerance, iterations_used);
+        double mod_correct = BrentRootFinder::solve(func, mod_low, mod_high, max_iter, nonlinear_tolerance, iterations_used);
         std::cout << "Moved capillary pressure solution by " << mod_correct << " after "
-                  << iterations_used << " iterations." << std::endl;
+                  << iterations_used << " iterations (" << func.numEvaluations()
+                  << " function evaluations)." << std::endl;
+        last_cap_limit_shift_ = mod_correct;
         s = func.lastSaturations();
     }
 
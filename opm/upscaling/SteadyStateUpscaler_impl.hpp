@@ -60,7 +60,12 @@ namespace Opm
 	  stepsize_(0.1),
 	  relperm_threshold_(1.0e-8),
           maximum_mobility_contrast_(1.0e9),
-          sat_change_threshold_(0.0)
+          sat_change_threshold_(0.0),
+          sat_change_year_(0.0),
+          adaptive_stepsize_(false),
+          max_stepsize_(1e4),
+          dt_sat_tol_(1e-2),
+          amg_reuse_sat_tol_(0.0)
     {
     }
 
@@ -70,6 +75,13 @@ namespace Opm
     template <class Traits>
     inline void SteadyStateUpscaler<Traits>::initImpl(const Opm::parameter::ParameterGroup& param)
     {
+        // The transport solvers need the fluxes of all cells, which
+        // distributed solves only compute in the interior cells of
+        // each process.
+        if (param.getDefault("distributed_solve", false)) {
+            OPM_THROW(std::runtime_error, "Distributed solves are not supported "
+                      "by the steady-state upscalers.");
+        }
 	Super::initImpl(param);
         use_gravity_ =  param.getDefault("use_gravity", use_gravity_);        
 	output_vtk_ = param.getDefault("output_vtk", output_vtk_);
@@ -80,6 +92,12 @@ namespace Opm
 	relperm_threshold_ = param.getDefault("relperm_threshold", relperm_threshold_);
         maximum_mobility_contrast_ = param.getDefault("maximum_mobility_contrast", maximum_mobility_contrast_);
         sat_change_threshold_ = param.getDefault("sat_change_threshold", sat_change_threshold_);
+        sat_change_year_ = param.getDefault("sat_change_year", sat_change_year_);
+        adaptive_stepsize_ = param.getDefault("adaptive_stepsize", adaptive_stepsize_);
+        max_stepsize_ = Opm::unit::convert::from(param.getDefault("max_stepsize", max_stepsize_),
+                                                 Opm::unit::year);
+        dt_sat_tol_ = param.getDefault("dt_sat_tol", dt_sat_tol_);
+        amg_reuse_sat_tol_ = param.getDefault("amg_reuse_sat_tol", amg_reuse_sat_tol_);
 
 	transport_solver_.init(param);
         // Set viscosities and densities if given.
@@ -165,26 +183,36 @@ namespace Opm
         transport_solver_.initObj(this->ginterf_, this->res_prop_, this->bcond_);
 
         // Run pressure solver.
-        this->flow_solver_.solve(this->res_prop_, saturation, this->bcond_, src,
-                                 this->residual_tolerance_, this->linsolver_verbosity_, 
-                                 this->linsolver_type_, false,
-                                 this->linsolver_maxit_, this->linsolver_prolongate_factor_,
-                                 this->linsolver_smooth_steps_);
+        solvePressure(saturation, src, false);
         double max_mod = this->flow_solver_.postProcessFluxes();
         std::cout << "Max mod = " << max_mod << std::endl;
 
-        // Do a run till steady state. For now, we just do some pressure and transport steps...
+        // Do a run till steady state, or at most simulation_steps_ steps.
+        // The saturation for which the pressure preconditioner was built
+        // is kept in saturation_precond, so that it may be reused while
+        // the mobilities change little.
         std::vector<double> saturation_old = saturation;
-        for (int iter = 0; iter < simulation_steps_; ++iter) {
+        std::vector<double> saturation_precond = saturation;
+        double stepsize = stepsize_;
+        int num_precond_setups = 1;
+        int iter = 0;
+        for (; iter < simulation_steps_; ++iter) {
             // Run transport solver.
-            transport_solver_.transportSolve(saturation, stepsize_, gravity, this->flow_solver_.getSolution(), injection);
+            transport_solver_.transportSolve(saturation, stepsize, gravity, this->flow_solver_.getSolution(), injection);
 
             // Run pressure solver.
-            this->flow_solver_.solve(this->res_prop_, saturation, this->bcond_, src,
-                                     this->residual_tolerance_, this->linsolver_verbosity_,
-                                     this->linsolver_type_, false,
-                                     this->linsolver_maxit_, this->linsolver_prolongate_factor_,
-                                     this->linsolver_smooth_steps_);
+            bool reuse_precond = false;
+            if (amg_reuse_sat_tol_ > 0.0) {
+                double precond_diff = 0.0;
+                for (int i = 0; i < num_cells; ++i) {
+                    precond_diff = std::max(precond_diff, std::fabs(saturation[i] - saturation_precond[i]));
+                }
+                reuse_precond = precond_diff < amg_reuse_sat_tol_;
+            }
+            if (solvePressure(saturation, src, reuse_precond)) {
+                saturation_precond = saturation;
+                ++num_precond_setups;
+            }
             max_mod = this->flow_solver_.postProcessFluxes();
             std::cout << "Max mod = " << max_mod << std::endl;
 
@@ -213,36 +241,48 @@ namespace Opm
             }
 
             // Comparing old to new.
-            int num_cells = saturation.size();
             double maxdiff = 0.0;
             for (int i = 0; i < num_cells; ++i) {
                 maxdiff = std::max(maxdiff, std::fabs(saturation[i] - saturation_old[i]));
             }
+            const double ds_year = maxdiff*Opm::unit::year/stepsize;
 #ifdef VERBOSE
-            std::cout << "Maximum saturation change: " << maxdiff << std::endl;
+            std::cout << "Maximum saturation change: " << maxdiff
+                      << "  (per year: " << ds_year << ")" << std::endl;
 #endif
-            if (maxdiff < sat_change_threshold_) {
+            if (maxdiff < sat_change_threshold_ || ds_year < sat_change_year_) {
 #ifdef VERBOSE
                 std::cout << "Maximum saturation change is under steady state threshold." << std::endl;
 #endif
+                ++iter;
                 break;
             }
 
+            // Grow the step as the saturation field settles.
+            if (adaptive_stepsize_ && maxdiff < dt_sat_tol_) {
+                stepsize = std::min(max_stepsize_, 2.0*stepsize);
+            }
+
             // Copy to old.
             saturation_old = saturation;
         }
+        std::cout << "Steady state iterations: " << iter
+                  << "   Preconditioner setups: " << num_precond_setups << std::endl;
 
         // Compute phase mobilities.
         // First: compute maximal mobilities.
         typedef typename Super::ResProp::Mobility Mob;
-        Mob m;
+        std::vector<Mob> mob1(num_cells);
+        std::vector<Mob> mob2(num_cells);
+        if (num_cells > 0) {
+            this->res_prop_.saturationFunctions(0, num_cells, &saturation[0],
+                                                &mob1[0], &mob2[0], 0, 0);
+        }
         double m1max = 0;
         double m2max = 0;
         for (int c = 0; c < num_cells; ++c) {
-            this->res_prop_.phaseMobility(0, c, saturation[c], m.mob);
-            m1max = maxMobility(m1max, m.mob);
-            this->res_prop_.phaseMobility(1, c, saturation[c], m.mob);
-            m2max = maxMobility(m2max, m.mob);
+            m1max = maxMobility(m1max, mob1[c].mob);
+            m2max = maxMobility(m2max, mob2[c].mob);
         }
         // Second: set thresholds.
         const double mob1_abs_thres = relperm_threshold_ / this->res_prop_.viscosityFirstPhase();
@@ -251,13 +291,9 @@ namespace Opm
         const double mob2_abs_thres = relperm_threshold_ / this->res_prop_.viscositySecondPhase();
         const double mob2_rel_thres = m2max / maximum_mobility_contrast_;
         const double mob2_threshold = std::max(mob2_abs_thres, mob2_rel_thres);
-        // Third: extract and threshold.
-        std::vector<Mob> mob1(num_cells);
-        std::vector<Mob> mob2(num_cells);
+        // Third: threshold.
         for (int c = 0; c < num_cells; ++c) {
-            this->res_prop_.phaseMobility(0, c, saturation[c], mob1[c].mob);
             thresholdMobility(mob1[c].mob, mob1_threshold);
-            this->res_prop_.phaseMobility(1, c, saturation[c], mob2[c].mob);
             thresholdMobility(mob2[c].mob, mob2_threshold);
         }
 
@@ -288,6 +324,35 @@ namespace Opm
 
 
 
+    template <class Traits>
+    inline bool SteadyStateUpscaler<Traits>::solvePressure(const std::vector<double>& saturation,
+                                                           const std::vector<double>& src,
+                                                           const bool reuse_preconditioner)
+    {
+        if (reuse_preconditioner) {
+            try {
+                this->flow_solver_.solve(this->res_prop_, saturation, this->bcond_, src,
+                                         this->residual_tolerance_, this->linsolver_verbosity_,
+                                         this->linsolver_type_, true,
+                                         this->linsolver_maxit_, this->linsolver_prolongate_factor_,
+                                         this->linsolver_smooth_steps_);
+                return false;
+            }
+            catch (const std::runtime_error&) {
+                OPM_MESSAGE("Warning: Reused preconditioner failed, rebuilding it.");
+            }
+        }
+        this->flow_solver_.solve(this->res_prop_, saturation, this->bcond_, src,
+                                 this->residual_tolerance_, this->linsolver_verbosity_,
+                                 this->linsolver_type_, false,
+                                 this->linsolver_maxit_, this->linsolver_prolongate_factor_,
+                                 this->linsolver_smooth_steps_);
+        return true;
+    }
+
+
+
+
     template <class Traits>
     inline const std::vector<double>&
     SteadyStateUpscaler<Traits>::lastSaturationState() const
@@ -74,7 +74,13 @@ namespace Opm
 
         virtual ~UpscalerBase() {;} ;
 
-	/// Initializes the upscaler from parameters.
+	/// Initializes the upscaler from parameters. If the parameter
+	/// "distributed_solve" is true, the grid is partitioned over the
+	/// MPI processes, so that each holds only its own cells and an
+	/// overlap layer. The processes must then call
+	/// upscaleSinglePhase() and the other upscale functions together.
+	/// Distributed solves require fixed boundary conditions, and are
+	/// not supported by the steady-state upscalers.
 	void init(const Opm::parameter::ParameterGroup& param);
 
 	/// Initializes the upscaler from given arguments.
@@ -90,14 +96,31 @@ namespace Opm
                   int linsolver_smooth_steps = 1,
                   const double gravity = 0.0);
 
+        /// Initializes the upscaler as a worker of another, initialized
+        /// upscaler. The worker uses the grid of the master instead of
+        /// building its own, and has its own copy of the settings, the
+        /// permeability field and the pressure solver. The rock tables
+        /// and other static rock properties are shared. Several workers can
+        /// then upscale in parallel threads, with different
+        /// permeabilities (setPermeability()), while holding a single
+        /// grid. The master must outlive its workers, and its grid must
+        /// not be changed while they are in use.
+        void initWorker(const UpscalerBase& master);
+
 	/// Access the grid.
 	const GridType& grid() const;
 
         /// Set boundary condition type. This may not be used to swicth
         /// between Periodic and the other types, since the grid is
-        /// modified for Periodic conditions.
+        /// modified for Periodic conditions. Workers (see initWorker())
+        /// use the boundary condition type of their master.
         void setBoundaryConditionType(BoundaryConditionType type);
 
+        /// Build the AMG preconditioner of the pressure solver in single
+        /// precision, falling back to double precision if CG fails to
+        /// converge with it. See IncompFlowSolverHybrid.
+        void setLinsolverSinglePrecision(bool on);
+
         /// Set the permeability of a cell directly. This will override
         /// the permeability that was read from the eclipse file.
         void setPermeability(const int cell_index, const permtensor_t& k);
@@ -141,6 +164,13 @@ namespace Opm
 
 	double computeDelta(const int flow_dir) const;
 
+        /// True unless the cell is an overlap copy of a cell owned
+        /// by another process.
+        bool isOwnedCell(const CellIter& c) const;
+
+        /// Sum the values over the processes of a distributed solve.
+        void sumOverProcesses(double* values, int num) const;
+
         template <class FluidInterface>
         permtensor_t upscaleEffectivePerm(const FluidInterface& fluid);
 
@@ -157,6 +187,8 @@ namespace Opm
 	int linsolver_verbosity_;
         int linsolver_type_;
         int linsolver_smooth_steps_;
+        bool linsolver_single_precision_;
+        bool distributed_solve_;
         double gravity_;
 
 	GridType grid_;
@@ -39,7 +39,12 @@
 #include <opm/porsol/common/setupBoundaryConditions.hpp>
 #include <opm/porsol/common/ReservoirPropertyTracerFluid.hpp>
 
+#if defined(HAVE_MPI) && HAVE_MPI
+#include <mpi.h>
+#endif
+
 #include <iostream>
+#include <sstream>
 
 namespace Opm
 {
@@ -53,7 +58,9 @@ namespace Opm
 	  linsolver_prolongate_factor_(1.0),
 	  linsolver_verbosity_(0),
           linsolver_type_(3),
-          linsolver_smooth_steps_(1)
+          linsolver_smooth_steps_(1),
+          linsolver_single_precision_(false),
+          distributed_solve_(false)
     {
     }
 
@@ -92,6 +99,8 @@ namespace Opm
         linsolver_maxit_ = param.getDefault("linsolver_max_iterations", linsolver_maxit_);
         linsolver_prolongate_factor_ = param.getDefault("linsolver_prolongate_factor", linsolver_prolongate_factor_);
         linsolver_smooth_steps_ = param.getDefault("linsolver_smooth_steps", linsolver_smooth_steps_);
+        linsolver_single_precision_ = param.getDefault("linsolver_single_precision", linsolver_single_precision_);
+        distributed_solve_ = param.getDefault("distributed_solve", distributed_solve_);
 
         // Ensure sufficient grid support for requested boundary
         // condition type.
@@ -110,6 +119,15 @@ namespace Opm
                 temp_param.insertParameter("periodic_extension", "true");
             }
         }
+        // Distributed solves partition the grid over the processes
+        // as soon as it is read.
+        if (distributed_solve_) {
+            if (bctype_ != Fixed) {
+                OPM_THROW(std::runtime_error, "Distributed solves are only supported "
+                          "with fixed boundary conditions.");
+            }
+            temp_param.insertParameter("load_balance", "true");
+        }
 
 	setupGridAndProps(temp_param, grid_, res_prop_);
 	ginterf_.init(grid_);
@@ -171,11 +189,40 @@ namespace Opm
 
 
 
+    template <class Traits>
+    inline void UpscalerBase<Traits>::initWorker(const UpscalerBase& master)
+    {
+        bctype_ = master.bctype_;
+        twodim_hack_ = master.twodim_hack_;
+        residual_tolerance_ = master.residual_tolerance_;
+        linsolver_maxit_ = master.linsolver_maxit_;
+        linsolver_prolongate_factor_ = master.linsolver_prolongate_factor_;
+        linsolver_verbosity_ = master.linsolver_verbosity_;
+        linsolver_type_ = master.linsolver_type_;
+        linsolver_smooth_steps_ = master.linsolver_smooth_steps_;
+        linsolver_single_precision_ = master.linsolver_single_precision_;
+        gravity_ = master.gravity_;
+        if (master.distributed_solve_) {
+            OPM_THROW(std::runtime_error, "Workers cannot share the grid of an upscaler "
+                  "with distributed solves.");
+        }
+
+        // grid_ stays empty, all grid access goes through ginterf_.
+        // The copy shares the rock tables and per-cell data of the
+        // master, only the permeability field (which the worker
+        // overwrites) is copied.
+        res_prop_ = master.res_prop_;
+        ginterf_.init(master.grid());
+    }
+
+
+
+
     template <class Traits>
     inline const typename UpscalerBase<Traits>::GridType&
     UpscalerBase<Traits>::grid() const
     {
-	return grid_;
+	return ginterf_.grid();
     }
 
 
@@ -189,6 +236,12 @@ namespace Opm
             || (type != Periodic && bctype_ == Periodic)) {
             OPM_THROW(std::runtime_error, "Cannot switch to or from Periodic boundary condition, "
                   "periodic must be set in init() params.");
+        } else if (&ginterf_.grid() != &grid_) {
+            OPM_THROW(std::runtime_error, "Cannot set the boundary condition type of a worker, "
+                  "since the grid belongs to its master.");
+        } else if (distributed_solve_ && type != Fixed) {
+            OPM_THROW(std::runtime_error, "Distributed solves are only supported "
+                  "with fixed boundary conditions.");
         } else {
             bctype_ = type;
             if (type == Periodic || type == Linear) {
@@ -202,11 +255,21 @@ namespace Opm
 
 
 
+    template <class Traits>
+    inline void
+    UpscalerBase<Traits>::setLinsolverSinglePrecision(bool on)
+    {
+        linsolver_single_precision_ = on;
+    }
+
+
+
+
     template <class Traits>
     inline void
     UpscalerBase<Traits>::setPermeability(const int cell_index, const permtensor_t& k)
     {
-        res_prop_.permeabilityModifiable(cell_index) = k;
+        res_prop_.setPermeability(cell_index, k);
     }
 
 
@@ -248,6 +311,8 @@ namespace Opm
 	    }
 
 	    // Run pressure solver.
+            flow_solver_.setSinglePrecisionPreconditioner(linsolver_single_precision_);
+            flow_solver_.setDistributed(distributed_solve_);
             bool same_matrix = (bctype_ != Fixed) && (pdd != 0);
 	    flow_solver_.solve(fluid, sat, bcond_, src, residual_tolerance_,
                                linsolver_verbosity_, 
@@ -255,7 +320,19 @@ namespace Opm
                                linsolver_maxit_, linsolver_prolongate_factor_,
                                linsolver_smooth_steps_);
             double max_mod = flow_solver_.postProcessFluxes();
-            std::cout << "Max mod = " << max_mod << std::endl;
+            int rank = 0;
+#if defined(HAVE_MPI) && HAVE_MPI
+            if (distributed_solve_) {
+                MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            }
+#endif
+            if (rank == 0) {
+                // One write, so that the lines of upscalers running on
+                // several threads do not interleave.
+                std::ostringstream line;
+                line << "Max mod = " << max_mod << '\n';
+                std::cout << line.str() << std::flush;
+            }
 
 	    // Compute upscaled K.
 	    double Q[Dimension] =  { 0 };
@@ -300,6 +377,12 @@ namespace Opm
 	int num_side2 = 0;
 
 	for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
+            // With distributed solves, the fluxes are only known in
+            // the interior cells of this process, and the boundary
+            // faces of the overlap cells include cut faces.
+            if (!isOwnedCell(c)) {
+                continue;
+            }
 	    for (FaceIter f = c->facebegin(); f != c->faceend(); ++f) {
 		++num_faces;
 		if (f->boundary()) {
@@ -338,6 +421,12 @@ namespace Opm
 		}
 	    }
 	}
+        double sums[4] = { side1_flux, side2_flux, side1_area, side2_area };
+        sumOverProcesses(sums, 4);
+        side1_flux = sums[0];
+        side2_flux = sums[1];
+        side1_area = sums[2];
+        side2_area = sums[3];
 // 	std::cout << "Faces: " << num_faces << "   Boundary faces: " << num_bdyfaces
 // 		  << "   Side 1 faces: " << num_side1 << "   Side 2 faces: " << num_side2 << std::endl;
 	// q is the average velocity.
@@ -355,6 +444,9 @@ namespace Opm
 	double side1_area = 0.0;
 	double side2_area = 0.0;
 	for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
+            if (!isOwnedCell(c)) {
+                continue;
+            }
 	    for (FaceIter f = c->facebegin(); f != c->faceend(); ++f) {
 		if (f->boundary()) {
 		    int canon_bid = bcond_.getCanonicalBoundaryId(f->boundaryId());
@@ -372,6 +464,12 @@ namespace Opm
 		}
 	    }
 	}
+        double sums[4] = { side1_pos, side2_pos, side1_area, side2_area };
+        sumOverProcesses(sums, 4);
+        side1_pos = sums[0];
+        side2_pos = sums[1];
+        side1_area = sums[2];
+        side2_area = sums[3];
 	// delta is the average length.
 	return  side2_pos/side2_area - side1_pos/side1_area;
     }
@@ -379,82 +477,114 @@ namespace Opm
 
 
 
+    template <class Traits>
+    inline bool UpscalerBase<Traits>::isOwnedCell(const CellIter& c) const
+    {
+        return !distributed_solve_ || c->partitionType() == Dune::InteriorEntity;
+    }
+
+
+
+
+    template <class Traits>
+    inline void UpscalerBase<Traits>::sumOverProcesses(double* values, int num) const
+    {
+#if defined(HAVE_MPI) && HAVE_MPI
+        if (distributed_solve_) {
+            MPI_Allreduce(MPI_IN_PLACE, values, num, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        }
+#else
+        static_cast<void>(values);
+        static_cast<void>(num);
+#endif
+    }
+
+
+
+
     template <class Traits>
     double UpscalerBase<Traits>::upscalePorosity() const
     {
-        double total_vol = 0.0;
-        double total_pore_vol = 0.0;
+        double total[2] = { 0.0, 0.0 }; // Volume, pore volume.
 	for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-            total_vol += c->volume();
-            total_pore_vol += c->volume()*res_prop_.porosity(c->index());
+            if (!isOwnedCell(c)) {
+                continue;
+            }
+            total[0] += c->volume();
+            total[1] += c->volume()*res_prop_.porosity(c->index());
         }
-        return total_pore_vol/total_vol;
+        sumOverProcesses(total, 2);
+        return total[1]/total[0];
     }
 
 
     template <class Traits>
     double UpscalerBase<Traits>::upscaleNetPorosity() const
     {
-        double total_net_vol = 0.0;
-        double total_pore_vol = 0.0;
+        double total[2] = { 0.0, 0.0 }; // Net volume, pore volume.
 	for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-            total_net_vol += c->volume()*res_prop_.ntg(c->index());
-            total_pore_vol += c->volume()*res_prop_.porosity(c->index())*res_prop_.ntg(c->index());
+            if (!isOwnedCell(c)) {
+                continue;
+            }
+            total[0] += c->volume()*res_prop_.ntg(c->index());
+            total[1] += c->volume()*res_prop_.porosity(c->index())*res_prop_.ntg(c->index());
         }
-        if (total_net_vol>0.0) return total_pore_vol/total_net_vol;
+        sumOverProcesses(total, 2);
+        if (total[0]>0.0) return total[1]/total[0];
         else return 0.0;
     }
 
     template <class Traits>
     double UpscalerBase<Traits>::upscaleNTG() const
     {
-        double total_vol = 0.0;
-        double total_net_vol = 0.0;
+        double total[2] = { 0.0, 0.0 }; // Volume, net volume.
 	for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-            total_vol += c->volume();
-            total_net_vol += c->volume()*res_prop_.ntg(c->index());
+            if (!isOwnedCell(c)) {
+                continue;
+            }
+            total[0] += c->volume();
+            total[1] += c->volume()*res_prop_.ntg(c->index());
         }
-        return total_net_vol/total_vol;
+        sumOverProcesses(total, 2);
+        return total[1]/total[0];
     }
 
     template <class Traits>
     double UpscalerBase<Traits>::upscaleSWCR(const bool NTG) const
     {
-        double total_swcr = 0.0;
-        double total_pore_vol = 0.0;
-        if (NTG) {
-            for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-                total_swcr += c->volume()*res_prop_.porosity(c->index())*res_prop_.ntg(c->index())*res_prop_.swcr(c->index());
-                total_pore_vol += c->volume()*res_prop_.porosity(c->index())*res_prop_.ntg(c->index());
+        double total[2] = { 0.0, 0.0 }; // Irreducible water volume, pore volume.
+        for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
+            if (!isOwnedCell(c)) {
+                continue;
             }
-        }
-        else {
-            for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-                total_swcr += c->volume()*res_prop_.porosity(c->index())*res_prop_.swcr(c->index());
-                total_pore_vol += c->volume()*res_prop_.porosity(c->index());
+            double pore_vol = c->volume()*res_prop_.porosity(c->index());
+            if (NTG) {
+                pore_vol *= res_prop_.ntg(c->index());
             }
+            total[0] += pore_vol*res_prop_.swcr(c->index());
+            total[1] += pore_vol;
         }
-        return total_swcr/total_pore_vol;
+        sumOverProcesses(total, 2);
+        return total[0]/total[1];
     }
 
     template <class Traits>
     double UpscalerBase<Traits>::upscaleSOWCR(const bool NTG) const
     {
-        double total_sowcr = 0.0;
-        double total_pore_vol = 0.0;
-        if (NTG) {
-            for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-                total_sowcr += c->volume()*res_prop_.porosity(c->index())*res_prop_.ntg(c->index())*res_prop_.sowcr(c->index());
-                total_pore_vol += c->volume()*res_prop_.porosity(c->index())*res_prop_.ntg(c->index());
+        double total[2] = { 0.0, 0.0 }; // Irreducible oil volume, pore volume.
+        for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
+            if (!isOwnedCell(c)) {
+                continue;
             }
-        }
-        else {
-            for (CellIter c = ginterf_.cellbegin(); c != ginterf_.cellend(); ++c) {
-                total_sowcr += c->volume()*res_prop_.porosity(c->index())*res_prop_.sowcr(c->index());
-                total_pore_vol += c->volume()*res_prop_.porosity(c->index());
+            double pore_vol = c->volume()*res_prop_.porosity(c->index());
+            if (NTG) {
+                pore_vol *= res_prop_.ntg(c->index());
             }
+            total[0] += pore_vol*res_prop_.sowcr(c->index());
+            total[1] += pore_vol;
         }
-        return total_sowcr/total_pore_vol;
+        sumOverProcesses(total, 2);
+        return total[0]/total[1];
     }
 
 } // namespace Opm
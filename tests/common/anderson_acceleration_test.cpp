@@ -0,0 +1,98 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#if defined(HAVE_DYNAMIC_BOOST_TEST)
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+
+#define BOOST_TEST_MODULE AndersonAccelerationTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/porsol/common/AndersonAcceleration.hpp>
+
+#include <cmath>
+#include <vector>
+
+
+namespace {
+    // Slowly converging linear contraction x -> A x + b, with the fixed point x = 1.
+    void contraction(const std::vector<double>& x, std::vector<double>& g)
+    {
+        const double a[3] = { 0.99, 0.95, 0.9 };
+        g.resize(x.size());
+        for (int i = 0; i < int(x.size()); ++i) {
+            const int j = (i + 1) % x.size();
+            g[i] = a[i]*x[i] + 0.005*(x[j] - 1.0) + (1.0 - a[i]);
+        }
+    }
+
+    double maxError(const std::vector<double>& x)
+    {
+        double err = 0.0;
+        for (int i = 0; i < int(x.size()); ++i) {
+            err = std::max(err, std::fabs(x[i] - 1.0));
+        }
+        return err;
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(linear_fixed_point)
+{
+    Opm::AndersonAcceleration aa(3);
+    std::vector<double> x(3, 0.0);
+    std::vector<double> g;
+    for (int it = 0; it < 10; ++it) {
+        contraction(x, g);
+        aa.accelerate(x, g);
+        x = g;
+    }
+    // Plain iteration would still have an error of about 0.9.
+    BOOST_CHECK_LT(maxError(x), 1e-6);
+    BOOST_CHECK_EQUAL(aa.historySize(), 3);
+}
+
+
+BOOST_AUTO_TEST_CASE(reset_gives_plain_step)
+{
+    Opm::AndersonAcceleration aa(2);
+    std::vector<double> x(3, 0.0);
+    std::vector<double> g;
+    contraction(x, g);
+    aa.accelerate(x, g);
+    x = g;
+    aa.reset();
+    contraction(x, g);
+    std::vector<double> g_plain = g;
+    aa.accelerate(x, g);
+    BOOST_CHECK_EQUAL(aa.historySize(), 0);
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK_EQUAL(g[i], g_plain[i]);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(invalid_depth)
+{
+    BOOST_CHECK_THROW(Opm::AndersonAcceleration(0), std::runtime_error);
+}
@@ -0,0 +1,73 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#if defined(HAVE_DYNAMIC_BOOST_TEST)
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+
+#define BOOST_TEST_MODULE BrentRootFinderTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/porsol/common/BrentRootFinder.hpp>
+
+#include <cmath>
+
+
+namespace {
+    // Monotone, S-shaped function resembling an average saturation curve.
+    struct SCurve
+    {
+        SCurve() : last_x(0.0), evals(0) {}
+        double operator()(double x) const
+        {
+            last_x = x;
+            ++evals;
+            return std::tanh(3.0*(x - 0.7)) + 0.1*(x - 0.7);
+        }
+        mutable double last_x;
+        mutable int evals;
+    };
+}
+
+
+BOOST_AUTO_TEST_CASE(finds_root)
+{
+    SCurve f;
+    int iterations_used = -1;
+    const double root = Opm::BrentRootFinder::solve(f, -10.0, 10.0, 40, 1e-12, iterations_used);
+    BOOST_CHECK_SMALL(root - 0.7, 1e-11);
+    BOOST_CHECK_GT(iterations_used, 0);
+    // Bisection alone would need about 44 evaluations.
+    BOOST_CHECK_LT(f.evals, 30);
+    // The functor state must correspond to the returned root.
+    BOOST_CHECK_EQUAL(f.last_x, root);
+}
+
+
+BOOST_AUTO_TEST_CASE(not_bracketed)
+{
+    SCurve f;
+    int iterations_used = -1;
+    BOOST_CHECK_THROW(Opm::BrentRootFinder::solve(f, 1.0, 2.0, 40, 1e-12, iterations_used),
+                      std::runtime_error);
+}
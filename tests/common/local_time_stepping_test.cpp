@@ -0,0 +1,325 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif  // HAVE_DYNAMIC_BOOST_TEST
+
+#define BOOST_TEST_MODULE LocalTimeSteppingTest
+
+#include <dune/common/version.hh>
+
+#if DUNE_VERSION_NEWER(DUNE_COMMON, 2, 3)
+#include <dune/common/parallel/mpihelper.hh>
+#else
+#include <dune/common/mpihelper.hh>
+#endif
+
+#include <dune/grid/CpGrid.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/SparseVector.hpp>
+#include <opm/porsol/common/GridInterfaceEuler.hpp>
+#include <opm/porsol/common/BoundaryConditions.hpp>
+#include <opm/porsol/common/ReservoirPropertyCapillary.hpp>
+#include <opm/porsol/euler/EulerUpstream.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+namespace {
+
+    typedef Opm::GridInterfaceEuler<Dune::CpGrid> GI;
+    typedef Opm::BasicBoundaryConditions<true, true> BCs;
+
+    // Uniform reservoir properties, except for the porosity of
+    // individual cells, which controls the per-cell cfl time.
+    class HeterogeneousRock : public Opm::ReservoirPropertyCapillary<3>
+    {
+    public:
+        void setPorosity(const int cell, const double poro)
+        {
+            modifiableStaticData().porosity[cell] = poro;
+        }
+    };
+
+    typedef Opm::EulerUpstream<GI, HeterogeneousRock, BCs> Transport;
+
+    // Exposes the local time stepping state of the transport solver.
+    class TransportTester : public Transport
+    {
+    public:
+        using Transport::computeCflTimePerCell;
+        using Transport::assignTimeLevels;
+
+        const std::vector<int>& cellLevels() const { return cell_level_; }
+        const std::vector<double>& levelDt() const { return level_dt_; }
+        const std::vector<int>& levelCount() const { return level_count_; }
+        int ltsCell(const int i) const { return lts_cells_[i]->index(); }
+
+        // Level-weighted residual of all cells touched by level min_level.
+        template <class PressureSolution>
+        void residualLocal(const std::vector<double>& saturation,
+                           const GI::Vector& gravity,
+                           const PressureSolution& pressure_sol,
+                           const Opm::SparseVector<double>& injection_rates,
+                           const int min_level,
+                           std::vector<double>& residual) const
+        {
+            residual.assign(saturation.size(), 0.0);
+            residual_computer_.computeResidualLocal(saturation, gravity, pressure_sol, injection_rates,
+                                                    true, false, false,
+                                                    cell_level_, level_dt_, min_level,
+                                                    lts_cells_, level_count_[min_level], residual);
+        }
+    };
+
+    // Divergence free flux u in the x direction, so that the cfl time
+    // of a cell is proportional to its porosity.
+    struct UniformFlux
+    {
+        explicit UniformFlux(const double u) : u_(u) {}
+
+        template <class FaceIter>
+        double outflux(const FaceIter& f) const
+        {
+            return u_*f->area()*f->normal()[0];
+        }
+
+        double u_;
+    };
+
+    // A row of unit cells along the x axis, with porosity 0.2 except
+    // for the given low porosity cells. Water (saturation 1.0, the
+    // default boundary condition) enters at x = 0.
+    struct Setup
+    {
+        Setup(const int num_cells, const std::vector<int>& slow_cells,
+              const std::vector<double>& slow_poro)
+            : bcs(7), flux(1e-6), injection_rates(num_cells)
+        {
+            int m_argc = boost::unit_test::framework::master_test_suite().argc;
+            char** m_argv = boost::unit_test::framework::master_test_suite().argv;
+            Dune::MPIHelper::instance(m_argc, m_argv);
+
+            std::array<int, 3> dims = {{ num_cells, 1, 1 }};
+            std::array<double, 3> cellsz = {{ 1.0, 1.0, 1.0 }};
+            grid.createCartesian(dims, cellsz);
+            ginterf.init(grid);
+            res_prop.init(num_cells, 0.2);
+            for (int i = 0; i < int(slow_cells.size()); ++i) {
+                res_prop.setPorosity(slow_cells[i], slow_poro[i]);
+            }
+            gravity = 0.0;
+        }
+
+        Opm::parameter::ParameterGroup params(const bool local, const int max_levels) const
+        {
+            Opm::parameter::ParameterGroup param;
+            param.insertParameter("method_gravity", "false");
+            param.insertParameter("method_capillary", "false");
+            param.insertParameter("local_time_stepping", local ? "true" : "false");
+            param.insertParameter("max_time_levels", std::to_string(max_levels));
+            return param;
+        }
+
+        Dune::CpGrid grid;
+        GI ginterf;
+        HeterogeneousRock res_prop;
+        BCs bcs;
+        UniformFlux flux;
+        Opm::SparseVector<double> injection_rates;
+        GI::Vector gravity;
+    };
+
+    double waterVolume(const Setup& s, const std::vector<double>& sat)
+    {
+        double vol = 0.0;
+        for (GI::CellIterator c = s.ginterf.cellbegin(); c != s.ginterf.cellend(); ++c) {
+            vol += c->volume()*s.res_prop.porosity(c->index())*sat[c->index()];
+        }
+        return vol;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(cfl_time_per_cell)
+{
+    Setup s(10, { 4, 5 }, { 0.05, 0.025 });
+    TransportTester transport;
+    transport.init(s.params(true, 6), s.ginterf, s.res_prop, s.bcs);
+
+    std::vector<double> cell_dt;
+    transport.computeCflTimePerCell(s.gravity, s.flux, cell_dt);
+    BOOST_REQUIRE_EQUAL(cell_dt.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK_CLOSE(cell_dt[i]/cell_dt[0], s.res_prop.porosity(i)/0.2, 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(level_assignment)
+{
+    Setup s(10, { 4, 5 }, { 0.05, 0.025 });
+    TransportTester transport;
+    transport.init(s.params(true, 6), s.ginterf, s.res_prop, s.bcs);
+
+    std::vector<double> cell_dt;
+    transport.computeCflTimePerCell(s.gravity, s.flux, cell_dt);
+    const double coarse_dt = 0.9*cell_dt[0];
+    const int finest_level = transport.assignTimeLevels(cell_dt, coarse_dt);
+
+    // Cell 4 has a quarter, cell 5 an eighth of the cfl time of the others.
+    BOOST_CHECK_EQUAL(finest_level, 3);
+    const int expected_level[10] = { 0, 0, 0, 0, 2, 3, 0, 0, 0, 0 };
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(transport.cellLevels()[i], expected_level[i]);
+        BOOST_CHECK(coarse_dt/double(1 << expected_level[i]) <= cell_dt[i]);
+    }
+    BOOST_REQUIRE_EQUAL(transport.levelDt().size(), 4u);
+    for (int l = 0; l < 4; ++l) {
+        BOOST_CHECK_CLOSE(transport.levelDt()[l], coarse_dt/double(1 << l), 1e-12);
+    }
+
+    // Reach levels are { 0, 0, 0, 2, 3, 3, 3, 0, 0, 0 }: the cells
+    // touched by the faces of level 3 come first, then cell 3.
+    const int expected_count[5] = { 10, 4, 4, 3, 0 };
+    BOOST_REQUIRE_EQUAL(transport.levelCount().size(), 5u);
+    for (int l = 0; l < 5; ++l) {
+        BOOST_CHECK_EQUAL(transport.levelCount()[l], expected_count[l]);
+    }
+    std::vector<int> finest_cells;
+    for (int i = 0; i < 3; ++i) {
+        finest_cells.push_back(transport.ltsCell(i));
+    }
+    std::sort(finest_cells.begin(), finest_cells.end());
+    BOOST_CHECK_EQUAL(finest_cells[0], 4);
+    BOOST_CHECK_EQUAL(finest_cells[1], 5);
+    BOOST_CHECK_EQUAL(finest_cells[2], 6);
+    BOOST_CHECK_EQUAL(transport.ltsCell(3), 3);
+}
+
+BOOST_AUTO_TEST_CASE(level_assignment_capped)
+{
+    Setup s(10, { 4, 5 }, { 0.05, 0.025 });
+    TransportTester transport;
+    transport.init(s.params(true, 2), s.ginterf, s.res_prop, s.bcs);
+
+    std::vector<double> cell_dt;
+    transport.computeCflTimePerCell(s.gravity, s.flux, cell_dt);
+    const int finest_level = transport.assignTimeLevels(cell_dt, 0.9*cell_dt[0]);
+
+    BOOST_CHECK_EQUAL(finest_level, 1);
+    BOOST_CHECK_EQUAL(transport.cellLevels()[3], 0);
+    BOOST_CHECK_EQUAL(transport.cellLevels()[4], 1);
+    BOOST_CHECK_EQUAL(transport.cellLevels()[5], 1);
+}
+
+BOOST_AUTO_TEST_CASE(face_fluxes_across_levels)
+{
+    Setup s(10, { 4, 5 }, { 0.05, 0.025 });
+    TransportTester transport;
+    transport.init(s.params(true, 6), s.ginterf, s.res_prop, s.bcs);
+
+    std::vector<double> cell_dt;
+    transport.computeCflTimePerCell(s.gravity, s.flux, cell_dt);
+    transport.assignTimeLevels(cell_dt, 0.9*cell_dt[0]);
+    const std::vector<int>& level = transport.cellLevels();
+    const std::vector<double>& level_dt = transport.levelDt();
+
+    std::vector<double> sat(10);
+    for (int i = 0; i < 10; ++i) {
+        sat[i] = 0.9 - 0.08*i;
+    }
+    std::vector<double> residual;
+    transport.residualLocal(sat, s.gravity, s.flux, s.injection_rates, 0, residual);
+
+    // Every face is counted once, with the time step of the finer of
+    // its two cells, and is added to one cell and subtracted from the
+    // other. Face i is the inflow face of cell i.
+    std::vector<double> face_change(11);
+    face_change[0] = s.res_prop.fractionalFlow(0, 1.0)*s.flux.u_*level_dt[level[0]];
+    for (int i = 1; i < 10; ++i) {
+        const int face_level = std::max(level[i - 1], level[i]);
+        face_change[i] = s.res_prop.fractionalFlow(i - 1, sat[i - 1])*s.flux.u_*level_dt[face_level];
+    }
+    face_change[10] = s.res_prop.fractionalFlow(9, sat[9])*s.flux.u_*level_dt[level[9]];
+    double total = 0.0;
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK_CLOSE(residual[i], face_change[i] - face_change[i + 1], 1e-8);
+        total += residual[i];
+    }
+    // Interior faces cancel, only the boundary fluxes remain.
+    BOOST_CHECK_CLOSE(total, face_change[0] - face_change[10], 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(mass_conservation_across_levels)
+{
+    // The slow cells are close to the inflow boundary, so that the
+    // front crosses several level interfaces but not the outflow
+    // boundary.
+    const int num_cells = 20;
+    Setup s(num_cells, { 2, 3 }, { 0.05, 0.025 });
+    TransportTester transport;
+    transport.init(s.params(true, 6), s.ginterf, s.res_prop, s.bcs);
+
+    std::vector<double> cell_dt;
+    transport.computeCflTimePerCell(s.gravity, s.flux, cell_dt);
+    const double time = 2.0*cell_dt[0];
+
+    std::vector<double> sat(num_cells, 0.0);
+    transport.transportSolve(sat, time, s.gravity, s.flux, s.injection_rates);
+
+    // Several levels were in use, and water crossed them.
+    BOOST_CHECK(transport.levelDt().size() > 2);
+    BOOST_CHECK(sat[4] > 0.0);
+    // Nothing has left through the outflow boundary...
+    BOOST_CHECK_EQUAL(sat[num_cells - 1], 0.0);
+    // ... so the water in place is what entered through the unit
+    // inflow face, with the fractional flow of the boundary saturation.
+    const double inflow = s.res_prop.fractionalFlow(0, 1.0)*s.flux.u_*time;
+    BOOST_CHECK_CLOSE(waterVolume(s, sat), inflow, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(single_level_matches_global_step)
+{
+    const int num_cells = 20;
+    Setup s(num_cells, { 2, 3 }, { 0.05, 0.025 });
+    Transport global;
+    global.init(s.params(false, 6), s.ginterf, s.res_prop, s.bcs);
+    Transport local;
+    local.init(s.params(true, 1), s.ginterf, s.res_prop, s.bcs);
+
+    const double time = 10.0*0.5*0.2/s.flux.u_;
+    std::vector<double> sat_global(num_cells, 0.0);
+    std::vector<double> sat_local(num_cells, 0.0);
+    global.transportSolve(sat_global, time, s.gravity, s.flux, s.injection_rates);
+    local.transportSolve(sat_local, time, s.gravity, s.flux, s.injection_rates);
+
+    BOOST_CHECK(sat_global[0] > 0.0);
+    for (int i = 0; i < num_cells; ++i) {
+        BOOST_CHECK_SMALL(sat_local[i] - sat_global[i], 1e-12);
+    }
+}
@@ -55,3 +55,23 @@ BOOST_AUTO_TEST_CASE(copy_assignment_tests)
     m5 = m3;
     BOOST_CHECK_EQUAL(m5.data(), storage_m5); // ... compared to this (different types).
 }
+
+BOOST_AUTO_TEST_CASE(inline_data_tests)
+{
+    using namespace Opm;
+    double storage[4] = { 1.0, 2.0, 3.0, 4.0 };
+    InlineCMatrix m1(2,2,storage);
+    BOOST_CHECK_EQUAL(m1.data(), storage); // A pointer is shared...
+    InlineCMatrix m2(2,2,InlineCopy<double>(storage));
+    storage[0] = 0.0;
+    BOOST_CHECK_EQUAL(m1(0,0), 0.0);
+    BOOST_CHECK_EQUAL(m2(0,0), 1.0); // ... while InlineCopy copies the data...
+    BOOST_CHECK_EQUAL(m2(1,0), 3.0);
+    InlineCMatrix m3(m2);
+    BOOST_CHECK(m3.data() != m2.data()); // ... also in the copy constructor.
+    BOOST_CHECK_EQUAL(m3(1,0), 3.0);
+    OwnCMatrix m4(m3);
+    BOOST_CHECK(m4 == m3);
+    InlineCMatrix m5(3,3,InlineCopy<double>(0));
+    BOOST_CHECK_EQUAL(m5(2,2), 0.0);
+}
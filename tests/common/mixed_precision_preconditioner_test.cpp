@@ -0,0 +1,125 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#if defined(HAVE_DYNAMIC_BOOST_TEST)
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+
+#define BOOST_TEST_MODULE MixedPrecisionPreconditionerTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/porsol/common/MixedPrecisionPreconditioner.hpp>
+
+#include <dune/istl/operators.hh>
+#include <dune/istl/solvers.hh>
+
+#include <cmath>
+
+
+namespace {
+    typedef Dune::BCRSMatrix <Dune::FieldMatrix<double, 1, 1> > Matrix;
+    typedef Dune::BlockVector<Dune::FieldVector<double, 1> >    Vector;
+    typedef Dune::BCRSMatrix <Dune::FieldMatrix<float, 1, 1> >  FloatMatrix;
+    typedef Dune::BlockVector<Dune::FieldVector<float, 1> >     FloatVector;
+
+    // 1D Laplacian with coefficients varying over several orders of
+    // magnitude, so that single precision rounding matters.
+    Matrix laplacian(const int n)
+    {
+        Matrix A(n, n, 3*n - 2, Matrix::row_wise);
+        for (Matrix::CreateIterator row = A.createbegin(); row != A.createend(); ++row) {
+            const int i = row.index();
+            if (i > 0) {
+                row.insert(i - 1);
+            }
+            row.insert(i);
+            if (i < n - 1) {
+                row.insert(i + 1);
+            }
+        }
+        A = 0.0;
+        for (int i = 0; i < n; ++i) {
+            // Face transmissibility between i and i + 1.
+            const double t = std::pow(10.0, 3.0*std::sin(0.1*i));
+            A[i][i] += t + (i == 0 ? 1.0 : 0.0);
+            if (i < n - 1) {
+                A[i + 1][i + 1] += t;
+                A[i][i + 1] = -t;
+                A[i + 1][i] = -t;
+            }
+        }
+        return A;
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(convert_matrix_copies_pattern_and_values)
+{
+    const Matrix A = laplacian(10);
+    FloatMatrix Af;
+    Opm::convertMatrix(A, Af);
+    BOOST_CHECK_EQUAL(Af.N(), A.N());
+    BOOST_CHECK_EQUAL(Af.nonzeroes(), A.nonzeroes());
+    BOOST_CHECK_CLOSE(double(Af[3][4][0][0]), A[3][4][0][0], 1e-5);
+
+    // Same pattern: only the values are copied.
+    Matrix B = A;
+    B *= 2.0;
+    Opm::convertMatrix(B, Af);
+    BOOST_CHECK_CLOSE(double(Af[3][4][0][0]), 2.0*A[3][4][0][0], 1e-5);
+
+    // Different pattern: rebuilt.
+    const Matrix C = laplacian(7);
+    Opm::convertMatrix(C, Af);
+    BOOST_CHECK_EQUAL(Af.N(), 7u);
+    BOOST_CHECK_CLOSE(double(Af[6][6][0][0]), C[6][6][0][0], 1e-5);
+}
+
+
+BOOST_AUTO_TEST_CASE(cg_reaches_double_precision_tolerance)
+{
+    const int n = 200;
+    Matrix A = laplacian(n);
+    FloatMatrix Af;
+    Opm::convertMatrix(A, Af);
+
+    Dune::MatrixAdapter<Matrix, Vector, Vector> op(A);
+    Dune::SeqSSOR<FloatMatrix, FloatVector, FloatVector> inner(Af, 1, 1.0);
+    Opm::MixedPrecisionPreconditioner<Vector, FloatVector> precond(inner);
+
+    Vector x(n), b(n);
+    for (int i = 0; i < n; ++i) {
+        b[i] = std::cos(0.3*i);
+    }
+    x = 0.0;
+    Dune::CGSolver<Vector> cg(op, precond, 1e-12, 10*n, 0);
+    Dune::InverseOperatorResult result;
+    Vector rhs = b;
+    cg.apply(x, rhs, result);
+    BOOST_CHECK(result.converged);
+
+    // The residual is far below what single precision could represent.
+    Vector r = b;
+    A.mmv(x, r);
+    BOOST_CHECK(r.two_norm() < 1e-10*b.two_norm());
+}
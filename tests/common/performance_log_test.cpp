@@ -0,0 +1,92 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#if defined(HAVE_DYNAMIC_BOOST_TEST)
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+
+#define BOOST_TEST_MODULE PerformanceLogTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/porsol/common/PerformanceLog.hpp>
+
+#include <sstream>
+#include <string>
+
+
+BOOST_AUTO_TEST_CASE(aggregatesSamples)
+{
+    Opm::PerformanceLog log;
+    log.addCount("iterations", 10);
+    log.addCount("iterations", 4);
+    log.addTime("solve", 0.5);
+
+    const Opm::PerformanceLog::Entry it = log.entry("iterations");
+    BOOST_CHECK(!it.is_timer);
+    BOOST_CHECK_EQUAL(it.samples, 2);
+    BOOST_CHECK_EQUAL(it.total, 14.0);
+    BOOST_CHECK_EQUAL(it.min, 4.0);
+    BOOST_CHECK_EQUAL(it.max, 10.0);
+    BOOST_CHECK(log.entry("solve").is_timer);
+    BOOST_CHECK_EQUAL(log.entry("unknown").samples, 0);
+
+    log.clear();
+    BOOST_CHECK_EQUAL(log.entry("iterations").samples, 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(scopedTimer)
+{
+    Opm::PerformanceLog log;
+    {
+        Opm::ScopedTimer timer("scope", log);
+        BOOST_CHECK(timer.elapsed() >= 0.0);
+    }
+    const Opm::PerformanceLog::Entry e = log.entry("scope");
+    BOOST_CHECK(e.is_timer);
+    BOOST_CHECK_EQUAL(e.samples, 1);
+    BOOST_CHECK(e.total >= 0.0);
+}
+
+
+BOOST_AUTO_TEST_CASE(reports)
+{
+    Opm::PerformanceLog log;
+    log.addCount("a", 3);
+    log.addTime("b", 2.0);
+
+    std::ostringstream csv;
+    log.writeCSV(csv);
+    BOOST_CHECK_EQUAL(csv.str(),
+                      "name,type,samples,total,mean,min,max,ranks\n"
+                      "a,counter,1,3,3,3,3,1\n"
+                      "b,timer,1,2,2,2,2,1\n");
+
+    std::ostringstream json;
+    log.writeJSON(json);
+    BOOST_CHECK_EQUAL(json.str(),
+                      "{\n"
+                      "  \"a\": {\"type\": \"counter\", \"samples\": 1, \"total\": 3, \"mean\": 3, \"min\": 3, \"max\": 3, \"ranks\": 1},\n"
+                      "  \"b\": {\"type\": \"timer\", \"samples\": 1, \"total\": 2, \"mean\": 2, \"min\": 2, \"max\": 2, \"ranks\": 1}\n"
+                      "}\n");
+}
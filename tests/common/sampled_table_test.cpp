@@ -0,0 +1,94 @@
+/*
+  Copyright 2016 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#if defined(HAVE_DYNAMIC_BOOST_TEST)
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+
+#define BOOST_TEST_MODULE SampledTableLinearTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/porsol/common/SampledTableLinear.hpp>
+
+#include <cmath>
+#include <vector>
+
+
+namespace {
+    // Piecewise linear curve through (0, 0), (0.3, 0.05), (1, 1), like a krw table.
+    struct Kink
+    {
+        double operator()(double x) const
+        {
+            return x < 0.3 ? x/6.0 : 0.05 + (x - 0.3)*0.95/0.7;
+        }
+    };
+}
+
+
+BOOST_AUTO_TEST_CASE(linear_is_exact)
+{
+    struct Line { double operator()(double x) const { return 2.0 - 3.0*x; } };
+    const Opm::SampledTableLinear t(0.2, 0.9, 7, Line());
+    BOOST_CHECK_CLOSE(t(0.2), 1.4, 1e-12);
+    BOOST_CHECK_CLOSE(t(0.55), 0.35, 1e-10);
+    BOOST_CHECK_CLOSE(t(0.9), -0.7, 1e-10);
+    BOOST_CHECK_CLOSE(t.derivative(0.4), -3.0, 1e-10);
+}
+
+
+BOOST_AUTO_TEST_CASE(clamps_outside_domain)
+{
+    const Opm::SampledTableLinear t(0.0, 1.0, 10, Kink());
+    BOOST_CHECK_EQUAL(t(-1.0), t(0.0));
+    BOOST_CHECK_EQUAL(t(2.0), t(1.0));
+    BOOST_CHECK_CLOSE(t.derivative(-1.0), 1.0/6.0, 1e-10);
+    BOOST_CHECK_CLOSE(t.derivative(5.0), 0.95/0.7, 1e-10);
+}
+
+
+BOOST_AUTO_TEST_CASE(error_at_breakpoints_bounds_error)
+{
+    const Kink f;
+    std::vector<double> breakpoints;
+    breakpoints.push_back(0.0);
+    breakpoints.push_back(0.3);
+    breakpoints.push_back(1.0);
+    const Opm::SampledTableLinear coarse(0.0, 1.0, 8, f);
+    const Opm::SampledTableLinear fine(0.0, 1.0, 64, f);
+    const double err = coarse.maxError(breakpoints, f);
+    BOOST_CHECK_GT(err, 0.0);
+    BOOST_CHECK_LT(fine.maxError(breakpoints, f), err);
+    for (int i = 0; i <= 1000; ++i) {
+        const double x = i*1e-3;
+        BOOST_CHECK_LE(std::fabs(coarse(x) - f(x)), err + 1e-14);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(invalid_domain_throws)
+{
+    BOOST_CHECK_THROW(Opm::SampledTableLinear(1.0, 1.0, 4, Kink()), std::runtime_error);
+    BOOST_CHECK_THROW(Opm::SampledTableLinear(0.0, 1.0, 0, Kink()), std::runtime_error);
+    BOOST_CHECK(Opm::SampledTableLinear().empty());
+}
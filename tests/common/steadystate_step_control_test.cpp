@@ -0,0 +1,134 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of The Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif  // HAVE_DYNAMIC_BOOST_TEST
+
+#define BOOST_TEST_MODULE SteadyStateStepControlTest
+
+#include <dune/common/version.hh>
+
+#if DUNE_VERSION_NEWER(DUNE_COMMON, 2, 3)
+#include <dune/common/parallel/mpihelper.hh>
+#else
+#include <dune/common/mpihelper.hh>
+#endif
+
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/upscaling/SteadyStateUpscaler.hpp>
+#include <opm/upscaling/UpscalingTraits.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+namespace {
+
+    typedef Opm::SteadyStateUpscaler<Opm::UpscalingTraitsBasic> Upscaler;
+    typedef Upscaler::permtensor_t permtensor_t;
+
+    // Water (saturation 0.6) displacing a saturation of 0.2 along the
+    // x axis of a small uniform box with fixed boundary conditions, run
+    // until the saturation changes less than 0.01 per year.
+    Opm::parameter::ParameterGroup caseParameters()
+    {
+        Opm::parameter::ParameterGroup param;
+        param.insertParameter("boundary_condition_type", "0");
+        param.insertParameter("fileformat", "cartesian");
+        param.insertParameter("nx", "8");
+        param.insertParameter("ny", "2");
+        param.insertParameter("nz", "2");
+        param.insertParameter("stepsize", "1.0");
+        param.insertParameter("simulation_steps", "2000");
+        param.insertParameter("sat_change_year", "0.01");
+        return param;
+    }
+
+    struct SteadyState
+    {
+        std::vector<double> saturation;
+        double upscaled_saturation;
+        double krw_xx;
+        double kro_xx;
+    };
+
+    SteadyState runCase(const Opm::parameter::ParameterGroup& param)
+    {
+        int m_argc = boost::unit_test::framework::master_test_suite().argc;
+        char** m_argv = boost::unit_test::framework::master_test_suite().argv;
+        Dune::MPIHelper::instance(m_argc, m_argv);
+
+        Upscaler upscaler;
+        upscaler.init(param);
+        const permtensor_t upscaled_K = upscaler.upscaleSinglePhase();
+        const std::vector<double> init_sat(upscaler.grid().size(0), 0.2);
+        const std::pair<permtensor_t, permtensor_t> kr
+            = upscaler.upscaleSteadyState(0, init_sat, 0.6, 1e5, upscaled_K);
+
+        SteadyState result;
+        result.saturation = upscaler.lastSaturationState();
+        result.upscaled_saturation = upscaler.lastSaturationUpscaled();
+        result.krw_xx = kr.first(0, 0);
+        result.kro_xx = kr.second(0, 0);
+        return result;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(adaptive_stepsize_matches_fixed)
+{
+    const SteadyState fixed = runCase(caseParameters());
+
+    Opm::parameter::ParameterGroup param = caseParameters();
+    param.insertParameter("adaptive_stepsize", "true");
+    param.insertParameter("max_stepsize", "0.1");
+    param.insertParameter("dt_sat_tol", "0.01");
+    const SteadyState adaptive = runCase(param);
+
+    // The front has passed through the box.
+    BOOST_CHECK_CLOSE(fixed.upscaled_saturation, 0.6, 1.0);
+
+    BOOST_CHECK_CLOSE(adaptive.upscaled_saturation, fixed.upscaled_saturation, 0.5);
+    BOOST_CHECK_CLOSE(adaptive.krw_xx, fixed.krw_xx, 1.0);
+    BOOST_CHECK_CLOSE(adaptive.kro_xx, fixed.kro_xx, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(amg_reuse_matches_rebuild)
+{
+    const SteadyState rebuild = runCase(caseParameters());
+
+    Opm::parameter::ParameterGroup param = caseParameters();
+    param.insertParameter("amg_reuse_sat_tol", "0.05");
+    const SteadyState reuse = runCase(param);
+
+    // The reused preconditioner only changes the iterations of the
+    // pressure solver, not the converged solution.
+    BOOST_REQUIRE_EQUAL(reuse.saturation.size(), rebuild.saturation.size());
+    for (std::size_t i = 0; i < reuse.saturation.size(); ++i) {
+        BOOST_CHECK_SMALL(reuse.saturation[i] - rebuild.saturation[i], 1e-4);
+    }
+    BOOST_CHECK_CLOSE(reuse.krw_xx, rebuild.krw_xx, 0.1);
+    BOOST_CHECK_CLOSE(reuse.kro_xx, rebuild.kro_xx, 0.1);
+}
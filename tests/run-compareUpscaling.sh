@@ -14,5 +14,7 @@ TEST_ARGS="$@"
 rm -Rf ${RESULT_PATH}
 mkdir -p ${RESULT_PATH}
 
-${BINPATH}/${EXE_NAME} ${TEST_ARGS}
+# TEST_LAUNCHER may be set in the environment of the test, for
+# instance to run the binary on several MPI processes.
+${TEST_LAUNCHER} ${BINPATH}/${EXE_NAME} ${TEST_ARGS}
 ${BINPATH}/compareUpscaling ${INPUT_DATA_PATH}/reference_solutions/${TEST_NAME}.txt ${RESULT_PATH}/${TEST_NAME}.txt ${ABS_TOL} ${REL_TOL}